@@ -0,0 +1,286 @@
+#include "altimeter.h"
+
+// Registres du BMP085/BMP180
+#define BMP085_REGISTER_CALIBRATION   0xAA
+#define BMP085_REGISTER_CHIP_ID       0xD0
+#define BMP085_REGISTER_CONTROL       0xF4
+#define BMP085_REGISTER_DATA          0xF6
+
+#define BMP085_CHIP_ID                0x55
+#define BMP085_COMMAND_TEMPERATURE    0x2E
+#define BMP085_COMMAND_PRESSURE       0x34
+
+#define BMP085_TEMPERATURE_CONVERSION_TIME  4500 // us
+
+// États de la mesure en cours
+#define ALTIMETER_STATE_IDLE          0
+#define ALTIMETER_STATE_TEMPERATURE   1
+#define ALTIMETER_STATE_PRESSURE      2
+#define ALTIMETER_STATE_FAILED        3
+
+byte Altimeter::_selectedMuxChannel = ALTIMETER_NO_MUX;
+
+Altimeter::Altimeter() {
+    _muxChannel = ALTIMETER_NO_MUX;
+    _state = ALTIMETER_STATE_IDLE;
+    _oversampling = BMP085_OVERSAMPLING_ULTRAHIGHRES;
+    _temperaturePeriod = 1;
+    _samplesSinceTemperature = 0;
+    _conversionStart = 0;
+    _measurementTime = 0;
+    _valid = false;
+    _b5 = 0;
+    _pressure = 0;
+}
+
+bool Altimeter::begin(byte oversampling, byte temperaturePeriod, byte muxChannel) {
+/*
+ * Vérifie la présence du capteur et lit ses coefficients de calibration. Le nombre de mesures
+ * de pression par mesure de température est au moins 1.
+ */
+    _muxChannel = muxChannel;
+    _selectedMuxChannel = ALTIMETER_NO_MUX; // Le multiplexeur garde son canal au redémarrage du Arduino
+    if(oversampling > BMP085_OVERSAMPLING_ULTRAHIGHRES) {
+        oversampling = BMP085_OVERSAMPLING_ULTRAHIGHRES;
+    }
+    if(temperaturePeriod < 1) {
+        temperaturePeriod = 1;
+    }
+    _oversampling = oversampling;
+    _temperaturePeriod = temperaturePeriod;
+    _samplesSinceTemperature = 0;
+    _state = ALTIMETER_STATE_IDLE;
+
+    Wire.begin();
+    byte chipId;
+    if(!_readRegisters(BMP085_REGISTER_CHIP_ID, &chipId, 1) || chipId != BMP085_CHIP_ID) {
+        return false;
+    }
+
+    byte calibration[22];
+    if(!_readRegisters(BMP085_REGISTER_CALIBRATION, calibration, sizeof(calibration))) {
+        return false;
+    }
+    _ac1 = (calibration[0] << 8) | calibration[1];
+    _ac2 = (calibration[2] << 8) | calibration[3];
+    _ac3 = (calibration[4] << 8) | calibration[5];
+    _ac4 = (calibration[6] << 8) | calibration[7];
+    _ac5 = (calibration[8] << 8) | calibration[9];
+    _ac6 = (calibration[10] << 8) | calibration[11];
+    _b1 = (calibration[12] << 8) | calibration[13];
+    _b2 = (calibration[14] << 8) | calibration[15];
+    _mb = (calibration[16] << 8) | calibration[17];
+    _mc = (calibration[18] << 8) | calibration[19];
+    _md = (calibration[20] << 8) | calibration[21];
+    return true;
+}
+
+void Altimeter::startMeasurement() {
+/*
+ * Lance une nouvelle mesure, en commençant par la température si elle doit être rafraîchie.
+ * Si une mesure est déjà en cours, elle continue et compte pour cette demande.
+ */
+    if(_state != ALTIMETER_STATE_IDLE) {
+        return;
+    }
+    if(_samplesSinceTemperature == 0) {
+        if(_startConversion(BMP085_COMMAND_TEMPERATURE)) {
+            _state = ALTIMETER_STATE_TEMPERATURE;
+            return;
+        }
+    }
+    else if(_startConversion(BMP085_COMMAND_PRESSURE + (_oversampling << 6))) {
+        _state = ALTIMETER_STATE_PRESSURE;
+        return;
+    }
+    // Le capteur ne répond pas: l'échec sera rapporté au prochain appel de update()
+    _abortMeasurement();
+    _state = ALTIMETER_STATE_FAILED;
+}
+
+bool Altimeter::update() {
+/*
+ * Fait avancer la mesure en cours sans jamais attendre. Retourne true une seule fois par mesure,
+ * quand la nouvelle pression est prête ou quand la mesure a échoué (voir isValid()).
+ */
+    byte data[3];
+
+    if(_state == ALTIMETER_STATE_FAILED) {
+        _state = ALTIMETER_STATE_IDLE;
+        return true;
+    }
+
+    if(_state == ALTIMETER_STATE_TEMPERATURE) {
+        if(micros() - _conversionStart < BMP085_TEMPERATURE_CONVERSION_TIME) {
+            return false;
+        }
+        if(!_readRegisters(BMP085_REGISTER_DATA, data, 2)) {
+            _abortMeasurement();
+            return true;
+        }
+        _computeTemperature(((int32_t)data[0] << 8) | data[1]);
+        if(!_startConversion(BMP085_COMMAND_PRESSURE + (_oversampling << 6))) {
+            _abortMeasurement();
+            return true;
+        }
+        _state = ALTIMETER_STATE_PRESSURE;
+        return false;
+    }
+
+    if(_state == ALTIMETER_STATE_PRESSURE) {
+        if(micros() - _conversionStart < _conversionTime()) {
+            return false;
+        }
+        _state = ALTIMETER_STATE_IDLE;
+        if(!_readRegisters(BMP085_REGISTER_DATA, data, 3)) {
+            _abortMeasurement();
+            return true;
+        }
+        _computePressure((((int32_t)data[0] << 16) | ((int32_t)data[1] << 8) | data[2]) >> (8 - _oversampling));
+        _measurementTime = _conversionStart;
+        _valid = true;
+        _samplesSinceTemperature++;
+        if(_samplesSinceTemperature >= _temperaturePeriod) {
+            _samplesSinceTemperature = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Altimeter::isValid() {
+    return _valid;
+}
+
+int32_t Altimeter::getPressure() {
+    return _pressure;
+}
+
+unsigned long Altimeter::getMeasurementTime() {
+    return _measurementTime;
+}
+
+int32_t Altimeter::readPressure() {
+/*
+ * Mesure bloquante, utilisée seulement à l'initialisation pour la pression au sol.
+ */
+    _samplesSinceTemperature = 0;
+    startMeasurement();
+    while(_state != ALTIMETER_STATE_IDLE) {
+        update();
+    }
+    return _pressure;
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------
+// Méthodes privées
+
+bool Altimeter::_selectMuxChannel() {
+/*
+ * Un échec laisse le canal inconnu: il sera choisi de nouveau à la prochaine transaction.
+ */
+    if(_muxChannel == ALTIMETER_NO_MUX || _muxChannel == _selectedMuxChannel) {
+        return true;
+    }
+    Wire.beginTransmission(TCA9548A_I2C_ADDRESS);
+    Wire.write((byte)(1 << _muxChannel));
+    if(Wire.endTransmission() != 0) {
+        _selectedMuxChannel = ALTIMETER_NO_MUX;
+        return false;
+    }
+    _selectedMuxChannel = _muxChannel;
+    return true;
+}
+
+bool Altimeter::_startConversion(byte command) {
+    if(!_selectMuxChannel()) {
+        return false;
+    }
+    Wire.beginTransmission(BMP085_I2C_ADDRESS);
+    Wire.write(BMP085_REGISTER_CONTROL);
+    Wire.write(command);
+    if(Wire.endTransmission() != 0) {
+        return false;
+    }
+    _conversionStart = micros();
+    return true;
+}
+
+bool Altimeter::_readRegisters(byte address, byte *data, byte length) {
+    if(!_selectMuxChannel()) {
+        return false;
+    }
+    Wire.beginTransmission(BMP085_I2C_ADDRESS);
+    Wire.write(address);
+    if(Wire.endTransmission() != 0) {
+        return false;
+    }
+    if(Wire.requestFrom((uint8_t)BMP085_I2C_ADDRESS, length) != length) {
+        return false;
+    }
+    for(byte i = 0; i < length; i++) {
+        data[i] = Wire.read();
+    }
+    return true;
+}
+
+unsigned long Altimeter::_conversionTime() {
+/*
+ * Durées de conversion maximales de la pression selon le suréchantillonnage (fiche technique).
+ */
+    switch(_oversampling) {
+        case BMP085_OVERSAMPLING_ULTRALOWPOWER: return 4500;
+        case BMP085_OVERSAMPLING_STANDARD:      return 7500;
+        case BMP085_OVERSAMPLING_HIGHRES:       return 13500;
+    }
+    return 25500;
+}
+
+void Altimeter::_abortMeasurement() {
+/*
+ * Une erreur sur le bus I2C invalide la mesure. La température sera relue à la prochaine mesure.
+ */
+    _state = ALTIMETER_STATE_IDLE;
+    _valid = false;
+    _samplesSinceTemperature = 0;
+}
+
+void Altimeter::_computeTemperature(int32_t ut) {
+/*
+ * Calcul de la fiche technique du BMP085. Seul B5 est conservé, c'est lui qui sert à compenser
+ * la pression.
+ */
+    int32_t x1 = ((ut - (int32_t)_ac6) * (int32_t)_ac5) >> 15;
+    int32_t x2 = ((int32_t)_mc << 11) / (x1 + _md);
+    _b5 = x1 + x2;
+}
+
+void Altimeter::_computePressure(int32_t up) {
+/*
+ * Calcul de la fiche technique du BMP085, en entiers de 32 bits.
+ */
+    int32_t b6 = _b5 - 4000;
+    int32_t x1 = ((int32_t)_b2 * ((b6 * b6) >> 12)) >> 11;
+    int32_t x2 = ((int32_t)_ac2 * b6) >> 11;
+    int32_t x3 = x1 + x2;
+    int32_t b3 = ((((int32_t)_ac1 * 4 + x3) << _oversampling) + 2) / 4;
+
+    x1 = ((int32_t)_ac3 * b6) >> 13;
+    x2 = ((int32_t)_b1 * ((b6 * b6) >> 12)) >> 16;
+    x3 = ((x1 + x2) + 2) >> 2;
+    uint32_t b4 = ((uint32_t)_ac4 * (uint32_t)(x3 + 32768)) >> 15;
+    uint32_t b7 = ((uint32_t)up - b3) * (uint32_t)(50000UL >> _oversampling);
+
+    int32_t p;
+    if(b7 < 0x80000000) {
+        p = (b7 * 2) / b4;
+    }
+    else {
+        p = (b7 / b4) * 2;
+    }
+    x1 = (p >> 8) * (p >> 8);
+    x1 = (x1 * 3038) >> 16;
+    x2 = (-7357 * p) >> 16;
+    _pressure = p + ((x1 + x2 + (int32_t)3791) >> 4);
+}
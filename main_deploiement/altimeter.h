@@ -0,0 +1,82 @@
+/*
+ * Ce module est un pilote non bloquant de l'altimètre barométrique BMP085/BMP180 (bus I2C).
+ *
+ * Le pilote d'Adafruit attend la fin de chaque conversion avec delay(): une conversion de
+ * température (4,5 ms) et une conversion de pression (jusqu'à 25,5 ms) bloquent la boucle
+ * principale à chaque échantillon. Ici, startMeasurement() lance la conversion et retourne tout
+ * de suite; update() doit être appelée à chaque passage dans la boucle et lit le résultat quand
+ * la durée de conversion maximale de la fiche technique est écoulée. La broche EOC du BMP180 n'est
+ * pas branchée, on se fie donc au temps.
+ *
+ * La température ne change presque pas d'un échantillon à l'autre: elle est lue seulement à
+ * toutes les temperaturePeriod mesures et réutilisée entre-temps pour compenser la pression.
+ *
+ * getMeasurementTime() donne le temps micros() du début de la conversion de pression de la
+ * dernière mesure: c'est le moment où la pression a été prise, quel que soit le retard de la
+ * boucle à lire le résultat.
+ *
+ * Le BMP180 a une adresse I2C fixe: deux capteurs sur le même bus sont branchés chacun sur un canal
+ * d'un multiplexeur I2C TCA9548A. Le canal est choisi avant chaque transaction, seulement s'il a
+ * changé depuis la précédente. Les conversions des deux capteurs se font en même temps: le
+ * multiplexeur ne sert qu'aux transactions.
+ *
+ * Les paramètres d'initialisation sont:
+ *    - Le mode de suréchantillonnage (0 à 3, voir BMP085_OVERSAMPLING_*)
+ *    - Le nombre de mesures de pression par mesure de température
+ *    - Le canal du multiplexeur (0 à 7), ou ALTIMETER_NO_MUX si le capteur est sur le bus
+ */
+
+#ifndef altimeter_h
+#define altimeter_h
+
+#include "Arduino.h"
+#include <Wire.h>
+
+#define BMP085_I2C_ADDRESS        0x77
+#define TCA9548A_I2C_ADDRESS      0x70
+#define ALTIMETER_NO_MUX          0xFF
+
+#define BMP085_OVERSAMPLING_ULTRALOWPOWER   0   // 4,5 ms par conversion de pression
+#define BMP085_OVERSAMPLING_STANDARD        1   // 7,5 ms
+#define BMP085_OVERSAMPLING_HIGHRES         2   // 13,5 ms
+#define BMP085_OVERSAMPLING_ULTRAHIGHRES    3   // 25,5 ms
+
+class Altimeter {
+    public:
+        Altimeter();
+        bool begin(byte oversampling, byte temperaturePeriod, byte muxChannel = ALTIMETER_NO_MUX);
+        void startMeasurement();
+        bool update();
+        bool isValid();
+        int32_t getPressure();
+        unsigned long getMeasurementTime();
+        int32_t readPressure();
+
+    private:
+        static byte _selectedMuxChannel;    // Canal choisi par la dernière transaction, tous capteurs confondus
+
+        byte _muxChannel;
+        byte _state;
+        byte _oversampling;
+        byte _temperaturePeriod;
+        byte _samplesSinceTemperature;
+        unsigned long _conversionStart;
+        unsigned long _measurementTime;     // us, début de la conversion de la dernière pression
+        bool _valid;
+        int32_t _b5;
+        int32_t _pressure;
+
+        // Coefficients de calibration lus dans la mémoire du capteur
+        int16_t _ac1, _ac2, _ac3;
+        uint16_t _ac4, _ac5, _ac6;
+        int16_t _b1, _b2, _mb, _mc, _md;
+
+        bool _selectMuxChannel();
+        bool _startConversion(byte command);
+        bool _readRegisters(byte address, byte *data, byte length);
+        unsigned long _conversionTime();
+        void _abortMeasurement();
+        void _computeTemperature(int32_t ut);
+        void _computePressure(int32_t up);
+};
+#endif
@@ -0,0 +1,139 @@
+#include "altitudeEstimator.h"
+
+AltitudeEstimator::AltitudeEstimator() {
+    _samplingPeriod = 0;
+    _measurementVariance = 0;
+    _jerkDensity = 0;
+    _altitude = 0;
+    _velocity = 0;
+    _acceleration = 0;
+    _p00 = _p01 = _p02 = _p11 = _p12 = _p22 = 0;
+    _q00 = _q01 = _q02 = _q11 = _q12 = _q22 = 0;
+}
+
+void AltitudeEstimator::init(float samplingPeriod, float altitudeNoise, float jerkNoise) {
+/*
+ * La fusée est au repos sur la rampe à l'altitude 0, la pression de référence étant mesurée
+ * au démarrage. L'incertitude initiale sur l'altitude est celle d'une mesure.
+ */
+    _measurementVariance = altitudeNoise*altitudeNoise;
+    _jerkDensity = jerkNoise*jerkNoise;
+    _altitude = 0;
+    _velocity = 0;
+    _acceleration = 0;
+
+    _p00 = _measurementVariance;
+    _p01 = _p02 = _p12 = 0;
+    _p11 = 1;
+    _p22 = 1;
+
+    _setSamplingPeriod(samplingPeriod);
+}
+
+void AltitudeEstimator::resume(float altitude, float velocity, float acceleration) {
+/*
+ * Reprend l'état estimé avant un redémarrage en vol (appelée après init()). La covariance n'est
+ * pas gardée: elle repart de celle de init().
+ */
+    _altitude = altitude;
+    _velocity = velocity;
+    _acceleration = acceleration;
+}
+
+void AltitudeEstimator::update(float mesuredAltitude, float elapsedTime) {
+    if(elapsedTime != _samplingPeriod) {
+        _setSamplingPeriod(elapsedTime);
+    }
+    _predict();
+    _correct(mesuredAltitude);
+}
+
+float AltitudeEstimator::getAltitude() {
+    return _altitude;
+}
+
+float AltitudeEstimator::getVelocity() {
+    return _velocity;
+}
+
+float AltitudeEstimator::getAcceleration() {
+    return _acceleration;
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------
+// Méthodes privées
+
+void AltitudeEstimator::_setSamplingPeriod(float dt) {
+/*
+ * Le bruit de processus est celui d'une secousse blanche de densité q = jerkNoise^2:
+ *        [dt^5/20  dt^4/8  dt^3/6]
+ *    q * [dt^4/8   dt^3/3  dt^2/2]
+ *        [dt^3/6   dt^2/2  dt    ]
+ */
+    float q = _jerkDensity;
+    float dt2 = dt*dt;
+    float dt3 = dt2*dt;
+
+    _samplingPeriod = dt;
+    _q00 = q*dt3*dt2/20;
+    _q01 = q*dt2*dt2/8;
+    _q02 = q*dt3/6;
+    _q11 = q*dt3/3;
+    _q12 = q*dt2/2;
+    _q22 = q*dt;
+}
+
+void AltitudeEstimator::_predict() {
+/*
+ * Avance l'état d'une période: x = F*x et P = F*P*F' + Q, avec
+ *        [1  dt  dt^2/2]
+ *    F = [0  1   dt    ]
+ *        [0  0   1     ]
+ */
+    float dt = _samplingPeriod;
+    float halfDt2 = dt*dt/2;
+
+    _altitude += dt*_velocity + halfDt2*_acceleration;
+    _velocity += dt*_acceleration;
+
+    // A = F*P (termes nécessaires seulement), puis F*P*F' = A*F'
+    float a00 = _p00 + dt*_p01 + halfDt2*_p02;
+    float a01 = _p01 + dt*_p11 + halfDt2*_p12;
+    float a02 = _p02 + dt*_p12 + halfDt2*_p22;
+    float a11 = _p11 + dt*_p12;
+    float a12 = _p12 + dt*_p22;
+
+    _p00 = a00 + dt*a01 + halfDt2*a02 + _q00;
+    _p01 = a01 + dt*a02 + _q01;
+    _p02 = a02 + _q02;
+    _p11 = a11 + dt*a12 + _q11;
+    _p12 = a12 + _q12;
+    _p22 = _p22 + _q22;
+}
+
+void AltitudeEstimator::_correct(float mesuredAltitude) {
+/*
+ * Mesure de l'altitude seulement (H = [1 0 0]): le gain de Kalman est la première colonne de P
+ * divisée par la variance de l'innovation, et P = P - K*H*P.
+ */
+    float innovation = mesuredAltitude - _altitude;
+    float inverseVariance = 1/(_p00 + _measurementVariance);
+    float k0 = _p00*inverseVariance;
+    float k1 = _p01*inverseVariance;
+    float k2 = _p02*inverseVariance;
+
+    _altitude += k0*innovation;
+    _velocity += k1*innovation;
+    _acceleration += k2*innovation;
+
+    float p00 = _p00;
+    float p01 = _p01;
+    float p02 = _p02;
+    _p00 -= k0*p00;
+    _p01 -= k0*p01;
+    _p02 -= k0*p02;
+    _p11 -= k1*p01;
+    _p12 -= k1*p02;
+    _p22 -= k2*p02;
+}
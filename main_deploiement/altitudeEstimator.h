@@ -0,0 +1,58 @@
+/*
+ * Ce module est un filtre de Kalman qui estime l'altitude, la vitesse verticale et l'accélération
+ * de la fusée à partir des altitudes mesurées par le baromètre.
+ *
+ * Le modèle est à accélération presque constante: entre deux échantillons, l'accélération varie
+ * selon un bruit blanc de secousse (jerk). La seule mesure est l'altitude brute. Contrairement à
+ * la vitesse calculée sur l'altitude filtrée, la vitesse estimée est signée (positive en montée)
+ * et n'attend pas le délai de groupe du filtre passe-bas.
+ *
+ * La matrice de covariance est symétrique: seuls ses 6 termes distincts sont conservés et les
+ * produits matriciels sont développés à la main. Une mise à jour coûte donc toujours le même
+ * nombre d'opérations, sans inversion de matrice (la mesure est un scalaire).
+ *
+ * update() reçoit le temps écoulé depuis la mesure précédente: la prédiction avance l'état de la
+ * durée réelle, même si une mesure a été perdue ou prise en retard.
+ *
+ * Les paramètres d'initialisation sont:
+ *    - La période d'échantillonnage nominale (s)
+ *    - L'écart-type du bruit de mesure de l'altitude (m)
+ *    - La densité spectrale du bruit de secousse (m/s^3)
+ */
+
+#ifndef altitudeEstimator_h
+#define altitudeEstimator_h
+
+#include "Arduino.h"
+
+class AltitudeEstimator {
+    public:
+        AltitudeEstimator();
+        void init(float samplingPeriod, float altitudeNoise, float jerkNoise);
+        void resume(float altitude, float velocity, float acceleration);
+        void update(float mesuredAltitude, float elapsedTime);
+        float getAltitude();
+        float getVelocity();
+        float getAcceleration();
+
+    private:
+        float _samplingPeriod;
+        float _measurementVariance;
+        float _jerkDensity;
+
+        // État estimé: altitude (m), vitesse (m/s), accélération (m/s^2)
+        float _altitude;
+        float _velocity;
+        float _acceleration;
+
+        // Covariance de l'estimation (termes du triangle supérieur)
+        float _p00, _p01, _p02, _p11, _p12, _p22;
+
+        // Covariance du bruit de processus pour _samplingPeriod, recalculée quand l'intervalle change
+        float _q00, _q01, _q02, _q11, _q12, _q22;
+
+        void _setSamplingPeriod(float dt);
+        void _predict();
+        void _correct(float mesuredAltitude);
+};
+#endif
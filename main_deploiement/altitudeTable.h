@@ -0,0 +1,65 @@
+/*
+ * Table de conversion de la pression en altitude.
+ *
+ * L'altitude est donnée par la formule barométrique internationale, la même que celle du pilote
+ * d'Adafruit:
+ *    h = 44330 * (1 - (p/p0)^0.1903)
+ * Elle ne dépend que du rapport p/p0. La table contient h pour ALTITUDE_TABLE_SIZE rapports
+ * également espacés entre ALTITUDE_TABLE_MIN_RATIO (5478 m) et ALTITUDE_TABLE_MAX_RATIO
+ * (-1005 m), dont le rapport 1 (altitude 0). Elle couvre FLIGHT_MINIMAL_ALTITUDE et
+ * FLIGHT_MAXIMAL_ALTITUDE avec la tolérance ALTIMETER_INVALID_ALTITUDE_TOLERANCE. Entre deux
+ * entrées, l'altitude est interpolée linéairement: l'erreur est d'au plus 6 cm de 0 à 4000 m et
+ * de 8 cm sur toute la table (voir simulation/altitudeBenchmark.cpp).
+ *
+ * La table est gardée dans la mémoire flash (PROGMEM). Elle a été générée par:
+ *    simulation/build/altitudeBenchmark --table
+ */
+
+#ifndef altitudeTable_h
+#define altitudeTable_h
+
+#include "Arduino.h"
+
+#define ALTITUDE_TABLE_SIZE             121
+#define ALTITUDE_TABLE_MIN_RATIO        0.500
+#define ALTITUDE_TABLE_MAX_RATIO        1.125
+#define ALTITUDE_TABLE_STEPS_PER_RATIO  ((ALTITUDE_TABLE_SIZE - 1)/(ALTITUDE_TABLE_MAX_RATIO - ALTITUDE_TABLE_MIN_RATIO))
+
+static const float ALTITUDE_TABLE[ALTITUDE_TABLE_SIZE] PROGMEM = {
+    5478.15f, 5401.46f, 5325.40f, 5249.97f, 5175.16f, 5100.94f, 5027.32f, 4954.29f,
+    4881.82f, 4809.92f, 4738.57f, 4667.76f, 4597.49f, 4527.74f, 4458.50f, 4389.78f,
+    4321.55f, 4253.82f, 4186.57f, 4119.79f, 4053.49f, 3987.64f, 3922.25f, 3857.31f,
+    3792.80f, 3728.74f, 3665.09f, 3601.87f, 3539.07f, 3476.67f, 3414.67f, 3353.08f,
+    3291.87f, 3231.05f, 3170.61f, 3110.55f, 3050.85f, 2991.52f, 2932.55f, 2873.94f,
+    2815.68f, 2757.76f, 2700.18f, 2642.94f, 2586.04f, 2529.46f, 2473.20f, 2417.27f,
+    2361.65f, 2306.34f, 2251.34f, 2196.65f, 2142.26f, 2088.16f, 2034.35f, 1980.84f,
+    1927.61f, 1874.66f, 1822.00f, 1769.61f, 1717.49f, 1665.64f, 1614.06f, 1562.74f,
+    1511.69f, 1460.89f, 1410.35f, 1360.05f, 1310.01f, 1260.22f, 1210.66f, 1161.35f,
+    1112.28f, 1063.44f, 1014.84f, 966.47f, 918.32f, 870.40f, 822.71f, 775.24f,
+    727.98f, 680.95f, 634.13f, 587.52f, 541.12f, 494.93f, 448.94f, 403.16f,
+    357.58f, 312.20f, 267.02f, 222.04f, 177.25f, 132.65f, 88.25f, 44.03f,
+    0.00f, -43.85f, -87.51f, -130.99f, -174.29f, -217.41f, -260.35f, -303.12f,
+    -345.72f, -388.14f, -430.39f, -472.47f, -514.39f, -556.14f, -597.73f, -639.15f,
+    -680.41f, -721.51f, -762.45f, -803.23f, -843.86f, -884.33f, -924.65f, -964.82f,
+    -1004.84f
+};
+
+inline float altitudeFromPressureRatio(float ratio) {
+/*
+ * Interpolation linéaire dans ALTITUDE_TABLE. Hors de la table, l'altitude est celle de
+ * l'extrémité la plus proche: elle sera rejetée par la validation de l'altitude.
+ */
+    float position = (ratio - ALTITUDE_TABLE_MIN_RATIO)*ALTITUDE_TABLE_STEPS_PER_RATIO;
+    if(position <= 0) {
+        return pgm_read_float(&ALTITUDE_TABLE[0]);
+    }
+    if(position >= ALTITUDE_TABLE_SIZE - 1) {
+        return pgm_read_float(&ALTITUDE_TABLE[ALTITUDE_TABLE_SIZE - 1]);
+    }
+    byte index = (byte)position;
+    float lower = pgm_read_float(&ALTITUDE_TABLE[index]);
+    float upper = pgm_read_float(&ALTITUDE_TABLE[index + 1]);
+    return lower + (upper - lower)*(position - index);
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "apogeeDetector.h"
+
+#define APOGEE_GRAVITY  9.81 // m/s^2
+
+ApogeeDetector::ApogeeDetector() {
+    _confirmationDelay = 0;
+    _speedHysteresis = 0;
+    _prediction = false;
+    _predictionSpeed = 0;
+    _descentTime = 0;
+    _predicted = false;
+}
+
+void ApogeeDetector::init(unsigned long confirmationDelay, float speedHysteresis, unsigned long speedLag) {
+/*
+ * Le seuil de la prédiction est calculé une seule fois. Sans prédiction (speedLag à 0), seule la
+ * descente confirmée détecte l'apogée.
+ */
+    _confirmationDelay = confirmationDelay;
+    _speedHysteresis = speedHysteresis;
+    _prediction = speedLag > 0;
+    _predictionSpeed = APOGEE_GRAVITY*speedLag/1000000.0 - speedHysteresis;
+    _descentTime = 0;
+    _predicted = false;
+}
+
+void ApogeeDetector::resume(unsigned long descentTime) {
+/*
+ * Reprend le temps en descente avant un redémarrage en vol (appelée après init()).
+ */
+    _descentTime = descentTime;
+}
+
+bool ApogeeDetector::update(float verticalSpeed, unsigned long sampleInterval) {
+/*
+ * Retourne true quand l'apogée est prédit ou confirmé. La mesure qui fait passer sous
+ * -speedHysteresis compte déjà pour son intervalle: le passage par zéro a eu lieu pendant
+ * celui-ci.
+ */
+    if(_descentTime > 0) {
+        if(verticalSpeed > _speedHysteresis) {
+            _descentTime = 0;
+        }
+        else {
+            _descentTime += sampleInterval;
+        }
+    }
+    else if(verticalSpeed < -_speedHysteresis) {
+        _descentTime = sampleInterval > 0 ? sampleInterval : 1;
+    }
+
+    if(_prediction && verticalSpeed < _predictionSpeed) {
+        _predicted = true;
+        return true;
+    }
+    return _descentTime >= _confirmationDelay;
+}
+
+unsigned long ApogeeDetector::getDescentTime() {
+    return _descentTime;
+}
+
+bool ApogeeDetector::isPredicted() {
+/*
+ * true si l'apogée a été détecté par la prédiction plutôt que par la descente confirmée.
+ */
+    return _predicted;
+}
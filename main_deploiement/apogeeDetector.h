@@ -0,0 +1,45 @@
+/*
+ * Ce module détecte l'apogée à partir de la vitesse verticale signée de la fusée (m/s, positive en
+ * montée, voir Rocket::getVerticalSpeed()), une fois par mesure d'altitude.
+ *
+ * Passage par zéro avec hystérésis: la fusée est considérée en descente quand la vitesse passe
+ * sous -speedHysteresis, et de nouveau en montée seulement quand elle repasse au-dessus de
+ * +speedHysteresis. Le bruit autour de zéro ne remet donc pas le compte à zéro. L'apogée est
+ * confirmé quand la fusée est en descente depuis confirmationDelay (temps réel des mesures).
+ *
+ * Prédiction (speedLag > 0): la vitesse mesurée est en retard de speedLag sur la vitesse réelle
+ * (délai de groupe du filtre et fenêtre de la dérivée). Près de l'apogée, la fusée décélère d'au
+ * moins g (la traînée s'ajoute à la gravité), donc la vitesse réelle est au plus
+ * v - g*speedLag et le temps avant l'apogée au plus v/g - speedLag. L'apogée est prédit atteint
+ * quand ce temps tombe sous zéro, avec la même marge d'hystérésis: v < g*speedLag - speedHysteresis.
+ * La borne est prudente: une décélération plus forte que g place l'apogée réelle plus tôt, jamais
+ * plus tard. speedLag doit être mesuré sur des vols (voir simulation/apogeeBenchmark.cpp); une
+ * valeur trop grande commande le drogue avant l'apogée.
+ *
+ * La prédiction n'est vraie qu'à faible vitesse: update() ne doit être appelée qu'après la fin de
+ * la poussée (étape PRE_DROGUE du plan de vol).
+ */
+
+#ifndef apogeeDetector_h
+#define apogeeDetector_h
+
+#include "Arduino.h"
+
+class ApogeeDetector {
+    public:
+        ApogeeDetector();
+        void init(unsigned long confirmationDelay, float speedHysteresis, unsigned long speedLag);
+        void resume(unsigned long descentTime);
+        bool update(float verticalSpeed, unsigned long sampleInterval);
+        unsigned long getDescentTime();
+        bool isPredicted();
+
+    private:
+        unsigned long _confirmationDelay;   // us
+        float _speedHysteresis;             // m/s
+        bool _prediction;                   // false si speedLag est 0
+        float _predictionSpeed;             // m/s, vitesse mesurée sous laquelle l'apogée est prédit
+        unsigned long _descentTime;         // us, 0 en montée
+        bool _predicted;
+};
+#endif /* apogeeDetector_h */
@@ -0,0 +1,119 @@
+#include "barometerFusion.h"
+
+BarometerFusion::BarometerFusion() {
+    _tolerance = 0;
+    _maxRate = 0;
+    _failureSamples = 1;
+    _hasReference = false;
+    for(byte i = 0; i < BAROMETER_FUSION_SENSORS; i++) {
+        _health[i].readings = 0;
+        _health[i].failures = 0;
+        _health[i].rejections = 0;
+        _health[i].lostSamples = 0;
+        _health[i].healthy = true;
+        _health[i].changes = 0;
+        _faults[i] = 0;
+    }
+}
+
+void BarometerFusion::init(float tolerance, float maxRate, byte failureSamples) {
+    _tolerance = tolerance;
+    _maxRate = maxRate;
+    _failureSamples = failureSamples > 0 ? failureSamples : 1;
+    reset();
+}
+
+void BarometerFusion::reset() {
+/*
+ * Oublie la dernière altitude fusionnée (démarrage ou reprise d'un vol): la prochaine lecture
+ * n'est pas comparée à la prédiction. Les compteurs de santé sont gardés.
+ */
+    _hasReference = false;
+}
+
+bool BarometerFusion::fuse(const float altitudes[BAROMETER_FUSION_SENSORS], const bool valid[BAROMETER_FUSION_SENSORS],
+                           float predictedAltitude, unsigned long elapsedTime, float &altitude) {
+/*
+ * predictedAltitude et elapsedTime (us) viennent de la dernière altitude fusionnée; ils sont
+ * ignorés avant la première.
+ */
+    float window = _tolerance + _maxRate*(elapsedTime/1000000.0);
+    bool plausible[BAROMETER_FUSION_SENSORS];
+    for(byte i = 0; i < BAROMETER_FUSION_SENSORS; i++) {
+        plausible[i] = valid[i] && (!_hasReference || fabs(altitudes[i] - predictedAltitude) <= window);
+    }
+
+    if(valid[0] && valid[1] && fabs(altitudes[0] - altitudes[1]) <= _tolerance) {
+        altitude = (altitudes[0] + altitudes[1])/2;
+        _accept(0);
+        _accept(1);
+    }
+    else if(plausible[0] && plausible[1]) {
+        byte kept = fabs(altitudes[0] - predictedAltitude) <= fabs(altitudes[1] - predictedAltitude) ? 0 : 1;
+        altitude = altitudes[kept];
+        _accept(kept);
+        _reject(1 - kept, false);
+    }
+    else if(plausible[0] || plausible[1]) {
+        byte kept = plausible[0] ? 0 : 1;
+        altitude = altitudes[kept];
+        _accept(kept);
+        _reject(1 - kept, !valid[1 - kept]);
+    }
+    else {
+        for(byte i = 0; i < BAROMETER_FUSION_SENSORS; i++) {
+            _reject(i, !valid[i]);
+            _health[i].lostSamples++;
+        }
+        return false;
+    }
+    _hasReference = true;
+    return true;
+}
+
+BarometerHealth BarometerFusion::getHealth(byte sensor) {
+    return _health[sensor < BAROMETER_FUSION_SENSORS ? sensor : 0];
+}
+
+String BarometerFusion::getReportLine(byte sensor) {
+/*
+ * Les capteurs sont numérotés à partir de 1, comme dans les évènements de l'historique.
+ */
+    BarometerHealth health = getHealth(sensor);
+    String line = F("profiler,barometer,");
+    line += String(sensor + 1);
+    line += ',';
+    line += String(health.readings);
+    line += ',';
+    line += String(health.failures);
+    line += ',';
+    line += String(health.rejections);
+    line += ',';
+    line += String(health.lostSamples);
+    return line;
+}
+
+void BarometerFusion::_accept(byte sensor) {
+    _health[sensor].readings++;
+    _faults[sensor] = 0;
+    if(!_health[sensor].healthy) {
+        _health[sensor].healthy = true;
+        _health[sensor].changes++;
+    }
+}
+
+void BarometerFusion::_reject(byte sensor, bool failure) {
+    if(failure) {
+        _health[sensor].failures++;
+    }
+    else {
+        _health[sensor].rejections++;
+    }
+    if(_faults[sensor] < 255) {
+        _faults[sensor]++;
+    }
+    if(_health[sensor].healthy && _faults[sensor] >= _failureSamples) {
+        _health[sensor].healthy = false;
+        _health[sensor].changes++;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Ce module fusionne les altitudes de deux baromètres en une seule mesure (voir ALTIMETER_DUAL), en
+ * rejetant les lectures aberrantes d'un capteur.
+ *
+ * Une lecture est d'abord rejetée si le capteur n'a pas répondu ou si l'altitude est hors de la
+ * plage du vol (voir Rocket::_validateAltitude()). Ensuite:
+ *    - Deux lectures qui s'accordent à tolerance près donnent leur moyenne. Elles sont gardées même
+ *      loin de la prédiction: un vrai changement de pression (onde de choc à Mach 1) est vu par les
+ *      deux capteurs.
+ *    - Variation: une lecture seule doit rester près de l'altitude prédite par la dernière altitude
+ *      fusionnée et la vitesse, à tolerance + maxRate*(temps depuis cette altitude) près. La
+ *      fenêtre s'élargit pendant une panne des deux capteurs: la fusion ne reste pas bloquée.
+ *    - Plus proche de la prédiction: de deux lectures en désaccord, toutes deux dans la fenêtre,
+ *      seule celle qui est la plus proche de la prédiction est gardée. L'autre est rejetée.
+ * fuse() retourne false si aucune lecture n'est gardée: la mesure est perdue.
+ *
+ * Santé de chaque capteur: lectures gardées, échecs (pas de réponse ou hors plage), rejets et
+ * mesures perdues pendant lesquelles le capteur a échoué ou été rejeté. Le sketch n'écrit pas
+ * d'évènement pour chaque mesure perdue, seulement les pannes et les retours des capteurs. Un
+ * capteur est déclaré en panne après failureSamples échecs ou rejets de suite, et de nouveau sain
+ * à la première lecture gardée; changes compte ces transitions pour que le sketch les écrive dans
+ * l'historique. La ligne du rapport (getReportLine()) est écrite avec celle du LoopProfiler:
+ *     profiler,barometer,<capteur>,<lectures gardées>,<échecs>,<rejets>,<mesures perdues>
+ */
+
+#ifndef barometerFusion_h
+#define barometerFusion_h
+
+#include "Arduino.h"
+
+#define BAROMETER_FUSION_SENSORS  2
+
+struct BarometerHealth {
+    unsigned long readings;     // Lectures gardées
+    unsigned long failures;     // Pas de réponse ou altitude hors plage
+    unsigned long rejections;   // Variation trop grande ou plus loin de la prédiction que l'autre
+    unsigned long lostSamples;  // Mesures sans aucune lecture gardée (fuse() retourne false)
+    bool healthy;
+    uint8_t changes;            // Nombre de passages de sain à en panne ou l'inverse
+};
+
+class BarometerFusion {
+    public:
+        BarometerFusion();
+        void init(float tolerance, float maxRate, byte failureSamples);
+        void reset();
+        bool fuse(const float altitudes[BAROMETER_FUSION_SENSORS], const bool valid[BAROMETER_FUSION_SENSORS],
+                  float predictedAltitude, unsigned long elapsedTime, float &altitude);
+        BarometerHealth getHealth(byte sensor);
+        String getReportLine(byte sensor);
+
+    private:
+        float _tolerance;           // m
+        float _maxRate;             // m/s
+        byte _failureSamples;
+        bool _hasReference;         // false jusqu'à la première altitude fusionnée
+        BarometerHealth _health[BAROMETER_FUSION_SENSORS];
+        byte _faults[BAROMETER_FUSION_SENSORS];   // Échecs ou rejets de suite
+
+        void _accept(byte sensor);
+        void _reject(byte sensor, bool failure);
+};
+#endif /* barometerFusion_h */
@@ -1,84 +1,122 @@
 #include "buzzer.h"
 
 Buzzer::Buzzer() {
-  
+    _buzzerControlPin = 0;
+    _patterns = 0;
+    _patternCount = 0;
+    _requestedPattern = 0;
+    _pattern = 0;
+    _segment = 0;
+    memset(&_segmentValue, 0, sizeof(_segmentValue));
+    _repetition = 0;
+    _soundOn = false;
+    _output = false;
+    _phaseStart = 0;
 }
 
-void Buzzer::init(byte arduinoPin, int sequenceDuration, int soundDuration) { 
-    if(sequenceDuration < 5000) {
-        sequenceDuration = 5000;
-    }
-    
-    else if(sequenceDuration > 10000) {
-        sequenceDuration = 10000;
-    }
-    
-    if(soundDuration < 500) {
-        soundDuration = 500;
-    }
-    
-    else if(soundDuration > 1500) {
-        soundDuration = 1500;
-    }
-    
+void Buzzer::init(byte arduinoPin, const BuzzerSegment *const *patterns, byte patternCount) {
+/*
+ * patterns est une table de patternCount séquences en mémoire flash. Le buzzer commence avec la
+ * séquence 0 (silence).
+ */
     _buzzerControlPin = arduinoPin;
-    _sequenceDuration = sequenceDuration;
-    _cycleDuration = soundDuration;
-    
+    _patterns = patterns;
+    _patternCount = patternCount;
+    _requestedPattern = 0;
+    _pattern = 0;
+    _startPattern(0);
+
     pinMode(_buzzerControlPin, OUTPUT);
     turnOff();
 }
 
-void Buzzer::executeBuzzerSequence(byte numberOfCycle) {
-/*    
- *     La fonction executeBuzzerSequence n'est pas blocante, c'est-à-dire que le programme
- *     principal peut continuer à travailler pendant que la librairie gère la séquence en
- *     cours. La fonction executeBuzzerSequence gère la séquence en vérifiant les indices
- *     de temps notée par rapport aux paramètres de la séquence qui caractérise l'objet buzzer.
+void Buzzer::play(byte pattern) {
+/*
+ * Demande une séquence, jouée à partir du prochain tick. Redemander la séquence en cours ne la
+ * recommence pas.
  */
-    int timeNow = millis();
-    int sequenceDurationCounter = timeNow - _sequenceBeginningTimestamp;
-
-    // Vérification de si on doit recommencer une nouvelle séquence
-    if(sequenceDurationCounter > _sequenceDuration) {
-        _sequenceBeginningTimestamp = timeNow;
-        sequenceDurationCounter = 0;
+    if(pattern < _patternCount) {
+        _requestedPattern = pattern;
     }
+}
 
-    // Vérification de l'étape où le buzzer est dans la séquence
-    if(sequenceDurationCounter > 7*_cycleDuration/2 && numberOfCycle > 3) {
-        turnOff();
-    }
-    else if(sequenceDurationCounter > 6*_cycleDuration/2 && numberOfCycle > 3) {
-        turnOn();
-    }    
-    
-    else if(sequenceDurationCounter > 5*_cycleDuration/2 && numberOfCycle > 2) {
-        turnOff();
-    }
-    else if(sequenceDurationCounter > 4*_cycleDuration/2 && numberOfCycle > 2) {
-        turnOn();
-    }
-    
-    else if(sequenceDurationCounter > 3*_cycleDuration/2 && numberOfCycle > 1) {
-        turnOff();
-    }
-    else if(sequenceDurationCounter > 2*_cycleDuration/2 && numberOfCycle > 1) {
-        turnOn();
+void Buzzer::tick(unsigned long timeNow) {
+/*
+ * Appelée par l'interruption du Timer1. Passe les phases terminées depuis le tick précédent et
+ * met la sortie à jour seulement si elle change.
+ */
+    byte requested = _requestedPattern;
+    if(requested != _pattern) {
+        _pattern = requested;
+        _startPattern(timeNow);
     }
-    
-    else if(sequenceDurationCounter > _cycleDuration/2) {
-        turnOff();
+    if(_segmentValue.count > 0) {
+        unsigned long duration = _phaseDuration();
+        while(timeNow - _phaseStart >= duration) {
+            _phaseStart += duration;
+            _nextPhase();
+            duration = _phaseDuration();
+        }
     }
-    else if(sequenceDurationCounter >= 0) {
-        turnOn();
+    bool output = _segmentValue.count > 0 && _soundOn;
+    if(output != _output) {
+        if(output) {
+            turnOn();
+        }
+        else {
+            turnOff();
+        }
     }
 }
 
 void Buzzer::turnOn() {
     digitalWrite(_buzzerControlPin, 1);
+    _output = true;
 }
 
 void Buzzer::turnOff() {
     digitalWrite(_buzzerControlPin, 0);
+    _output = false;
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------
+// Méthodes privées
+
+void Buzzer::_startPattern(unsigned long timeNow) {
+    if(_patterns) {
+        _loadSegment((const BuzzerSegment *)pgm_read_ptr(&_patterns[_pattern]));
+    }
+    _repetition = 0;
+    _soundOn = true;
+    _phaseStart = timeNow;
+}
+
+void Buzzer::_loadSegment(const BuzzerSegment *segment) {
+    _segment = segment;
+    memcpy_P(&_segmentValue, segment, sizeof(_segmentValue));
+}
+
+unsigned long Buzzer::_phaseDuration() {
+    return _soundOn ? _segmentValue.onDuration : _segmentValue.offDuration;
+}
+
+void Buzzer::_nextPhase() {
+/*
+ * Son, puis silence, count fois; ensuite le segment suivant, ou le premier à la fin de la
+ * séquence.
+ */
+    if(_soundOn) {
+        _soundOn = false;
+        return;
+    }
+    _soundOn = true;
+    if(++_repetition < _segmentValue.count) {
+        return;
+    }
+    _repetition = 0;
+    _loadSegment(_segment + 1);
+    if(_segmentValue.count == 0) {
+        _loadSegment((const BuzzerSegment *)pgm_read_ptr(&_patterns[_pattern]));
+    }
 }
@@ -1,41 +1,65 @@
-/*  
- * Créé par Dominic Caron le 2016-02-29.  
+/*
+ * Créé par Dominic Caron le 2016-02-29.
  * Ce module permet d'interfacer un buzzer simple sur un Arduino. Le buzzer est controlé de façon binaire,
- * il est activé tant qu'on lui fournit un 3.3V (High) et il est éteint avec un 0V (Low). 
- * 
- * Les paramètres d'initialisation sont:
- *    - Le numéro de pin du Arduino
- *    - La durée d'une séquence.
- *        Entre 5000 et 10000 ms. Ces valeurs ont été déterminé de façon arbitraire
- *    - La durée d'un cycle (High suivit d'un Low sur le signal de control)
- *        Entre 500 et 1500 ms. Ces valeurs ont été déterminé de façon arbitraire 
- *        
- * Une séquence est composée de un ou plusieurs cycles suivit d'un moment de silence tampon. Un cycle 
- * correspond à une période d'un signal carré. 
- * 
- * Exemple d'une séquence de durée déterminé composé de 1 cycle, 2 cycles et 4 cycles: 
- *    (High, Low),  Low,  Low,   Low,  Low,  Low, Low, Low, Low, Low, Low
- *    (High, Low), (High, Low),  Low,  Low,  Low, Low, Low, Low, Low, Low
- *    (High, Low), (High, Low), (High, Low), Low, Low, Low, Low, Low, Low
+ * il est activé tant qu'on lui fournit un 3.3V (High) et il est éteint avec un 0V (Low).
+ *
+ * Les séquences sonores sont des données: une séquence est une suite de segments gardée dans la
+ * mémoire flash, terminée par un segment {0, 0, 0}. Un segment est répété count fois: le buzzer
+ * sonne pendant onDuration ms puis se tait pendant offDuration ms. Un segment avec onDuration à 0
+ * est un silence. À la fin, la séquence recommence au premier segment. La séquence 0 de la table
+ * doit être vide (silence); la durée totale des autres séquences ne doit pas être nulle.
+ *
+ * Exemple des séquences de continuité (voir BUZZER_PATTERNS dans configCircuitDeploiement.h),
+ * 1 bip, 2 bips et 3 bips dans une séquence de 6 cycles:
+ *    (High, Low),  Low,  Low,   Low,  Low,  Low
+ *    (High, Low), (High, Low),  Low,  Low,  Low
+ *    (High, Low), (High, Low), (High, Low), Low
+ *
+ * La boucle principale ne fait que demander une séquence (play()). La séquence avance dans
+ * tick(), appelée par l'interruption du Timer1: le rythme ne dépend pas de la durée de la boucle.
+ * Les changements arrivent au premier tick qui suit la fin d'un segment et le segment suivant
+ * part de la fin prévue du précédent: avec des durées multiples de la période du Timer1, les
+ * durées sont exactes. Le temps est en millisecondes sur 32 bits, comparé par différence: le
+ * passage de millis() à zéro (49 jours) ne dérange pas la séquence.
  */
- 
+
 #ifndef buzzer_h
 #define buzzer_h
 
 #include "Arduino.h"
 
-class Buzzer {   
+struct BuzzerSegment {
+    uint16_t onDuration;    // ms
+    uint16_t offDuration;   // ms
+    uint8_t count;          // 0: fin de la séquence
+};
+
+class Buzzer {
     public:
         Buzzer();
-        void init(byte arduinoPin, int sequenceDuration, int soundDuration);
+        void init(byte arduinoPin, const BuzzerSegment *const *patterns, byte patternCount);
         void turnOn();
         void turnOff();
-        void executeBuzzerSequence(byte numberOfCycle);
-    
-    private:    
+        void play(byte pattern);
+        void tick(unsigned long timeNow);
+
+    private:
         byte _buzzerControlPin;
-        int _sequenceDuration;
-        int _cycleDuration;
-        int _sequenceBeginningTimestamp;        
+        const BuzzerSegment *const *_patterns;  // Table en mémoire flash
+        byte _patternCount;
+        volatile byte _requestedPattern;        // Écrit par la boucle principale seulement
+        // État de la séquence, modifié par tick() seulement
+        byte _pattern;
+        const BuzzerSegment *_segment;          // Segment courant, en mémoire flash
+        BuzzerSegment _segmentValue;
+        byte _repetition;
+        bool _soundOn;                          // Phase du segment: son ou silence
+        bool _output;                           // État de la sortie
+        unsigned long _phaseStart;
+
+        void _startPattern(unsigned long timeNow);
+        void _loadSegment(const BuzzerSegment *segment);
+        unsigned long _phaseDuration();
+        void _nextPhase();
 };
 #endif /* buzzer_h */
@@ -6,11 +6,27 @@
 #define _configCircuitDeploiement_h
 
 #include <Wire.h>
-#include "Adafruit_BMP085.h"
+#include "altimeter.h"
+#include "altitudeTable.h"
 #include <SPI.h>
 #include "SD.h"
+#include <EEPROM.h>
 #include "buzzer.h"
 #include "match.h"
+#include "continuity.h"
+#include "logWriter.h"
+#include "logFormat.h"
+#include "iirFilter.h"
+#include "altitudeEstimator.h"
+#include "apogeeDetector.h"
+#include "barometerFusion.h"
+#include "loopProfiler.h"
+#include "spscQueue.h"
+#include "ringBuffer.h"
+#include "flightJournal.h"
+#include "telemetry.h"
+#include "memoryMonitor.h"
+#include "taskScheduler.h"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -46,16 +62,156 @@
 
 #define ALTIMETER_INVALID_ALTITUDE_TOLERANCE    1000.0
 
+// Acquisition non bloquante du BMP180 (voir altimeter.h). Une mesure dure au plus
+// 4,5 ms (température) + 4,5 à 25,5 ms (pression) selon le suréchantillonnage, ce qui permet
+// d'échantillonner à 25-50 Hz.
+#define ALTIMETER_OVERSAMPLING        BMP085_OVERSAMPLING_ULTRAHIGHRES
+#define ALTIMETER_TEMPERATURE_PERIOD  10       // Nombre de mesures de pression par mesure de température
+#define ALTIMETER_I2C_CLOCK           400000   // Hz
+
+// Deuxième baromètre (voir barometerFusion.h). Les deux BMP180 ont la même adresse I2C: chacun est
+// branché sur un canal d'un multiplexeur TCA9548A (SDA/SCL du Arduino -> SDA/SCL du multiplexeur,
+// A0-A2 à GND). Les deux mesures sont lancées en même temps; l'échantillon est prêt quand les deux
+// sont terminées. Chaque capteur a sa propre pression au sol: l'erreur absolue d'un BMP180 (1 hPa,
+// environ 8 m) dépasse largement son bruit.
+#ifndef ALTIMETER_DUAL
+#define ALTIMETER_DUAL                0
+#endif
+#define ALTIMETER_FIRST_MUX_CHANNEL   0
+#define ALTIMETER_SECOND_MUX_CHANNEL  1
+#define BAROMETER_FUSION_TOLERANCE    5.0      // m, écart entre deux lectures qui s'accordent
+#define BAROMETER_FUSION_MAX_RATE     100.0    // m/s, élargissement de la fenêtre autour de la prédiction
+#define BAROMETER_FAILURE_SAMPLES     10       // Échecs ou rejets de suite avant qu'un capteur soit en panne
+
 //-------------------------------------------------------------------------------------------------
 //  Log unit
 
 // Paramètres
+#ifndef LOG_UNIT_SERIAL_BAUDRATE
 #define LOG_UNIT_SERIAL_BAUDRATE  115200
+#endif
 #define LOG_UNIT_FILE_NAME        "alt"
-#define LOG_UNIT_MAX_NB_OF_FILES  99
+#define LOG_UNIT_MAX_NB_OF_FILES  9999 // alt_9999: 8 caractères, la limite d'un nom de fichier de la carte (8.3)
+
+// Numéro du fichier d'historique (voir Rocket::_nextLogFileName()). Le numéro du dernier fichier
+// est gardé dans l'EEPROM: le démarrage fait un seul SD.exists() au lieu d'un par vol déjà sur la
+// carte.
+#ifndef LOG_UNIT_FILE_INDEX
+#define LOG_UNIT_FILE_INDEX       1 // 0: cherche le premier numéro libre à partir de 1 avec SD.exists()
+#endif
+#define LOG_UNIT_MAX_FILE_PROBES  8 // SD.exists() au plus au démarrage, avec LOG_UNIT_FILE_INDEX
+
+// Ouverture du fichier d'historique. FILE_WRITE contient O_APPEND: la librairie SD ramènerait
+// chaque écriture à la fin du fichier, après le remplissage de la préallocation ou après la
+// position d'un vol repris.
+#define LOG_UNIT_FILE_MODE        (O_READ | O_WRITE | O_CREAT)
+
+// Taille du fichier écrite sur la rampe, un bloc à la fois, avant le vol (voir
+// Rocket::preallocateLog()).
+#ifndef LOG_UNIT_PREALLOCATED_SIZE
+#define LOG_UNIT_PREALLOCATED_SIZE  131072 // octets, 0: le fichier grandit pendant le vol
+#endif
+
+// Format du fichier: texte (CSV) ou enregistrements binaires de taille fixe (voir logFormat.h).
+// En binaire, seules les lignes d'évènements sont envoyées sur le port série (toutes les lignes
+// avec SERIAL_TELEMETRY).
+#ifndef LOG_UNIT_BINARY
+#define LOG_UNIT_BINARY           0
+#endif
+
+#if LOG_UNIT_BINARY
+#define LOG_UNIT_FILE_EXT         ".bin"
+#else
 #define LOG_UNIT_FILE_EXT         ".csv"
+#endif
+#define LOG_UNIT_KEYFRAME_PERIOD  50 // Données delta entre deux données complètes du format binaire
+
+// Octet de remplissage du fichier préalloué: des lignes vides en texte
+#if LOG_UNIT_BINARY
+#define LOG_UNIT_FILL_BYTE        LOG_FORMAT_FILL
+#else
+#define LOG_UNIT_FILL_BYTE        '\n'
+#endif
 
-// Messages d'évènements
+// Port série: lignes de texte envoyées par Serial.println(), qui attend quand le tampon d'émission
+// est plein, ou trames binaires envoyées seulement quand le tampon a de la place (voir
+// telemetry.h). En binaire, une donnée sur SERIAL_TELEMETRY_DECIMATION est envoyée; les
+// évènements et les messages le sont tous.
+#ifndef SERIAL_TELEMETRY
+#define SERIAL_TELEMETRY              0
+#endif
+#ifndef SERIAL_TELEMETRY_DECIMATION
+#define SERIAL_TELEMETRY_DECIMATION   1
+#endif
+
+// Écriture de l'historique sur la carte SD sans flush à chaque ligne (voir logWriter.h)
+#ifndef LOG_UNIT_BUFFERED
+#define LOG_UNIT_BUFFERED             1 // 0: chaque ligne de data est écrite et flushée sur la carte
+#endif
+#define LOG_UNIT_SECTORS_PER_COMMIT   2 // Secteurs pleins écrits entre deux mises à jour du répertoire
+
+// File des données et des évènements à écrire (voir Rocket::logData() et Rocket::logEvent()):
+// l'écriture est faite par la tâche de l'historique, après le plan de vol. 17 octets par entrée
+// (29 avec l'estimateur de Kalman).
+#define LOG_UNIT_DATA_QUEUE_SIZE      4
+
+// Tampon de la rampe (voir Rocket::startPadBuffer()). Sur la rampe, les échantillons sont gardés
+// en RAM et un seul échantillon par LOG_UNIT_PAD_HEARTBEAT_PERIOD est écrit sur la carte. Les
+// LOG_UNIT_PAD_BUFFER_SECONDS dernières secondes sont écrites d'un coup au décollage.
+// Le tampon prend 16 octets par échantillon (28 avec l'estimateur de Kalman), 160 octets pour une
+// seconde: selon le budget de RAM estimé dans le README (non mesuré), il ne tiendrait pas dans les
+// 2 ko de RAM du Arduino Nano avec la librairie SD, le port série et le bus I2C. Il n'est donc
+// compilé que sur demande.
+#ifndef LOG_UNIT_PAD_BUFFER
+#define LOG_UNIT_PAD_BUFFER            0
+#endif
+#define LOG_UNIT_PAD_BUFFER_SECONDS    1
+#define LOG_UNIT_PAD_HEARTBEAT_PERIOD  1000 // ms
+#define LOG_UNIT_PAD_BUFFER_SIZE       (LOG_UNIT_PAD_BUFFER_SECONDS*1000000L/DATA_SAMPLING_PERIOD)
+#define LOG_UNIT_PAD_HEARTBEAT_SAMPLES (LOG_UNIT_PAD_HEARTBEAT_PERIOD*1000L/DATA_SAMPLING_PERIOD)
+
+// Fréquence d'écriture selon l'étape du plan de vol (voir isLogSampleDue() dans le sketch).
+// Toutes les mesures sont écrites jusqu'au déploiement du principal. Ensuite, après
+// LOG_UNIT_FULL_RATE_SAMPLES mesures au début de l'étape, une seule mesure sur
+// LOG_UNIT_DRIFT_DECIMATION est écrite sous le principal et une sur LOG_UNIT_IDLE_DECIMATION au
+// sol. Les évènements sont toujours écrits.
+#ifndef LOG_UNIT_ADAPTIVE_RATE
+#define LOG_UNIT_ADAPTIVE_RATE         1
+#endif
+#define LOG_UNIT_FULL_RATE_SAMPLES     50 // 5 s
+#define LOG_UNIT_DRIFT_DECIMATION      10 // 1 Hz
+#define LOG_UNIT_IDLE_DECIMATION       50 // 0,2 Hz
+
+// Évènements du plan de vol (voir Rocket::logEvent()). Le code est écrit tel quel dans le format
+// binaire et la télémétrie; le texte n'est lu dans la mémoire flash que pour les lignes du format
+// texte. Un nouvel évènement est ajouté à la fin: les codes des historiques déjà écrits ne
+// changent pas.
+enum LogEvent {
+    LOG_EVENT_NONE,
+    LOG_EVENT_BURNOUT_STARTED,
+    LOG_EVENT_BURNOUT_FINISHED,
+    LOG_EVENT_DROGUE_OUT,
+    LOG_EVENT_DROGUE_ALREADY_OUT,
+    LOG_EVENT_MAIN_OUT,
+    LOG_EVENT_MAIN_ALREADY_OUT,
+    LOG_EVENT_FLIGHT_FINISHED,
+    LOG_EVENT_INVALID_ALTITUDE,
+    // Nouvel état de la continuité des allumettes (voir logContinuity() dans le sketch), dans
+    // l'ordre des bits CONTINUITY_DROGUE et CONTINUITY_MAIN
+    LOG_EVENT_CONTINUITY_NONE,
+    LOG_EVENT_CONTINUITY_DROGUE,
+    LOG_EVENT_CONTINUITY_MAIN,
+    LOG_EVENT_CONTINUITY_BOTH,
+    // Capteur en panne ou de nouveau sain (voir logBarometerHealth() dans le sketch), dans l'ordre
+    // des capteurs de ALTIMETER_DUAL
+    LOG_EVENT_BAROMETER_1_FAILED,
+    LOG_EVENT_BAROMETER_2_FAILED,
+    LOG_EVENT_BAROMETER_1_OK,
+    LOG_EVENT_BAROMETER_2_OK,
+    LOG_EVENT_COUNT
+};
+
+// Texte des évènements, aussi utilisé par les outils de simulation/ pour lire les historiques
 #define MESSAGE_BURNOUT_STARTED     "burnout started"
 #define MESSAGE_BURNOUT_FINISHED    "burnout finished"
 #define MESSAGE_DROGUE_OUT          "drogue out"
@@ -64,19 +220,123 @@
 #define MESSAGE_MAIN_ALREADY_OUT    "main already out"
 #define MESSAGE_FLIGHT_FINISHED     "flight finished"
 #define MESSAGE_INVALID_ALTITUDE    "invalid altitude"
+#define MESSAGE_CONTINUITY_NONE     "continuity none"
+#define MESSAGE_CONTINUITY_DROGUE   "continuity drogue"
+#define MESSAGE_CONTINUITY_MAIN     "continuity main"
+#define MESSAGE_CONTINUITY_BOTH     "continuity both"
+#define MESSAGE_BAROMETER_1_FAILED  "barometer 1 failed"
+#define MESSAGE_BAROMETER_2_FAILED  "barometer 2 failed"
+#define MESSAGE_BAROMETER_1_OK      "barometer 1 ok"
+#define MESSAGE_BAROMETER_2_OK      "barometer 2 ok"
+#define LOG_EVENT_MAX_LENGTH        18 // "drogue already out"
+
+// Ligne d'information écrite après la première mesure: boot,durée de setup() (us),temps de la
+// première mesure (us depuis le démarrage)
+#define MESSAGE_BOOT_TIME           "boot"
+
+// Ligne d'information écrite à la reprise d'un vol après un redémarrage: resume,étape reprise,MCUSR
+#define MESSAGE_RESUME              "resume"
+
+// Table des textes dans la mémoire flash, indexée par le code de l'évènement
+static const char LOG_EVENT_TEXT_NONE[] PROGMEM = "";
+static const char LOG_EVENT_TEXT_BURNOUT_STARTED[] PROGMEM = MESSAGE_BURNOUT_STARTED;
+static const char LOG_EVENT_TEXT_BURNOUT_FINISHED[] PROGMEM = MESSAGE_BURNOUT_FINISHED;
+static const char LOG_EVENT_TEXT_DROGUE_OUT[] PROGMEM = MESSAGE_DROGUE_OUT;
+static const char LOG_EVENT_TEXT_DROGUE_ALREADY_OUT[] PROGMEM = MESSAGE_DROGUE_ALREADY_OUT;
+static const char LOG_EVENT_TEXT_MAIN_OUT[] PROGMEM = MESSAGE_MAIN_OUT;
+static const char LOG_EVENT_TEXT_MAIN_ALREADY_OUT[] PROGMEM = MESSAGE_MAIN_ALREADY_OUT;
+static const char LOG_EVENT_TEXT_FLIGHT_FINISHED[] PROGMEM = MESSAGE_FLIGHT_FINISHED;
+static const char LOG_EVENT_TEXT_INVALID_ALTITUDE[] PROGMEM = MESSAGE_INVALID_ALTITUDE;
+static const char LOG_EVENT_TEXT_CONTINUITY_NONE[] PROGMEM = MESSAGE_CONTINUITY_NONE;
+static const char LOG_EVENT_TEXT_CONTINUITY_DROGUE[] PROGMEM = MESSAGE_CONTINUITY_DROGUE;
+static const char LOG_EVENT_TEXT_CONTINUITY_MAIN[] PROGMEM = MESSAGE_CONTINUITY_MAIN;
+static const char LOG_EVENT_TEXT_CONTINUITY_BOTH[] PROGMEM = MESSAGE_CONTINUITY_BOTH;
+static const char LOG_EVENT_TEXT_BAROMETER_1_FAILED[] PROGMEM = MESSAGE_BAROMETER_1_FAILED;
+static const char LOG_EVENT_TEXT_BAROMETER_2_FAILED[] PROGMEM = MESSAGE_BAROMETER_2_FAILED;
+static const char LOG_EVENT_TEXT_BAROMETER_1_OK[] PROGMEM = MESSAGE_BAROMETER_1_OK;
+static const char LOG_EVENT_TEXT_BAROMETER_2_OK[] PROGMEM = MESSAGE_BAROMETER_2_OK;
+
+static const char *const LOG_EVENT_MESSAGES[LOG_EVENT_COUNT] PROGMEM = {
+    LOG_EVENT_TEXT_NONE,
+    LOG_EVENT_TEXT_BURNOUT_STARTED,
+    LOG_EVENT_TEXT_BURNOUT_FINISHED,
+    LOG_EVENT_TEXT_DROGUE_OUT,
+    LOG_EVENT_TEXT_DROGUE_ALREADY_OUT,
+    LOG_EVENT_TEXT_MAIN_OUT,
+    LOG_EVENT_TEXT_MAIN_ALREADY_OUT,
+    LOG_EVENT_TEXT_FLIGHT_FINISHED,
+    LOG_EVENT_TEXT_INVALID_ALTITUDE,
+    LOG_EVENT_TEXT_CONTINUITY_NONE,
+    LOG_EVENT_TEXT_CONTINUITY_DROGUE,
+    LOG_EVENT_TEXT_CONTINUITY_MAIN,
+    LOG_EVENT_TEXT_CONTINUITY_BOTH,
+    LOG_EVENT_TEXT_BAROMETER_1_FAILED,
+    LOG_EVENT_TEXT_BAROMETER_2_FAILED,
+    LOG_EVENT_TEXT_BAROMETER_1_OK,
+    LOG_EVENT_TEXT_BAROMETER_2_OK
+};
+
+inline void logEventText(uint8_t event, char *text) {
+/*
+ * Copie le texte d'un évènement de la mémoire flash dans text (LOG_EVENT_MAX_LENGTH + 1 octets).
+ * Un code inconnu donne un texte vide.
+ */
+    const char *message = event < LOG_EVENT_COUNT ? (const char *)pgm_read_ptr(&LOG_EVENT_MESSAGES[event]) : LOG_EVENT_TEXT_NONE;
+    strncpy_P(text, message, LOG_EVENT_MAX_LENGTH);
+    text[LOG_EVENT_MAX_LENGTH] = '\0';
+}
 
 // Format du fichier log
 #define ID_LOG_MESSAGE    0   //chiffre qui va avoir au début de chaque ligne du header qui est un message d'information
 #define ID_LOG_DATA       1   //chiffre qui va avoir au début de chaque ligne qui est du data
 #define ID_LOG_EVENT      2   //chiffre qui va avoir au début de chaque ligne du header qui est un evenement
+#define ID_LOG_DELTA      3   //donnée relative à la précédente, format binaire seulement (voir logFormat.h)
+
+
+//-------------------------------------------------------------------------------------------------
+//  EEPROM (1024 octets sur le ATmega328P)
+
+#define EEPROM_LOG_FILE_NUMBER    0 // uint16_t - Numéro du dernier fichier d'historique (0xFFFF: EEPROM neuve)
+#define EEPROM_FLIGHT_JOURNAL     16 // Journal de l'état du vol, jusqu'à la fin de l'EEPROM (voir FLIGHT_JOURNAL)
 
 
 //-------------------------------------------------------------------------------------------------
 //  Buzzer
 
-// Paramètres du signal sonore
-#define BUZZER_TIME_BETWEEN_SEQUENCES 6000
-#define BUZZER_CYCLE_DURATION         1000
+// Paramètres du signal sonore. Les durées sont des multiples de la période du Timer1
+// (DATA_SAMPLING_PERIOD), qui fait avancer les séquences (voir buzzer.h).
+#define BUZZER_TIME_BETWEEN_SEQUENCES 6000 // ms, durée d'une séquence de continuité
+#define BUZZER_CYCLE_DURATION         1000 // ms, un bip suivi d'un silence de même durée
+
+// Séquences de continuité des allumettes (voir Rocket::verifyParachutes()): N bips, puis un
+// silence jusqu'à la fin de la séquence
+#define BUZZER_CONTINUITY_SEQUENCE(beeps) { \
+    {BUZZER_CYCLE_DURATION/2, BUZZER_CYCLE_DURATION/2, beeps}, \
+    {0, BUZZER_TIME_BETWEEN_SEQUENCES - (beeps)*BUZZER_CYCLE_DURATION, 1}, \
+    {0, 0, 0}}
+
+static const BuzzerSegment BUZZER_SEQUENCE_SILENT[] PROGMEM = {{0, 0, 0}};
+static const BuzzerSegment BUZZER_SEQUENCE_ONE_BEEP[] PROGMEM = BUZZER_CONTINUITY_SEQUENCE(1);
+static const BuzzerSegment BUZZER_SEQUENCE_TWO_BEEPS[] PROGMEM = BUZZER_CONTINUITY_SEQUENCE(2);
+static const BuzzerSegment BUZZER_SEQUENCE_THREE_BEEPS[] PROGMEM = BUZZER_CONTINUITY_SEQUENCE(3);
+static const BuzzerSegment BUZZER_SEQUENCE_FOUR_BEEPS[] PROGMEM = BUZZER_CONTINUITY_SEQUENCE(4);
+
+enum BuzzerPattern {
+    BUZZER_PATTERN_SILENT,
+    BUZZER_PATTERN_NO_PARACHUTE,    // 1 bip
+    BUZZER_PATTERN_DROGUE_ONLY,     // 2 bips
+    BUZZER_PATTERN_MAIN_ONLY,       // 3 bips
+    BUZZER_PATTERN_BOTH,            // 4 bips
+    BUZZER_PATTERN_COUNT
+};
+
+static const BuzzerSegment *const BUZZER_PATTERNS[BUZZER_PATTERN_COUNT] PROGMEM = {
+    BUZZER_SEQUENCE_SILENT,
+    BUZZER_SEQUENCE_ONE_BEEP,
+    BUZZER_SEQUENCE_TWO_BEEPS,
+    BUZZER_SEQUENCE_THREE_BEEPS,
+    BUZZER_SEQUENCE_FOUR_BEEPS
+};
 
 
 //-------------------------------------------------------------------------------------------------
@@ -86,6 +346,10 @@
 #define ID_PARACHUTE_DROGUE  0
 #define ID_PARACHUTE_MAIN    1
 
+// Continuité des allumettes (voir continuity.h): lectures consécutives identiques, une par tick
+// du Timer1, avant qu'un nouvel état soit publié
+#define CONTINUITY_DEBOUNCE_TICKS  3
+
 // Tag de l'état des parachutes
 #define TAG_PARACHUTE_BOTH        4
 #define TAG_PARACHUTE_MAIN_ONLY   3
@@ -104,25 +368,61 @@
  * 
  * L'équation aux différences est de la forme suivante:
  *    A0*y[n] = B0*x[n] + B1*x[n-1] + B2*x[n-2] + B3*x[n-3] - A1*y[n-1] - A2*y[n-2] - A3*y[n-3]
+ *
+ * Elle est calculée en virgule fixe par IirFilter (voir iirFilter.h), avec les coefficients
+ * ALTITUDE_FILTER_A et ALTITUDE_FILTER_B en Q3.28, calculés à la compilation à partir de A et B.
+ * L'ordre et ces tableaux doivent concorder: le compilateur refuse des tableaux de la mauvaise
+ * taille, et un terme doit y être ajouté ou retiré quand l'ordre change.
+ * `make compare-filter` (répertoire simulation) vérifie l'écart avec le calcul en float.
  */
 
 #define ALTITUDE_FILTER_ORDER   3
 #define ALTITUDE_ARRAY_SIZE     (ALTITUDE_FILTER_ORDER+1)
 
-const float A[ALTITUDE_ARRAY_SIZE] = {
+constexpr float A[ALTITUDE_ARRAY_SIZE] = {
     1,                    // A0
     -2.242002473393440,   // A1
     1.789446106565067,    // A2
     -0.495145905738350    // A3
 };
 
-const float B[ALTITUDE_ARRAY_SIZE] = {
+constexpr float B[ALTITUDE_ARRAY_SIZE] = {
     0.019249185590260,    // B0
     0.006899678126378,    // B1
     0.006899678126378,    // B2
     0.019249185590260     // B3
 };
 
+const int32_t ALTITUDE_FILTER_A[] PROGMEM = {
+    iirFilterCoefficient(A[0]/A[0]),
+    iirFilterCoefficient(A[1]/A[0]),
+    iirFilterCoefficient(A[2]/A[0]),
+    iirFilterCoefficient(A[3]/A[0])
+};
+
+const int32_t ALTITUDE_FILTER_B[] PROGMEM = {
+    iirFilterCoefficient(B[0]/A[0]),
+    iirFilterCoefficient(B[1]/A[0]),
+    iirFilterCoefficient(B[2]/A[0]),
+    iirFilterCoefficient(B[3]/A[0])
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//  Estimateur d'état de la fusée
+/*
+ * Avec ALTITUDE_ESTIMATOR_KALMAN à 1, la vitesse est estimée par un filtre de Kalman (voir
+ * altitudeEstimator.h) à partir de l'altitude brute au lieu d'être calculée sur l'altitude
+ * filtrée. La vitesse verticale est alors signée et l'apogée est détecté dès qu'elle devient
+ * négative. L'altitude estimée, la vitesse verticale (m/s) et l'accélération (m/s^2) sont
+ * ajoutées à chaque ligne de l'historique.
+ */
+#ifndef ALTITUDE_ESTIMATOR_KALMAN
+#define ALTITUDE_ESTIMATOR_KALMAN     0
+#endif
+#define ESTIMATOR_ALTITUDE_NOISE      0.5   // m - Écart-type du bruit du baromètre mesuré sur la rampe
+#define ESTIMATOR_JERK_NOISE          10.0  // m/s^3 - Variation d'accélération permise entre deux échantillons
+
 
 //-------------------------------------------------------------------------------------------------
 //  Paramètres de la boucle principale
@@ -130,6 +430,54 @@ const float B[ALTITUDE_ARRAY_SIZE] = {
 // Fréquence d'échantillonage
 #define DATA_SAMPLING_PERIOD    100000 // 100000 micro-secondes ou un fréquence de 10 Hz.
 
+// Nombre de ticks du Timer1 qui peuvent attendre d'être traités (puissance de 2). Au-delà, les
+// ticks sont perdus et comptés comme manqués dans le rapport du LoopProfiler.
+#ifndef TICK_QUEUE_SIZE
+#define TICK_QUEUE_SIZE         4
+#endif
+
+// Tâches de la boucle principale, par ordre de priorité (voir taskScheduler.h). La mesure
+// d'altitude et le plan de vol passent avant les entrées-sorties: une écriture lente sur la carte
+// SD ou le port série ne retarde le déploiement que de la durée d'une seule exécution de tâche.
+enum MainTask {
+    TASK_SAMPLE,        // Mise à jour de l'altitude et plan de vol, à la fin de chaque mesure
+    TASK_LOG,           // Historique et journal de l'EEPROM, après chaque mesure
+    TASK_CONTINUITY,    // Signal sonore de la continuité des allumettes
+    TASK_TELEMETRY,     // Envoi de la télémétrie binaire sur le port série
+    TASK_JOURNAL,       // Écriture d'un octet du journal dans l'EEPROM
+    TASK_COMMANDS,      // Commandes reçues sur le port série
+    TASK_COUNT
+};
+
+#define TASK_SAMPLE_DEADLINE      50000  // us, du tick du Timer1 à la fin du plan de vol (mesure: ~30 ms)
+#define TASK_LOG_DEADLINE         DATA_SAMPLING_PERIOD
+#define TASK_CONTINUITY_PERIOD    250000 // us
+#define TASK_TELEMETRY_PERIOD     2000   // us, 23 octets à 115200 bauds
+#define TASK_JOURNAL_PERIOD       4000   // us, une écriture dans l'EEPROM dure 3,4 ms
+#define TASK_COMMANDS_PERIOD      100000 // us
+
+// Caractère reçu sur le port série qui demande le rapport du LoopProfiler (voir loopProfiler.h).
+// Le rapport est aussi écrit dans l'historique à la fin du vol.
+#define LOOP_PROFILER_REPORT_COMMAND  'p'
+
+// Reprise du vol après un redémarrage du Arduino. Avec FLIGHT_JOURNAL à 1, l'état du vol (étape,
+// pression au sol, altitude maximale, historique du filtre, position dans le fichier d'historique)
+// est écrit dans un journal de l'EEPROM (voir flightJournal.h) à chaque changement d'étape et
+// toutes les FLIGHT_JOURNAL_PERIOD mesures en vol. Si le Arduino redémarre en vol (baisse de
+// tension, chien de garde, broche RESET), setup() reprend cet état sans calibrer la pression au
+// sol ni chercher un nouveau fichier. Le vol n'est repris que si la cause du redémarrage est une
+// de celles-ci (BORF, WDRF ou EXTRF) sans PORF: elle est lue dans MCUSR ou, quand le chargeur de
+// démarrage (Optiboot) l'a effacé, dans le registre r2 où il la passe au programme. Une mise sous
+// tension, ou aucune cause, ferme le vol du journal. Le vol n'est pas repris non plus si l'altitude
+// mesurée par rapport à la pression au sol du journal ne correspond pas à l'étape (voir
+// Rocket::resumeHardware()).
+#ifndef FLIGHT_JOURNAL
+#define FLIGHT_JOURNAL          1
+#endif
+#define FLIGHT_JOURNAL_PERIOD   5 // Mesures entre deux états écrits en vol (0,5 s)
+#define FLIGHT_RESUME_MIN_ALTITUDE        15.0 // m, plus bas la fusée est au sol
+#define FLIGHT_RESUME_ALTITUDE_TOLERANCE  30.0 // m, au-dessus de l'altitude maximale du journal en descente
+
 // Étapes du plan de vol
 #define FLIGHT_STEP_LAUNCHPAD   0
 #define FLIGHT_STEP_BURNOUT     1
@@ -139,16 +487,47 @@ const float B[ALTITUDE_ARRAY_SIZE] = {
 #define FLIGHT_STEP_IDLE        5
 
 //-------------------------------------------------------------------------------------------------
-// Breakpoint d'altitude (m) et de vitessse (m/ech) ou un echétantillion est 0,1 s
-#define BREAKPOINT_SPEED_TO_BURNOUT     3    // 30 m/s - Breakpoint pour passer du launchpad au burnout
-#define BREAKPOINT_SPEED_TO_PRE_DROGUE  3    // 30 m/s - Breakpoint pour passer du burnout au predrogue
-#define BREAKPOINT_SPEED_TO_IDLE        0.01  // 0,1 m/s - Breakpoint pour passer de la descent à innactif au sol
+// Breakpoint d'altitude (m) et de vitessse (m/s). La vitesse est calculée avec les temps réels des
+// mesures (voir Rocket::getSampleInterval()), pas avec la période nominale.
+#define BREAKPOINT_SPEED_TO_BURNOUT     30   // 30 m/s - Breakpoint pour passer du launchpad au burnout
+#define BREAKPOINT_SPEED_TO_PRE_DROGUE  30   // 30 m/s - Breakpoint pour passer du burnout au predrogue
+#define BREAKPOINT_SPEED_TO_IDLE        0.1  // 0,1 m/s - Breakpoint pour passer de la descent à innactif au sol
 
 #define BREAKPOINT_ALTITUDE_TO_BURNOUT  6   // 6 m - Breakpoint pour passer du launchpad au burnout
 #define BREAKPOINT_ALTITUDE_TO_DRIFT    460 // 450 m - Breakpoint pour passer de premain à descente
 
-// Breakpoint du nombre d'échantillion d'altitude entre l'apogée et le déploiement du drogue.
-#define BREAKPOINT_DELTA_TIME_APOGEE    4  // 0,4s
+// Détection de l'apogée (voir apogeeDetector.h). La fusée est en descente quand la vitesse verticale
+// passe sous -APOGEE_SPEED_HYSTERESIS; BREAKPOINT_DELTA_TIME_APOGEE est le temps (ms) en descente
+// qui confirme l'apogée et commande le drogue. La vitesse de l'estimateur de Kalman, sans retard,
+// peut passer sous zéro jusqu'à 0,5 s avant l'apogée (apogeeBenchmark): sa confirmation est plus
+// longue, sans quoi le drogue part avant l'apogée.
+#ifndef APOGEE_SPEED_HYSTERESIS
+#define APOGEE_SPEED_HYSTERESIS         1.0  // m/s
+#endif
+#ifndef BREAKPOINT_DELTA_TIME_APOGEE
+#if ALTITUDE_ESTIMATOR_KALMAN
+#define BREAKPOINT_DELTA_TIME_APOGEE    500  // 0,5 s
+#else
+#define BREAKPOINT_DELTA_TIME_APOGEE    400  // 0,4 s
+#endif
+#endif
+// Même délai en microsecondes, comparé au temps écoulé entre les mesures. La moitié d'une période
+// est retirée pour que la dernière mesure du délai ne soit pas manquée à cause de la gigue.
+#define BREAKPOINT_APOGEE_DELAY         (BREAKPOINT_DELTA_TIME_APOGEE*1000UL - DATA_SAMPLING_PERIOD/2)
+
+// Prédiction de l'apogée, optionnelle et désactivée par défaut. Avec APOGEE_PREDICTOR à 1, le
+// drogue est commandé dès que l'apogée est prédit atteint malgré le retard de la vitesse mesurée
+// (APOGEE_SPEED_LAG), sans attendre la descente confirmée. Le retard est pris sous le plus petit
+// retard mesuré par apogeeBenchmark (360 ms sur 2000 vols synthétiques sans l'estimateur). La
+// vitesse de l'estimateur de Kalman n'a presque pas de retard: la prédiction n'y sert pas.
+#ifndef APOGEE_PREDICTOR
+#define APOGEE_PREDICTOR                0
+#endif
+#if ALTITUDE_ESTIMATOR_KALMAN
+#define APOGEE_SPEED_LAG                0    // ms
+#else
+#define APOGEE_SPEED_LAG                250  // ms
+#endif
 
 // Range d'altitude prévu
 #define FLIGHT_MINIMAL_ALTITUDE         0.0 // 0 m
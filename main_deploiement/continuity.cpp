@@ -0,0 +1,82 @@
+#include "continuity.h"
+
+ContinuitySampler::ContinuitySampler() {
+    _drogueRegister = 0;
+    _mainRegister = 0;
+    _drogueMask = 0;
+    _mainMask = 0;
+    _debounceTicks = 1;
+    _candidate = 0;
+    _candidateTicks = 0;
+    _connections = 0;
+    _changes = 0;
+}
+
+void ContinuitySampler::init(byte drogueFeedbackPin, byte mainFeedbackPin, byte debounceTicks) {
+/*
+ * Configure les entrées et publie l'état lu au démarrage, sans anti-rebond: la fusée est alors
+ * immobile sur la rampe. Doit être appelée avant que le Timer1 appelle sample().
+ */
+    pinMode(drogueFeedbackPin, INPUT);
+    pinMode(mainFeedbackPin, INPUT);
+    _drogueRegister = portInputRegister(digitalPinToPort(drogueFeedbackPin));
+    _mainRegister = portInputRegister(digitalPinToPort(mainFeedbackPin));
+    _drogueMask = digitalPinToBitMask(drogueFeedbackPin);
+    _mainMask = digitalPinToBitMask(mainFeedbackPin);
+    _debounceTicks = debounceTicks > 0 ? debounceTicks : 1;
+    _candidateTicks = 0;
+    _connections = _read();
+    _candidate = _connections;
+    _changes = 0;
+}
+
+void ContinuitySampler::sample() {
+/*
+ * Appelée par l'interruption du Timer1. Un état différent de l'état publié est publié après
+ * _debounceTicks lectures consécutives identiques.
+ */
+    if(_drogueRegister == 0) {
+        return;
+    }
+    uint8_t connections = _read();
+    if(connections == _connections) {
+        _candidateTicks = 0;
+        return;
+    }
+    if(connections != _candidate) {
+        _candidate = connections;
+        _candidateTicks = 0;
+    }
+    _candidateTicks++;
+    if(_candidateTicks >= _debounceTicks) {
+        _connections = connections;
+        _changes++;
+        _candidateTicks = 0;
+    }
+}
+
+ContinuitySnapshot ContinuitySampler::getSnapshot() {
+/*
+ * Copie l'état publié, les interruptions bloquées pour que l'état et le compteur aillent
+ * ensemble.
+ */
+    ContinuitySnapshot snapshot;
+    noInterrupts();
+    snapshot.connections = _connections;
+    snapshot.changes = _changes;
+    interrupts();
+    return snapshot;
+}
+
+uint8_t ContinuitySampler::_read() {
+    uint8_t drogueInput = *_drogueRegister;
+    uint8_t mainInput = _mainRegister == _drogueRegister ? drogueInput : *_mainRegister;
+    uint8_t connections = 0;
+    if(drogueInput & _drogueMask) {
+        connections |= CONTINUITY_DROGUE;
+    }
+    if(mainInput & _mainMask) {
+        connections |= CONTINUITY_MAIN;
+    }
+    return connections;
+}
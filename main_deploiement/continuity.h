@@ -0,0 +1,52 @@
+/*
+ * Ce module lit la continuité des allumettes du drogue et du principal (voir match.h et le schéma
+ * du circuit de déploiement): l'entrée de retour d'une allumette est à High tant que l'allumette
+ * est intacte.
+ *
+ * sample() est appelée par l'interruption du Timer1. Elle lit directement le registre PINx du port
+ * de chaque entrée, une seule fois si les deux entrées sont sur le même port, au lieu de passer
+ * par digitalRead(). Un état lu doit se répéter pendant debounceTicks ticks consécutifs pour
+ * remplacer l'état publié: un faux contact pendant les vibrations du vol ne change rien.
+ *
+ * L'état publié est une photo (ContinuitySnapshot) que la boucle principale copie avec
+ * getSnapshot(): toutes les décisions d'un passage dans la boucle voient le même état des deux
+ * allumettes. Le compteur changes augmente à chaque changement de l'état publié; il indique à
+ * l'historique qu'un nouvel état est à écrire.
+ */
+
+#ifndef continuity_h
+#define continuity_h
+
+#include "Arduino.h"
+
+#define CONTINUITY_DROGUE  0x01
+#define CONTINUITY_MAIN    0x02
+
+struct ContinuitySnapshot {
+    uint8_t connections;    // CONTINUITY_DROGUE | CONTINUITY_MAIN: allumettes intactes
+    uint8_t changes;        // Nombre de changements depuis init(), modulo 256
+};
+
+class ContinuitySampler {
+    public:
+        ContinuitySampler();
+        void init(byte drogueFeedbackPin, byte mainFeedbackPin, byte debounceTicks);
+        void sample();
+        ContinuitySnapshot getSnapshot();
+
+    private:
+        volatile uint8_t *_drogueRegister;  // Registre PINx de l'entrée du drogue
+        volatile uint8_t *_mainRegister;
+        uint8_t _drogueMask;
+        uint8_t _mainMask;
+        byte _debounceTicks;
+        // État de l'anti-rebond, modifié par sample() seulement
+        uint8_t _candidate;                 // Dernier état lu différent de l'état publié
+        byte _candidateTicks;               // Lectures consécutives de _candidate
+        // État publié
+        volatile uint8_t _connections;
+        volatile uint8_t _changes;
+
+        uint8_t _read();
+};
+#endif /* continuity_h */
@@ -0,0 +1,155 @@
+/*
+ * Journal de l'état du vol dans l'EEPROM, pour reprendre le vol après un redémarrage du Arduino
+ * (voir FLIGHT_JOURNAL dans configCircuitDeploiement.h).
+ *
+ * L'EEPROM supporte environ 100 000 écritures par octet. Pour répartir l'usure, la zone du journal
+ * est divisée en cases de la taille d'un état: chaque état est écrit dans la case qui suit celle
+ * du précédent, en boucle. Une case contient un numéro de séquence, l'état et un CRC-8. Au
+ * démarrage, le dernier état est celui d'une case valide dont la case suivante est invalide ou
+ * n'a pas le numéro de séquence suivant. Une case à moitié écrite au moment d'un redémarrage a un
+ * CRC invalide: on retrouve alors l'état précédent.
+ *
+ * Une écriture dans l'EEPROM dure 3,4 ms: un état de 50 octets bloquerait la boucle pendant près
+ * de 200 ms. save() ne fait que copier l'état; update(), appelée à chaque passage dans la boucle
+ * principale, écrit un octet quand l'écriture précédente est terminée (eeprom_is_ready()). Les
+ * octets qui n'ont pas changé depuis l'écriture précédente de la case ne sont pas réécrits.
+ *
+ * T doit être une structure sans pointeur. La zone du journal doit contenir au moins deux cases
+ * et au plus 255.
+ */
+
+#ifndef flightJournal_h
+#define flightJournal_h
+
+#include "Arduino.h"
+#include <EEPROM.h>
+#include <avr/eeprom.h>
+
+template <typename T>
+class FlightJournal {
+    public:
+        FlightJournal() {
+            _start = 0;
+            _slotCount = 0;
+            _newest = 0;
+            _valid = false;
+            _writing = false;
+            _written = 0;
+        }
+
+        void begin(int start, int end) {
+        /*
+         * Cherche le dernier état écrit dans la zone de start à end (exclus).
+         */
+            _start = start;
+            _slotCount = (end - start)/sizeof(Slot) > 255 ? 255 : (end - start)/sizeof(Slot);
+            _valid = false;
+            _writing = false;
+            _newest = 0;
+            _slot.sequence = 0xFF; // La première case écrite aura la séquence 0
+            Slot slot;
+            for(uint8_t i = 0; i < _slotCount; i++) {
+                if(!_readSlot(i, slot)) {
+                    continue;
+                }
+                Slot next;
+                if(!_readSlot(_nextSlot(i), next) || next.sequence != (uint8_t)(slot.sequence + 1)) {
+                    _newest = i;
+                    _valid = true;
+                    _slot = slot;
+                    break;
+                }
+            }
+        }
+
+        bool read(T &value) {
+        /*
+         * Retourne false si le journal ne contient aucun état valide (EEPROM neuve).
+         */
+            if(!_valid) {
+                return false;
+            }
+            value = _slot.value;
+            return true;
+        }
+
+        bool save(const T &value) {
+        /*
+         * Prépare l'écriture d'un état dans la case suivante. Retourne false, sans rien changer,
+         * si l'état précédent n'est pas fini d'écrire.
+         */
+            if(_writing || _slotCount < 2) {
+                return false;
+            }
+            if(_valid) {
+                _newest = _nextSlot(_newest);
+            }
+            _slot.sequence++;
+            _slot.value = value;
+            _slot.checksum = _checksum(_slot);
+            _valid = true;
+            _writing = true;
+            _written = 0;
+            return true;
+        }
+
+        void update() {
+        /*
+         * Écrit au plus un octet qui a changé, sans attendre la fin d'une écriture en cours.
+         */
+            int address = _start + _newest*sizeof(Slot);
+            const uint8_t *bytes = (const uint8_t *)&_slot;
+            while(_writing && eeprom_is_ready()) {
+                uint8_t position = _written++;
+                _writing = _written < sizeof(Slot);
+                if(EEPROM.read(address + position) != bytes[position]) {
+                    EEPROM.write(address + position, bytes[position]);
+                    return;
+                }
+            }
+        }
+
+        bool isWriting() const {
+            return _writing;
+        }
+
+    private:
+        struct Slot {
+            uint8_t sequence;
+            T value;
+            uint8_t checksum;   // CRC-8 (Dallas/Maxim) de la séquence et de l'état
+        } __attribute__((packed));
+
+        int _start;
+        uint8_t _slotCount;
+        uint8_t _newest;        // Case du dernier état, celle qui est en écriture s'il y a lieu
+        bool _valid;
+        bool _writing;
+        uint8_t _written;       // Octets de la case déjà écrits
+        Slot _slot;             // Dernier état, avec sa séquence et son CRC
+
+        uint8_t _nextSlot(uint8_t slot) const {
+            return slot + 1 < _slotCount ? slot + 1 : 0;
+        }
+
+        bool _readSlot(uint8_t slot, Slot &value) const {
+            EEPROM.get(_start + slot*sizeof(Slot), value);
+            return value.checksum == _checksum(value);
+        }
+
+        static uint8_t _checksum(const Slot &slot) {
+            const uint8_t *bytes = (const uint8_t *)&slot;
+            uint8_t crc = 0;
+            for(uint8_t i = 0; i < sizeof(Slot) - 1; i++) {
+                crc ^= bytes[i];
+                for(uint8_t bit = 0; bit < 8; bit++) {
+                    crc = crc & 1 ? (crc >> 1) ^ 0x8C : crc >> 1;
+                }
+            }
+            return crc;
+        }
+
+        typedef char _slotFitsCounter[(sizeof(Slot) < 256) ? 1 : -1];
+};
+
+#endif
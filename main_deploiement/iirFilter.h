@@ -0,0 +1,131 @@
+/*
+ * Ce module est un filtre numérique récursif (IIR) en virgule fixe.
+ *
+ * L'AVR n'a pas d'unité de calcul en virgule flottante: chaque multiplication de float est
+ * émulée en logiciel. Ici, les échantillons sont des entiers de 32 bits en format Q15.16
+ * (1/65536 m, altitudes de -32768 à 32767 m) et les coefficients sont des entiers de 32 bits en
+ * format Q3.28. Les produits sont accumulés sur 64 bits, puis ramenés au format des échantillons
+ * avec arrondi.
+ *
+ * L'ordre du filtre est un paramètre du gabarit: les tableaux de coefficients A[] et B[] passés
+ * au constructeur doivent avoir ORDER+1 éléments, ce que le compilateur vérifie. Les coefficients
+ * sont déjà en Q3.28 et normalisés par A0: iirFilterCoefficient() les calcule à la compilation
+ * (voir ALTITUDE_FILTER_A dans configCircuitDeploiement.h). Les tableaux restent dans la mémoire
+ * flash (PROGMEM) et sont lus à chaque échantillon; le filtre ne garde que leur adresse.
+ *
+ * Chaque produit est celui de deux entiers de 32 bits étendus à 64 bits: avr-gcc peut le calculer
+ * avec la multiplication élargie de sa librairie (__mulsidi3) plutôt qu'une multiplication
+ * complète de 64 bits.
+ *
+ * Les historiques d'entrées et de sorties sont des tampons circulaires: un nouvel échantillon
+ * remplace le plus ancien au lieu de décaler les tableaux. getInput(0) et getOutput(0) sont les
+ * valeurs présentes, getInput(ORDER) et getOutput(ORDER) les plus anciennes.
+ *
+ * L'équation aux différences est la même que celle de configCircuitDeploiement.h:
+ *    A0*y[n] = B0*x[n] + ... + BN*x[n-N] - A1*y[n-1] - ... - AN*y[n-N]
+ */
+
+#ifndef iirFilter_h
+#define iirFilter_h
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#define IIR_FILTER_SAMPLE_BITS       16   // Bits fractionnaires des échantillons (Q15.16)
+#define IIR_FILTER_COEFFICIENT_BITS  28   // Bits fractionnaires des coefficients (Q3.28)
+
+constexpr int32_t iirFilterCoefficient(float value) {
+/*
+ * Coefficient en Q3.28, arrondi. Évaluée à la compilation pour les tableaux en mémoire flash.
+ */
+    return (int32_t)(value*(float)((int32_t)1 << IIR_FILTER_COEFFICIENT_BITS) + (value < 0 ? -0.5f : 0.5f));
+}
+
+template <uint8_t ORDER>
+class IirFilter {
+    public:
+        IirFilter(const int32_t (&a)[ORDER+1], const int32_t (&b)[ORDER+1]) {
+        /*
+         * a, b: coefficients en Q3.28 normalisés par A0, dans la mémoire flash (PROGMEM).
+         */
+            _a = a;
+            _b = b;
+            reset();
+        }
+
+        void reset() {
+            for(uint8_t i = 0; i <= ORDER; i++) {
+                _input[i] = 0;
+                _output[i] = 0;
+            }
+            _head = 0;
+        }
+
+        int32_t filter(int32_t input) {
+        /*
+         * Ajoute un échantillon (Q15.16) et retourne la nouvelle sortie du filtre (Q15.16).
+         */
+            _head = _head == 0 ? ORDER : _head - 1;
+            _input[_head] = input;
+
+            int64_t accumulator = (int64_t)_coefficient(_b, 0)*input;
+            uint8_t index = _head;
+            for(uint8_t i = 1; i <= ORDER; i++) {
+                index = index == ORDER ? 0 : index + 1;
+                accumulator += (int64_t)_coefficient(_b, i)*_input[index] - (int64_t)_coefficient(_a, i)*_output[index];
+            }
+            _output[_head] = (int32_t)((accumulator + ((int64_t)1 << (IIR_FILTER_COEFFICIENT_BITS - 1))) >> IIR_FILTER_COEFFICIENT_BITS);
+            return _output[_head];
+        }
+
+        void restore(const int32_t (&input)[ORDER+1], const int32_t (&output)[ORDER+1]) {
+        /*
+         * Remet l'historique lu avec getInput() et getOutput(), l'indice 0 étant la valeur présente
+         * (reprise d'un vol après un redémarrage, voir Rocket::resumeHardware()).
+         */
+            for(uint8_t i = 0; i <= ORDER; i++) {
+                _input[i] = input[i];
+                _output[i] = output[i];
+            }
+            _head = 0;
+        }
+
+        float filter(float input) {
+            return toFloat(filter(fromFloat(input)));
+        }
+
+        int32_t getInput(uint8_t index) const {
+            return _input[_position(index)];
+        }
+
+        int32_t getOutput(uint8_t index) const {
+            return _output[_position(index)];
+        }
+
+        static int32_t fromFloat(float value) {
+            value *= (float)((int32_t)1 << IIR_FILTER_SAMPLE_BITS);
+            return (int32_t)(value < 0 ? value - 0.5f : value + 0.5f);
+        }
+
+        static float toFloat(int32_t value) {
+            return value*(1.0f/((int32_t)1 << IIR_FILTER_SAMPLE_BITS));
+        }
+
+    private:
+        const int32_t *_a;      // Mémoire flash
+        const int32_t *_b;
+        int32_t _input[ORDER+1];
+        int32_t _output[ORDER+1];
+        uint8_t _head;
+
+        uint8_t _position(uint8_t index) const {
+            uint8_t position = _head + index;
+            return position > ORDER ? position - (ORDER+1) : position;
+        }
+
+        static int32_t _coefficient(const int32_t *coefficients, uint8_t index) {
+            return (int32_t)pgm_read_dword(&coefficients[index]);
+        }
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Format binaire de l'historique de vol (LOG_UNIT_BINARY à 1 dans configCircuitDeploiement.h).
+ *
+ * Le fichier commence par un entête de 16 octets suivi d'enregistrements complets de 16 octets
+ * (32 avec LogEstimate) et, depuis la version 2, d'enregistrements delta de taille variable.
+ * Les valeurs sont écrites en petit-boutiste (little-endian), comme sur l'AVR et le PC.
+ *
+ * Version 2: une donnée est écrite comme l'octet ID_LOG_DELTA suivi des différences avec
+ * l'enregistrement complet ou delta précédent, en varints (7 bits par octet, le bit 7 indique
+ * qu'un octet suit):
+ *     temps (ms, non signé), altitude brute, altitude filtrée, vitesse
+ *     [altitude estimée, vitesse verticale, accélération, si recordSize inclut LogEstimate]
+ * Les différences signées sont codées en zigzag (0, -1, 1, -2... donnent 0, 1, 2, 3...). À 10 Hz,
+ * une donnée prend ainsi 5 à 8 octets au lieu de 16. Toutes les LOG_UNIT_KEYFRAME_PERIOD données,
+ * la donnée est écrite au complet, avec event à LOG_FORMAT_KEYFRAME: c'est un point de reprise où
+ * le décodeur peut se resynchroniser si une partie du fichier est perdue. Les évènements et les
+ * messages sont toujours complets.
+ *
+ * Version 3: les vitesses sont en cm/s au lieu de cm par échantillon (voir
+ * Rocket::getSampleInterval()). Un int16_t va jusqu'à 327 m/s.
+ *
+ * Ce fichier ne dépend pas de la librairie Arduino pour pouvoir être inclus par le décodeur
+ * de l'ordinateur hôte (simulation/logDecoder.cpp).
+ */
+
+#ifndef logFormat_h
+#define logFormat_h
+
+#include <stdint.h>
+
+#define LOG_FORMAT_MAGIC_0    'G'
+#define LOG_FORMAT_MAGIC_1    'A'
+#define LOG_FORMAT_MAGIC_2    'U'
+#define LOG_FORMAT_MAGIC_3    'L'
+#define LOG_FORMAT_VERSION    3
+#define LOG_FORMAT_KEYFRAME   0xA5 // Champ event d'une donnée complète (point de reprise)
+#define LOG_FORMAT_FILL       0xFF // Remplissage de la fin d'un fichier préalloué
+#define LOG_FORMAT_MAX_DELTA_SIZE  (1 + 7*5) // Identifiant et 7 varints de 32 bits
+
+struct LogFileHeader {
+    char magic[4];              // "GAUL"
+    uint8_t version;            // LOG_FORMAT_VERSION
+    uint8_t recordSize;         // LOG_RECORD_SIZE: sizeof(LogRecord), 32 avec LogEstimate
+    uint16_t samplingPeriod;    // ms
+    uint8_t reserved[8];
+} __attribute__((packed));
+
+// Un enregistrement ID_LOG_MESSAGE (ligne d'information, voir Rocket::logMessage()) est suivi de
+// event blocs de recordSize octets qui contiennent le texte, complété par des zéros.
+struct LogRecord {
+    uint8_t id;                 // ID_LOG_DATA, ID_LOG_EVENT ou ID_LOG_MESSAGE
+    uint8_t event;              // Code de l'évènement, 0 ou LOG_FORMAT_KEYFRAME pour une donnée, nombre de blocs de texte d'un message
+    int16_t speed;              // cm/s
+    uint32_t timeStamp;         // ms
+    int32_t rawAltitude;        // cm
+    int32_t filteredAltitude;   // cm
+} __attribute__((packed));
+
+// Avec ALTITUDE_ESTIMATOR_KALMAN à 1, chaque LogRecord est suivi des estimations de l'état de la
+// fusée et l'entête indique recordSize = sizeof(LogRecord) + sizeof(LogEstimate) (32 octets).
+struct LogEstimate {
+    int32_t altitude;           // cm
+    int16_t verticalSpeed;      // cm/s
+    int16_t acceleration;       // cm/s^2
+    uint8_t reserved[8];
+} __attribute__((packed));
+
+inline int32_t logFormatCentimeters(float meters) {
+    return (int32_t)(meters < 0 ? meters*100.0f - 0.5f : meters*100.0f + 0.5f);
+}
+
+inline int16_t logFormatSpeed(float speed) {
+    int32_t centimeters = logFormatCentimeters(speed);
+    if(centimeters > 32767) {
+        return 32767;
+    }
+    if(centimeters < -32768) {
+        return -32768;
+    }
+    return (int16_t)centimeters;
+}
+
+inline uint8_t logFormatPutUnsigned(uint8_t *buffer, uint32_t value) {
+    uint8_t length = 0;
+    while(value >= 0x80) {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+    return length;
+}
+
+inline uint8_t logFormatPutSigned(uint8_t *buffer, int32_t value) {
+    return logFormatPutUnsigned(buffer, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+#endif
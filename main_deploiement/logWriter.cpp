@@ -0,0 +1,60 @@
+#include "logWriter.h"
+#include "configCircuitDeploiement.h"
+
+LogWriter::LogWriter() {
+    _file = 0;
+    _position = 0;
+    _sectorsSinceCommit = 0;
+}
+
+void LogWriter::begin(File *file) {
+/*
+ * L'écriture commence à la position courante du fichier.
+ */
+    _file = file;
+    _position = _file->position();
+    _sectorsSinceCommit = 0;
+}
+
+size_t LogWriter::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t LogWriter::write(const uint8_t *buffer, size_t size) {
+/*
+ * Les données vont dans la cache de la librairie SD. Le répertoire est mis à jour quand
+ * LOG_UNIT_SECTORS_PER_COMMIT secteurs ont été remplis depuis le dernier commit().
+ */
+    if(!_file) {
+        return 0;
+    }
+    size_t written = _file->write(buffer, size);
+    unsigned long sectors = (_position + written)/LOG_UNIT_SECTOR_SIZE - _position/LOG_UNIT_SECTOR_SIZE;
+    _position += written;
+    if(sectors > 0) {
+        _sectorsSinceCommit += sectors;
+        if(_sectorsSinceCommit >= LOG_UNIT_SECTORS_PER_COMMIT) {
+            _file->flush();
+            _sectorsSinceCommit = 0;
+        }
+    }
+    return written;
+}
+
+void LogWriter::commit() {
+/*
+ * Écrit le secteur courant de la cache sur la carte et met à jour le répertoire.
+ */
+    if(!_file) {
+        return;
+    }
+    _file->flush();
+    _sectorsSinceCommit = 0;
+}
+
+unsigned long LogWriter::position() {
+/*
+ * Position dans le fichier de la fin des données écrites, sur la carte ou dans la cache.
+ */
+    return _position;
+}
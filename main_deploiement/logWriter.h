@@ -0,0 +1,42 @@
+/*
+ * Ce module écrit les lignes de l'historique de vol sur la carte SD sans flush à chaque ligne.
+ *
+ * La librairie SD garde le secteur courant du fichier dans sa cache de 512 octets et ne l'écrit
+ * sur la carte que lorsque l'écriture passe au secteur suivant. Le flush de chaque ligne écrivait
+ * le secteur partiel, puis le bloc du répertoire, qui chassait le secteur de la cache: la ligne
+ * suivante devait le relire (lecture-modification-écriture). Sans flush, les lignes s'accumulent
+ * dans la cache de la librairie. Le tampon de 512 octets aligné sur les secteurs, gardé en RAM par
+ * la première version de ce module (LogBuffer), a été retiré pour économiser la RAM du Arduino
+ * Nano: il ne faisait que doubler la cache de la librairie. Dans un fichier préalloué, la librairie
+ * lit chaque nouveau secteur avant d'y écrire (environ une fois par seconde à pleine vitesse).
+ *
+ * Le répertoire de la carte (taille du fichier) est mis à jour:
+ *    - après LOG_UNIT_SECTORS_PER_COMMIT secteurs pleins;
+ *    - à chaque appel de commit() (par exemple, à chaque évènement du vol).
+ * En cas de perte d'alimentation, on perd donc au plus le secteur courant et les
+ * LOG_UNIT_SECTORS_PER_COMMIT derniers secteurs, soit (LOG_UNIT_SECTORS_PER_COMMIT+1)*512 octets.
+ */
+
+#ifndef logWriter_h
+#define logWriter_h
+
+#include "Arduino.h"
+#include "SD.h"
+
+#define LOG_UNIT_SECTOR_SIZE  512
+
+class LogWriter : public Print {
+    public:
+        LogWriter();
+        void begin(File *file);
+        size_t write(uint8_t value);
+        size_t write(const uint8_t *buffer, size_t size);
+        void commit();
+        unsigned long position();
+
+    private:
+        File *_file;
+        unsigned long _position;
+        byte _sectorsSinceCommit;
+};
+#endif
@@ -0,0 +1,99 @@
+#include "loopProfiler.h"
+
+namespace {
+    // Noms des étapes dans la mémoire flash
+    const char STAGE_NAME_UPDATE_ALTITUDE[] PROGMEM = "updateAltitude";
+    const char STAGE_NAME_LOG_DATA[] PROGMEM = "logData";
+    const char STAGE_NAME_FOLLOW_FLIGHT_PLAN[] PROGMEM = "followFlightPlan";
+    const char STAGE_NAME_VERIFY_PARACHUTES[] PROGMEM = "verifyParachutes";
+
+    const char *const STAGE_NAMES[PROFILER_STAGE_COUNT] PROGMEM = {
+        STAGE_NAME_UPDATE_ALTITUDE,
+        STAGE_NAME_LOG_DATA,
+        STAGE_NAME_FOLLOW_FLIGHT_PLAN,
+        STAGE_NAME_VERIFY_PARACHUTES
+    };
+}
+
+LoopProfiler::LoopProfiler() {
+    init(100000);
+}
+
+void LoopProfiler::init(unsigned long samplingPeriod) {
+/*
+ * Remet les compteurs à zéro. Les classes de l'histogramme de latence divisent la période
+ * d'échantillonnage (us) en parts égales.
+ */
+    _binWidth = samplingPeriod/LOOP_PROFILER_HISTOGRAM_BINS;
+    for(byte i = 0; i < PROFILER_STAGE_COUNT; i++) {
+        _stageCount[i] = 0;
+        _stageTotal[i] = 0;
+        _stageWorst[i] = 0;
+    }
+    for(byte i = 0; i < LOOP_PROFILER_HISTOGRAM_BINS; i++) {
+        _latencyHistogram[i] = 0;
+    }
+    _missedTicks = 0;
+}
+
+void LoopProfiler::sampleDone(unsigned long tickTime) {
+/*
+ * Appelée par la boucle principale quand l'échantillon est traité (valide ou non).
+ */
+    unsigned long bin = (micros() - tickTime)/_binWidth;
+    if(bin >= LOOP_PROFILER_HISTOGRAM_BINS) {
+        bin = LOOP_PROFILER_HISTOGRAM_BINS - 1;
+    }
+    _latencyHistogram[bin]++;
+}
+
+void LoopProfiler::setMissedTicks(unsigned long missedTicks) {
+    _missedTicks = missedTicks;
+}
+
+void LoopProfiler::addStageDuration(byte stage, unsigned long duration) {
+    _stageCount[stage]++;
+    _stageTotal[stage] += duration;
+    if(duration > _stageWorst[stage]) {
+        _stageWorst[stage] = duration;
+    }
+}
+
+unsigned long LoopProfiler::getMissedTicks() {
+    return _missedTicks;
+}
+
+byte LoopProfiler::getReportLineCount() {
+    return PROFILER_STAGE_COUNT + 2;
+}
+
+String LoopProfiler::getReportLine(byte index) {
+/*
+ * Une ligne du rapport (voir loopProfiler.h): les étapes, puis les ticks manqués, puis
+ * l'histogramme de latence.
+ */
+    String line = F("profiler,");
+    if(index < PROFILER_STAGE_COUNT) {
+        line += F("stage,");
+        line += (const __FlashStringHelper *)pgm_read_ptr(&STAGE_NAMES[index]);
+        line += ',';
+        line += String(_stageCount[index]);
+        line += ',';
+        line += String(_stageCount[index] > 0 ? _stageTotal[index]/_stageCount[index] : 0UL);
+        line += ',';
+        line += String(_stageWorst[index]);
+    }
+    else if(index == PROFILER_STAGE_COUNT) {
+        line += F("missedTicks,");
+        line += String(getMissedTicks());
+    }
+    else {
+        line += F("latency,");
+        line += String(_binWidth);
+        for(byte i = 0; i < LOOP_PROFILER_HISTOGRAM_BINS; i++) {
+            line += ',';
+            line += String(_latencyHistogram[i]);
+        }
+    }
+    return line;
+}
@@ -0,0 +1,54 @@
+/*
+ * Ce module mesure le temps d'exécution de la boucle principale.
+ *
+ * Pour chaque étape du traitement d'un échantillon (mise à jour de l'altitude, écriture de
+ * l'historique, plan de vol, vérification des parachutes), il garde le nombre d'exécutions, la
+ * durée totale et la pire durée. Une étape peut en contenir une autre: le plan de vol inclut la
+ * vérification des parachutes.
+ *
+ * sampleDone() est appelée quand un échantillon a été traité, avec le temps du tick du Timer1 qui
+ * l'a demandé. Le temps entre les deux est la latence de l'échantillon; elle est comptée dans un
+ * histogramme de LOOP_PROFILER_HISTOGRAM_BINS classes qui couvrent une période d'échantillonnage,
+ * la dernière classe recevant aussi les latences plus longues. Les ticks manqués (file des ticks
+ * pleine, voir spscQueue.h) sont donnés par setMissedTicks() avant de produire le rapport.
+ *
+ * Le rapport est une suite de lignes de texte (getReportLine()), écrites dans l'historique par
+ * Rocket::logMessage():
+ *     profiler,stage,<étape>,<nombre>,<durée moyenne us>,<pire durée us>
+ *     profiler,missedTicks,<nombre>
+ *     profiler,latency,<largeur d'une classe us>,<classe 0>,...,<classe N-1>
+ */
+
+#ifndef loopProfiler_h
+#define loopProfiler_h
+
+#include "Arduino.h"
+
+#define PROFILER_STAGE_UPDATE_ALTITUDE    0
+#define PROFILER_STAGE_LOG_DATA           1
+#define PROFILER_STAGE_FLIGHT_PLAN        2
+#define PROFILER_STAGE_VERIFY_PARACHUTES  3
+#define PROFILER_STAGE_COUNT              4
+
+#define LOOP_PROFILER_HISTOGRAM_BINS      16
+
+class LoopProfiler {
+    public:
+        LoopProfiler();
+        void init(unsigned long samplingPeriod);
+        void sampleDone(unsigned long tickTime);
+        void setMissedTicks(unsigned long missedTicks);
+        void addStageDuration(byte stage, unsigned long duration);
+        unsigned long getMissedTicks();
+        byte getReportLineCount();
+        String getReportLine(byte index);
+
+    private:
+        unsigned long _binWidth;
+        unsigned long _stageCount[PROFILER_STAGE_COUNT];
+        unsigned long _stageTotal[PROFILER_STAGE_COUNT];
+        unsigned long _stageWorst[PROFILER_STAGE_COUNT];
+        unsigned long _latencyHistogram[LOOP_PROFILER_HISTOGRAM_BINS];
+        unsigned long _missedTicks;
+};
+#endif
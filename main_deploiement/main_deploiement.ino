@@ -12,103 +12,450 @@ certain seuil. De plus, un buzzer signal lorsqu'il y a un continuité dans les a
 #include "rocket.h"
 
 Rocket rocket;
+LoopProfiler loopProfiler;
+MemoryMonitor memoryMonitor;
+TaskScheduler<TASK_COUNT> scheduler;
+ApogeeDetector apogeeDetector;
+SpscQueue<unsigned long, TICK_QUEUE_SIZE> tickQueue; // Temps (us) des ticks du Timer1 pas encore traités
+#if FLIGHT_JOURNAL
+FlightJournal<FlightState> flightJournal;
+#endif
 
-bool altitudeUpToDate;
+bool samplePending;
+unsigned long sampleTickTime;
 byte flightPlanStep;
-byte apogeeTimeCounter;
+byte loggedFlightPlanStep;     // Étape du plan de vol des mesures comptées par stepSampleCount
+byte stepSampleCount;          // Mesures écrites à pleine vitesse depuis le début de l'étape
+byte samplesSinceLog;          // Mesures sautées depuis la dernière mesure écrite
+unsigned long setupDuration;   // us, du démarrage à la fin de setup()
+bool bootTimeLogged;
+bool profilerReportRequested;  // Rapport demandé par le plan de vol, écrit par la tâche TASK_COMMANDS
+byte journaledFlightPlanStep;  // Étape du dernier état écrit dans le journal de l'EEPROM
+byte samplesSinceJournal;
+bool continuityLogged;
+uint8_t loggedContinuityChanges; // Changements de la continuité déjà écrits dans l'historique
+#if ALTIMETER_DUAL
+uint8_t loggedBarometerChanges[BAROMETER_FUSION_SENSORS]; // Changements de santé déjà écrits
+#endif
+
+#if defined(__AVR__)
+// Cause du redémarrage qu'Optiboot passe dans r2 après avoir effacé MCUSR (voir resumeFlight()).
+// Dans .noinit, le code de démarrage ne la remet pas à zéro. Sur l'ordinateur hôte, elle est
+// simulée par sim::reboot().
+uint8_t bootloaderResetFlags __attribute__((section(".noinit")));
+
+void saveBootloaderResetFlags() __attribute__((naked, used, section(".init0")));
+
+void saveBootloaderResetFlags() {
+// Exécutée en premier par le code de démarrage, avant que r2 serve à autre chose.
+    __asm__ __volatile__("sts %0, r2\n" : "=m" (bootloaderResetFlags) :);
+}
+#endif
 
 
 void setup() {
-    // TODO: Implémenter un gestion en cas de reset du Arduino Nano pendant le vol
-    altitudeUpToDate = false;
+    samplePending = false;
+    sampleTickTime = 0;
+    tickQueue.reset();
     flightPlanStep = FLIGHT_STEP_LAUNCHPAD;
-    apogeeTimeCounter = 0;
+    apogeeDetector.init(BREAKPOINT_APOGEE_DELAY, APOGEE_SPEED_HYSTERESIS, APOGEE_PREDICTOR ? APOGEE_SPEED_LAG*1000UL : 0);
+    loggedFlightPlanStep = FLIGHT_STEP_LAUNCHPAD;
+    stepSampleCount = 0;
+    samplesSinceLog = 0;
+    journaledFlightPlanStep = FLIGHT_STEP_LAUNCHPAD;
+    samplesSinceJournal = 0;
+    continuityLogged = false;
+    loggedContinuityChanges = 0;
+#if ALTIMETER_DUAL
+    for(byte i = 0; i < BAROMETER_FUSION_SENSORS; i++) {
+        loggedBarometerChanges[i] = 0;
+    }
+#endif
     
-    rocket.initHardware();
+    bool resumed = resumeFlight();
+    if(!resumed) {
+        rocket.initHardware();
+        rocket.startPadBuffer(); // Seules les dernières secondes de la rampe sont écrites en entier
+    }
+    loopProfiler.init(DATA_SAMPLING_PERIOD);
+    // Tâches de la boucle, dans l'ordre de TASK_SAMPLE à TASK_COMMANDS: la table reste dans la
+    // mémoire flash (voir TaskScheduler)
+    static const char sampleName[] PROGMEM = "sample";
+    static const char logName[] PROGMEM = "log";
+    static const char continuityName[] PROGMEM = "continuity";
+    static const char telemetryName[] PROGMEM = "telemetry";
+    static const char journalName[] PROGMEM = "journal";
+    static const char commandsName[] PROGMEM = "commands";
+    static const TaskDefinition tasks[TASK_COUNT] PROGMEM = {
+        {sampleName, processSample, 0, TASK_SAMPLE_DEADLINE},
+        {logName, writeLog, 0, TASK_LOG_DEADLINE},
+        {continuityName, checkContinuity, TASK_CONTINUITY_PERIOD, TASK_CONTINUITY_PERIOD},
+        {telemetryName, updateTelemetry, TASK_TELEMETRY_PERIOD, TASK_TELEMETRY_PERIOD},
+        {journalName, updateJournal, TASK_JOURNAL_PERIOD, TASK_JOURNAL_PERIOD},
+        {commandsName, readCommands, TASK_COMMANDS_PERIOD, TASK_COMMANDS_PERIOD}
+    };
+    scheduler.setTasks(tasks);
+    if(resumed) {
+        // En vol, la première mesure n'attend pas le Timer1. Le tick est mis dans la file avant
+        // d'activer l'interruption, seule à y écrire ensuite (voir spscQueue.h).
+        tickQueue.push(micros());
+    }
     Timer1.initialize(DATA_SAMPLING_PERIOD);
     Timer1.attachInterrupt(requireAltitudeUpdate);
+    bootTimeLogged = false;
+    profilerReportRequested = false;
+    setupDuration = micros();
+    scheduler.start(setupDuration);
 }
 
 void loop() {
-    if(altitudeUpToDate == false) {
-        bool validAltitude;        
-        altitudeUpToDate = true;      
-        validAltitude = rocket.updateAltitude();
-        if(validAltitude) {
+    // Chaque tick du Timer1 donne une mesure, même si la boucle a pris du retard (écriture sur
+    // la carte SD): les ticks en attente sont traités l'un après l'autre. La mesure terminée rend
+    // la tâche de l'échantillon prête; son échéance part du tick.
+    if(samplePending == false && tickQueue.pop(sampleTickTime)) {
+        samplePending = true;
+        rocket.requestAltitude();
+    }
+    if(rocket.altitudeAvailable()) {
+        scheduler.signal(TASK_SAMPLE, sampleTickTime);
+    }
+    scheduler.run();
+}
+
+void requireAltitudeUpdate() { 
+// Fonction appellée par le timer interrupt. Ajoute le temps du tick à la file des mesures à faire,
+// lit la continuité des allumettes et fait avancer la séquence du buzzer.
+  tickQueue.push(micros());
+  rocket.sampleContinuity();
+  rocket.updateBuzzer();
+}
+
+void processSample() {
+// Tâche TASK_SAMPLE: met à jour l'altitude avec la mesure terminée et suit le plan de vol. Avec
+// ALTIMETER_DUAL, une mesure perdue est comptée dans la santé des baromètres (voir
+// barometerFusion.h) et seuls leurs changements d'état sont écrits, par logBarometerHealth().
+// L'échantillon et les évènements ne sont que mis dans la file de l'historique, écrite ensuite par
+// la tâche TASK_LOG: cette tâche n'accède jamais à la carte SD.
+    bool validAltitude;
+    unsigned long stageStart;
+
+    stageStart = micros();
+    validAltitude = rocket.updateAltitude();
+    loopProfiler.addStageDuration(PROFILER_STAGE_UPDATE_ALTITUDE, micros() - stageStart);
+#if ALTIMETER_DUAL
+    logBarometerHealth();
+#endif
+    if(validAltitude) {
+        if(isLogSampleDue()) {
             rocket.logData();
-            followFlightPlan();
         }
-        else {
-            rocket.logEvent(MESSAGE_INVALID_ALTITUDE);
+
+        stageStart = micros();
+        followFlightPlan();
+        loopProfiler.addStageDuration(PROFILER_STAGE_FLIGHT_PLAN, micros() - stageStart);
+    }
+#if !ALTIMETER_DUAL
+    else {
+        rocket.logEvent(LOG_EVENT_INVALID_ALTITUDE);
+    }
+#endif
+    samplePending = false;
+    loopProfiler.sampleDone(sampleTickTime);
+    scheduler.signal(TASK_LOG, micros());
+}
+
+void writeLog() {
+// Tâche TASK_LOG: écrit une entrée en attente (donnée, évènement ou échantillon du tampon de la
+// rampe) par exécution, pour rendre la main au plan de vol entre deux écritures. Quand il n'en
+// reste plus, écrit les changements de continuité, l'état du vol dans le journal de l'EEPROM et
+// la durée du démarrage, puis, sur la rampe, préalloue un bloc du fichier d'historique (voir
+// Rocket::preallocateLog()).
+    unsigned long stageStart = micros();
+    bool moreSamples = rocket.writeLogSample();
+    loopProfiler.addStageDuration(PROFILER_STAGE_LOG_DATA, micros() - stageStart);
+    if(moreSamples) {
+        scheduler.signal(TASK_LOG, micros());
+        return;
+    }
+    logContinuity();
+    journalFlightState();
+    if(!bootTimeLogged) {
+        logBootTime();
+    }
+    if(flightPlanStep == FLIGHT_STEP_LAUNCHPAD) {
+        rocket.preallocateLog();
+    }
+}
+
+void checkContinuity() {
+// Tâche TASK_CONTINUITY: sur la rampe et au sol, joue le signal sonore de la continuité des
+// allumettes. En vol, le plan de vol vérifie les allumettes lui-même avant chaque déploiement.
+    if(flightPlanStep == FLIGHT_STEP_LAUNCHPAD || flightPlanStep == FLIGHT_STEP_IDLE) {
+        verifyParachutes();
+    }
+}
+
+void updateTelemetry() {
+// Tâche TASK_TELEMETRY
+    rocket.updateTelemetry();
+}
+
+void updateJournal() {
+// Tâche TASK_JOURNAL: écrit un octet du journal de l'état du vol dans l'EEPROM.
+#if FLIGHT_JOURNAL
+    flightJournal.update();
+#endif
+}
+
+void readCommands() {
+// Tâche TASK_COMMANDS: écrit le rapport du LoopProfiler demandé sur le port série ou à la fin du
+// vol. Le rapport attend le port série et la carte SD: une demande reçue en vol est ignorée.
+    if(Serial.available() > 0 && Serial.read() == LOOP_PROFILER_REPORT_COMMAND && !isInFlight()) {
+        profilerReportRequested = true;
+    }
+    if(profilerReportRequested) {
+        logProfilerReport();
+        profilerReportRequested = false;
+    }
+}
+
+bool isInFlight() {
+// Indique si la fusée est en vol: ni sur la rampe, ni au sol après le vol.
+    return flightPlanStep != FLIGHT_STEP_LAUNCHPAD && flightPlanStep != FLIGHT_STEP_IDLE;
+}
+
+bool isLogSampleDue() {
+// Indique si la mesure doit être écrite dans l'historique, selon l'étape du plan de vol (voir
+// LOG_UNIT_ADAPTIVE_RATE). Les LOG_UNIT_FULL_RATE_SAMPLES premières mesures d'une étape sont
+// toujours écrites, par exemple l'ouverture du principal au début de la descente.
+#if LOG_UNIT_ADAPTIVE_RATE
+    byte decimation;
+    switch(flightPlanStep) {
+        case FLIGHT_STEP_DRIFT:
+            decimation = LOG_UNIT_DRIFT_DECIMATION;
+            break;
+
+        case FLIGHT_STEP_IDLE:
+            decimation = LOG_UNIT_IDLE_DECIMATION;
+            break;
+
+        default:
+            decimation = 1;
+            break;
+    }
+    if(flightPlanStep != loggedFlightPlanStep) {
+        loggedFlightPlanStep = flightPlanStep;
+        stepSampleCount = 0;
+    }
+    if(stepSampleCount < LOG_UNIT_FULL_RATE_SAMPLES) {
+        stepSampleCount++;
+        samplesSinceLog = 0;
+        return true;
+    }
+    samplesSinceLog++;
+    if(samplesSinceLog < decimation) {
+        return false;
+    }
+    samplesSinceLog = 0;
+#endif
+    return true;
+}
+
+bool resumeFlight() {
+// Reprend le vol du journal de l'EEPROM si le Arduino a redémarré en vol (voir FLIGHT_JOURNAL):
+// étape du plan de vol, pression au sol, historique du filtre et fichier d'historique. Le vol n'est
+// repris qu'après une baisse de tension, le chien de garde ou la broche RESET, lus dans MCUSR ou,
+// si Optiboot l'a effacé, dans r2 (bootloaderResetFlags): une mise sous tension ou aucune cause
+// ferme le vol resté ouvert dans le journal (étape FLIGHT_STEP_IDLE), tout comme une altitude qui
+// ne correspond pas à l'état du journal.
+#if FLIGHT_JOURNAL
+    byte resetFlags = MCUSR;
+    MCUSR = 0;
+    if(resetFlags == 0) {
+        resetFlags = bootloaderResetFlags;
+    }
+    FlightState state;
+    flightJournal.begin(EEPROM_FLIGHT_JOURNAL, EEPROM.length());
+    if(!flightJournal.read(state) || state.flightPlanStep == FLIGHT_STEP_LAUNCHPAD ||
+       state.flightPlanStep >= FLIGHT_STEP_IDLE) {
+        return false;
+    }
+    bool inFlightReset = (resetFlags & (_BV(BORF) | _BV(WDRF) | _BV(EXTRF))) && !(resetFlags & _BV(PORF));
+    if(!inFlightReset || !rocket.resumeHardware(state)) {
+        state.flightPlanStep = FLIGHT_STEP_IDLE;
+        flightJournal.save(state); // Écrit par loop(), sans retarder le démarrage
+        return false;
+    }
+    flightPlanStep = state.flightPlanStep;
+    apogeeDetector.resume(state.apogeeDescentTime);
+    journaledFlightPlanStep = flightPlanStep;
+
+    String message = F(MESSAGE_RESUME);
+    message += ',';
+    message += String(flightPlanStep);
+    message += ',';
+    message += String(resetFlags);
+    rocket.logMessage(message, false);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void journalFlightState() {
+// Écrit l'état du vol dans le journal de l'EEPROM à chaque changement d'étape et toutes les
+// FLIGHT_JOURNAL_PERIOD mesures en vol. Le journal écrit un octet par passage dans loop(): un
+// nouvel état attend que le précédent soit fini d'écrire.
+#if FLIGHT_JOURNAL
+    if(samplesSinceJournal < FLIGHT_JOURNAL_PERIOD) {
+        samplesSinceJournal++;
+    }
+    if(flightPlanStep == journaledFlightPlanStep && !(isInFlight() && samplesSinceJournal >= FLIGHT_JOURNAL_PERIOD)) {
+        return;
+    }
+    if(flightJournal.isWriting()) {
+        return;
+    }
+    FlightState state;
+    rocket.getFlightState(state);
+    state.flightPlanStep = flightPlanStep;
+    state.apogeeDescentTime = apogeeDetector.getDescentTime();
+    flightJournal.save(state);
+    journaledFlightPlanStep = flightPlanStep;
+    samplesSinceJournal = 0;
+#endif
+}
+
+void logContinuity() {
+// Écrit un évènement dans l'historique quand la continuité des allumettes change, et l'état de
+// départ à la première mesure.
+    ContinuitySnapshot continuity = rocket.getContinuity();
+    if(continuityLogged && continuity.changes == loggedContinuityChanges) {
+        return;
+    }
+    rocket.logEvent((LogEvent)(LOG_EVENT_CONTINUITY_NONE + continuity.connections));
+    loggedContinuityChanges = continuity.changes;
+    continuityLogged = true;
+}
+
+#if ALTIMETER_DUAL
+void logBarometerHealth() {
+// Écrit un évènement dans l'historique quand un baromètre tombe en panne ou redevient sain (voir
+// barometerFusion.h).
+    for(byte i = 0; i < BAROMETER_FUSION_SENSORS; i++) {
+        BarometerHealth health = rocket.getBarometerHealth(i);
+        if(health.changes == loggedBarometerChanges[i]) {
+            continue;
         }
+        rocket.logEvent((LogEvent)((health.healthy ? LOG_EVENT_BAROMETER_1_OK : LOG_EVENT_BAROMETER_1_FAILED) + i));
+        loggedBarometerChanges[i] = health.changes;
     }
 }
+#endif
 
-void requireAltitudeUpdate() { 
-// Fonction appellée par le timer interrupt. Marque les valeurs comme étant non à jour.
-  altitudeUpToDate = false; 
+void logBootTime() {
+// Écrit la durée du démarrage dans l'historique et sur le port série, après la première mesure.
+// Après la reprise d'un vol, le message ne bloque pas la boucle (voir Rocket::logMessage()).
+    String message = F(MESSAGE_BOOT_TIME);
+    message += ',';
+    message += String(setupDuration);
+    message += ',';
+    message += String(micros());
+    rocket.logMessage(message, !isInFlight());
+    bootTimeLogged = true;
+}
+
+void logProfilerReport() {
+// Écrit les mesures de temps de la boucle et de la RAM dans l'historique et sur le port série. La
+// RAM est mesurée avant que le rapport utilise le tas.
+    memoryMonitor.measure();
+    noInterrupts();
+    loopProfiler.setMissedTicks(tickQueue.getOverflowCount());
+    interrupts();
+    for(byte i = 0; i < loopProfiler.getReportLineCount(); i++) {
+        rocket.logMessage(loopProfiler.getReportLine(i), true);
+    }
+    for(byte i = 0; i < TASK_COUNT; i++) {
+        rocket.logMessage(scheduler.getReportLine(i), true);
+    }
+    rocket.logMessage(memoryMonitor.getReportLine(), true);
+#if ALTIMETER_DUAL
+    for(byte i = 0; i < BAROMETER_FUSION_SENSORS; i++) {
+        rocket.logMessage(rocket.getBarometerReport(i), true);
+    }
+#endif
+#if SERIAL_TELEMETRY
+    rocket.logMessage(rocket.getTelemetryReport(), true);
+#endif
+}
+
+byte verifyParachutes() {
+// Vérifie les parachutes en mesurant la durée de la vérification.
+    unsigned long stageStart = micros();
+    byte parachutesState = rocket.verifyParachutes();
+    loopProfiler.addStageDuration(PROFILER_STAGE_VERIFY_PARACHUTES, micros() - stageStart);
+    return parachutesState;
 }
 
 void followFlightPlan() {
     switch(flightPlanStep) {
         case FLIGHT_STEP_LAUNCHPAD:
-            rocket.verifyParachutes();
             if(rocket.getSpeed() > BREAKPOINT_SPEED_TO_BURNOUT && rocket.getAltitude(0) > BREAKPOINT_ALTITUDE_TO_BURNOUT) {
-                rocket.logEvent(MESSAGE_BURNOUT_STARTED);
+                rocket.stopPadBuffer();
+                rocket.logEvent(LOG_EVENT_BURNOUT_STARTED);
                 flightPlanStep = FLIGHT_STEP_BURNOUT;            
             }
             break;
             
         case FLIGHT_STEP_BURNOUT:
             if(rocket.getSpeed() < BREAKPOINT_SPEED_TO_PRE_DROGUE) {
-                rocket.logEvent(MESSAGE_BURNOUT_FINISHED); 
+                rocket.logEvent(LOG_EVENT_BURNOUT_FINISHED); 
                 flightPlanStep = FLIGHT_STEP_PRE_DROGUE;
             }
             break;
 
         case FLIGHT_STEP_PRE_DROGUE:
-            if(countApogeeTime() >= BREAKPOINT_DELTA_TIME_APOGEE) {
-                if(rocket.verifyParachutes() == TAG_PARACHUTE_NULL | rocket.verifyParachutes() == TAG_PARACHUTE_MAIN_ONLY) {
-                    rocket.logEvent(MESSAGE_DROGUE_ALREADY_OUT);
-                }
+            if(detectApogee()) {
+                // L'historique est écrit après la commande: il ne retarde pas le déploiement.
+                byte parachutesState = verifyParachutes();
                 rocket.deployParachute(ID_PARACHUTE_DROGUE);
-                rocket.logEvent(MESSAGE_DROGUE_OUT);
+                if(parachutesState == TAG_PARACHUTE_NULL || parachutesState == TAG_PARACHUTE_MAIN_ONLY) {
+                    rocket.logEvent(LOG_EVENT_DROGUE_ALREADY_OUT);
+                }
+                rocket.logEvent(LOG_EVENT_DROGUE_OUT);
                 flightPlanStep = FLIGHT_STEP_PRE_MAIN;
             }
             break;
 
         case FLIGHT_STEP_PRE_MAIN:
             if(rocket.getAltitude(0) < BREAKPOINT_ALTITUDE_TO_DRIFT) {
-                if(rocket.verifyParachutes() == TAG_PARACHUTE_NULL) {
-                    rocket.logEvent(MESSAGE_MAIN_ALREADY_OUT);
-                }
+                byte parachutesState = verifyParachutes();
                 rocket.deployParachute(ID_PARACHUTE_MAIN);
-                rocket.logEvent(MESSAGE_MAIN_OUT);
+                if(parachutesState == TAG_PARACHUTE_NULL) {
+                    rocket.logEvent(LOG_EVENT_MAIN_ALREADY_OUT);
+                }
+                rocket.logEvent(LOG_EVENT_MAIN_OUT);
                 flightPlanStep = FLIGHT_STEP_DRIFT;
             }
             break;
 
         case FLIGHT_STEP_DRIFT:
             if(rocket.getSpeed() < BREAKPOINT_SPEED_TO_IDLE) {
-                rocket.logEvent(MESSAGE_FLIGHT_FINISHED);
+                rocket.logEvent(LOG_EVENT_FLIGHT_FINISHED);
+                profilerReportRequested = true;
                 flightPlanStep = FLIGHT_STEP_IDLE;      
             }
             break;
 
         case FLIGHT_STEP_IDLE:
-            rocket.verifyParachutes();
             break;
     }
 }
 
 
-byte countApogeeTime() {
-    if(rocket.getMaxAltitude() == rocket.getAltitude(0)) {
-      apogeeTimeCounter = 0;
-    }
-  
-    else {
-      apogeeTimeCounter ++;
-    }
+bool detectApogee() {
+// Donne la vitesse verticale de la dernière mesure et le temps écoulé depuis la précédente au
+// détecteur d'apogée.
+    return apogeeDetector.update(rocket.getVerticalSpeed(), rocket.getSampleInterval());
 }
 
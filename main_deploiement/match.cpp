@@ -4,11 +4,9 @@ Match::Match() {
     
 }
 
-void Match::init(byte controlPin, byte feedbackPin) {
+void Match::init(byte controlPin) {
     _controlPin = controlPin;
-    _feedbackPin = feedbackPin;
     
-    pinMode(_feedbackPin, INPUT);
     pinMode(_controlPin, OUTPUT);
     digitalWrite(_controlPin, LOW);
 }
@@ -16,7 +14,3 @@ void Match::init(byte controlPin, byte feedbackPin) {
 void Match::lightMatch() {
     digitalWrite(_controlPin, HIGH);
 }
-
-bool Match::verifyMatchConnection() {
-    return digitalRead(_feedbackPin);
-}
@@ -0,0 +1,101 @@
+#include "memoryMonitor.h"
+
+#if defined(__AVR__)
+// Symboles de l'éditeur de liens (avr-libc)
+extern uint8_t __data_start;
+extern uint8_t __heap_start;
+
+void memoryMonitorPaint() __attribute__((naked, used, section(".init1")));
+
+void memoryMonitorPaint() {
+/*
+ * Exécutée par le code de démarrage avant main(), dans .init1: la pile n'est pas encore
+ * initialisée (.init2), ni les variables globales copiées et mises à zéro (.init4). Ces sections
+ * sont sous __heap_start, le motif ne les touche donc pas. La fonction est naked et n'a pas de
+ * pile: la boucle est écrite en assembleur pour n'utiliser que des registres, de __heap_start
+ * jusqu'à la fin de la RAM (RAMEND).
+ */
+    __asm__ __volatile__(
+        "    ldi r30, lo8(__heap_start)\n"
+        "    ldi r31, hi8(__heap_start)\n"
+        "    ldi r24, %[paint]\n"
+        "    ldi r25, hi8(%[end])\n"
+        "1:  st Z+, r24\n"
+        "    cpi r30, lo8(%[end])\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :
+        : [paint] "M" (MEMORY_MONITOR_PAINT), [end] "i" (RAMEND)
+        : "r24", "r25", "r30", "r31", "memory");
+}
+#endif
+
+MemoryMonitor::MemoryMonitor() {
+    _staticSize = 0;
+    _heapPeak = 0;
+    _stackPeak = 0;
+    _unusedSize = 0;
+}
+
+void MemoryMonitor::measure() {
+/*
+ * Cherche le plus long bloc peint entre le début du tas et la pile courante.
+ */
+#if defined(__AVR__)
+    uint8_t *heapStart = &__heap_start;
+    uint8_t *stackPointer = (uint8_t *)SP;
+    uint8_t *bestStart = stackPointer;
+    unsigned int bestLength = 0;
+    uint8_t *address = heapStart;
+    while(address < stackPointer) {
+        if(*address != MEMORY_MONITOR_PAINT) {
+            address++;
+            continue;
+        }
+        uint8_t *start = address;
+        while(address < stackPointer && *address == MEMORY_MONITOR_PAINT) {
+            address++;
+        }
+        if((unsigned int)(address - start) > bestLength) {
+            bestStart = start;
+            bestLength = address - start;
+        }
+    }
+    _staticSize = heapStart - &__data_start;
+    _heapPeak = bestStart - heapStart;
+    _stackPeak = (uint8_t *)RAMEND - (bestStart + bestLength) + 1;
+    _unusedSize = bestLength;
+#endif
+}
+
+unsigned int MemoryMonitor::getStaticSize() {
+    return _staticSize;
+}
+
+unsigned int MemoryMonitor::getHeapPeak() {
+    return _heapPeak;
+}
+
+unsigned int MemoryMonitor::getStackPeak() {
+    return _stackPeak;
+}
+
+unsigned int MemoryMonitor::getUnusedSize() {
+    return _unusedSize;
+}
+
+String MemoryMonitor::getReportLine() {
+/*
+ * memory,<variables globales>,<tas>,<pile>,<jamais utilisée>
+ */
+    String line = F("memory,");
+    line += String(_staticSize);
+    line += ',';
+    line += String(_heapPeak);
+    line += ',';
+    line += String(_stackPeak);
+    line += ',';
+    line += String(_unusedSize);
+    return line;
+}
@@ -0,0 +1,41 @@
+/*
+ * Ce module mesure l'utilisation de la RAM du Arduino (2 ko sur le ATmega328P).
+ *
+ * Au démarrage, avant même l'initialisation de la pile, toute la RAM entre la fin des variables
+ * globales et la fin de la RAM est remplie du motif MEMORY_MONITOR_PAINT (voir memoryMonitorPaint()
+ * dans memoryMonitor.cpp). Le tas grandit
+ * vers le haut à partir de la fin des variables globales et la pile vers le bas à partir de la fin
+ * de la RAM: le plus long bloc où le motif est intact est la RAM qui n'a jamais servi. Sous ce
+ * bloc, c'est le plus haut niveau atteint par le tas (les String); au-dessus, la plus grande
+ * profondeur atteinte par la pile, interruptions comprises.
+ *
+ * measure() parcourt la RAM libre (environ 1 ms): elle n'est appelée que pour le rapport, au sol.
+ * Le rapport est une ligne de texte écrite dans l'historique par Rocket::logMessage():
+ *     memory,<variables globales>,<tas>,<pile>,<jamais utilisée> (octets)
+ * Sur l'ordinateur hôte (simulation), la RAM de l'AVR n'existe pas: les valeurs sont à 0.
+ */
+
+#ifndef memoryMonitor_h
+#define memoryMonitor_h
+
+#include "Arduino.h"
+
+#define MEMORY_MONITOR_PAINT  0xA5
+
+class MemoryMonitor {
+    public:
+        MemoryMonitor();
+        void measure();
+        unsigned int getStaticSize();
+        unsigned int getHeapPeak();
+        unsigned int getStackPeak();
+        unsigned int getUnusedSize();
+        String getReportLine();
+
+    private:
+        unsigned int _staticSize;
+        unsigned int _heapPeak;
+        unsigned int _stackPeak;
+        unsigned int _unusedSize;
+};
+#endif
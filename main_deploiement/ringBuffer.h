@@ -0,0 +1,71 @@
+/*
+ * Tampon circulaire qui garde les SIZE dernières valeurs ajoutées. Quand il est plein, push()
+ * remplace la plus ancienne valeur et la retourne à l'appelant, qui peut encore l'utiliser (voir
+ * le tampon de la rampe dans Rocket::logData()).
+ *
+ * Contrairement à SpscQueue, le tampon n'est utilisé que par la boucle principale: il n'y a donc
+ * aucune précaution à prendre face aux interruptions. SIZE est d'au plus 255.
+ */
+
+#ifndef ringBuffer_h
+#define ringBuffer_h
+
+#include <stdint.h>
+
+template <typename T, uint8_t SIZE>
+class RingBuffer {
+    public:
+        RingBuffer() {
+            clear();
+        }
+
+        void clear() {
+            _first = 0;
+            _count = 0;
+        }
+
+        bool push(const T &value, T &evicted) {
+        /*
+         * Retourne true si le tampon était plein: evicted contient alors la valeur remplacée.
+         */
+            unsigned int last = _first + _count;
+            if(last >= SIZE) {
+                last -= SIZE;
+            }
+            if(_count < SIZE) {
+                _buffer[last] = value;
+                _count++;
+                return false;
+            }
+            evicted = _buffer[_first];
+            _buffer[_first] = value;
+            _first = _first + 1 < SIZE ? _first + 1 : 0;
+            return true;
+        }
+
+        bool pop(T &value) {
+        /*
+         * Retire la plus ancienne valeur.
+         */
+            if(_count == 0) {
+                return false;
+            }
+            value = _buffer[_first];
+            _first = _first + 1 < SIZE ? _first + 1 : 0;
+            _count--;
+            return true;
+        }
+
+        uint8_t size() const {
+            return _count;
+        }
+
+    private:
+        T _buffer[SIZE];
+        uint8_t _first;
+        uint8_t _count;
+
+        typedef char _sizeIsValid[(SIZE > 0) ? 1 : -1];
+};
+
+#endif
@@ -1,17 +1,44 @@
 #include "rocket.h"
 
-Rocket::Rocket() {
+// Taille d'un enregistrement binaire, déclarée dans l'entête du fichier (voir logFormat.h)
+#if ALTITUDE_ESTIMATOR_KALMAN
+#define LOG_RECORD_SIZE  (sizeof(LogRecord) + sizeof(LogEstimate))
+#else
+#define LOG_RECORD_SIZE  sizeof(LogRecord)
+#endif
+
+Rocket::Rocket() : _altitudeFilter(ALTITUDE_FILTER_A, ALTITUDE_FILTER_B) {
 /*
  * Le constructeur initialise les variables qui contiendront les valeurs d'altitudes mesurées
- * et filtrés. Il est important de bien les initialiser à la valeur 0.
+ * et filtrés. Il est important de bien les initialiser à la valeur 0. L'historique du filtre
+ * est mis à 0 par son constructeur.
  */
-    for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
-        _mesuredAltitude[i] = 0;
-        _filteredAltitude[i] = 0;
-    }
+    _mesuredAltitude = 0;
+    _filteredAltitude = 0;
     _maxAltitude = 0;
     _speed = 0;
+    _verticalSpeed = 0;
+    _fillSampleTimes(0);
+    _sampleTimesValid = false;
     _groundPressure = 0;
+    _inverseGroundPressure = 0;
+#if ALTIMETER_DUAL
+    _secondGroundPressure = 0;
+    _secondInverseGroundPressure = 0;
+    _altimetersDone = 0;
+#endif
+    _logFileNumber = 0;
+#if LOG_UNIT_PREALLOCATED_SIZE > 0
+    _preallocating = false;
+#endif
+    _timeOffset = 0;
+#if LOG_UNIT_PAD_BUFFER
+    _padBuffering = false;
+    _samplesSinceData = 0;
+#endif
+#if LOG_UNIT_BINARY
+    _recordsSinceKeyframe = LOG_UNIT_KEYFRAME_PERIOD; // La première donnée est complète
+#endif
 }
 
 
@@ -19,8 +46,33 @@ float Rocket::getSpeed() {
     return _speed;
 }
 
+float Rocket::getVerticalSpeed() {
+/*
+ * Vitesse verticale signée (m/s), positive en montée.
+ */
+    return _verticalSpeed;
+}
+
+unsigned long Rocket::getSampleTime() {
+/*
+ * Temps micros() de la dernière altitude valide, pris au début de sa conversion de pression.
+ */
+    return _sampleTimes[0];
+}
+
+unsigned long Rocket::getSampleInterval() {
+/*
+ * Temps écoulé (us) entre les deux dernières altitudes valides: une mesure invalide ou en retard
+ * allonge l'intervalle au lieu de fausser la vitesse.
+ */
+    return _sampleTimes[0] - _sampleTimes[1];
+}
+
 float Rocket::getAltitude(byte index) {
-    return _filteredAltitude[index];
+    if(index == 0) {
+        return _filteredAltitude;
+    }
+    return IirFilter<ALTITUDE_FILTER_ORDER>::toFloat(_altitudeFilter.getOutput(index));
 }
 
 float Rocket::getMaxAltitude() {
@@ -28,11 +80,105 @@ float Rocket::getMaxAltitude() {
 }
 
 void Rocket::initHardware() {
-    _initLogUnit(IO_SD_CS, LOG_UNIT_SERIAL_BAUDRATE, LOG_UNIT_FILE_NAME);
-    _initAltimeter();    
-    _buzzer.init(IO_BUZZER_OUT, BUZZER_TIME_BETWEEN_SEQUENCES, BUZZER_CYCLE_DURATION);  
-    _drogueParachute.init(IO_DROGUE_OUT, IO_DROGUE_FEEDBACK);
-    _mainParachute.init(IO_MAIN_OUT, IO_MAIN_FEEDBACK);
+    _initHardware(0);
+}
+
+bool Rocket::resumeHardware(const FlightState &state) {
+/*
+ * Initialise le matériel après un redémarrage en vol (voir FLIGHT_JOURNAL): la pression au sol,
+ * l'altitude maximale et l'historique du filtre sont repris du journal au lieu d'être mesurés, et
+ * l'historique continue dans le même fichier. Le temps de l'historique repart de celui de l'état.
+ *
+ * L'altimètre est initialisé en premier et fait une mesure. Si l'altitude par rapport à la pression
+ * au sol du journal ne correspond pas à l'étape et à l'altitude maximale de l'état (voir
+ * _isResumeAltitude()), le journal est périmé: la fonction retourne false sans initialiser le reste
+ * du matériel, et initHardware() doit être appelée.
+ */
+    _initAltimeter(&state);
+    if(!_isResumeAltitude(state)) {
+        return false;
+    }
+    _timeOffset = state.timeStamp;
+    _maxAltitude = state.maxAltitude;
+    _altitudeFilter.restore(state.filterInput, state.filterOutput);
+    _mesuredAltitude = IirFilter<ALTITUDE_FILTER_ORDER>::toFloat(state.filterInput[0]);
+    _filteredAltitude = IirFilter<ALTITUDE_FILTER_ORDER>::toFloat(state.filterOutput[0]);
+    _initHardware(&state);
+    _fillSampleTimes(micros());
+    _calculateSpeed();
+    return true;
+}
+
+void Rocket::getFlightState(FlightState &state) {
+/*
+ * Remplit l'état du vol à écrire dans le journal, sauf l'étape et le temps de l'apogée qui
+ * appartiennent au plan de vol. L'historique est d'abord écrit sur la carte: la reprise
+ * continuera le fichier à cette position, au début d'une ligne ou d'un enregistrement.
+ */
+    writeLogData();
+    if (_logFile) {
+#if LOG_UNIT_BUFFERED
+        _logWriter.commit();
+        state.logPosition = _logWriter.position();
+#else
+        _logFile.flush();
+        state.logPosition = _logFile.position();
+#endif
+    }
+    else {
+        state.logPosition = 0;
+    }
+    state.logFileNumber = _logFileNumber;
+    state.timeStamp = millis() + _timeOffset;
+    state.groundPressure = _groundPressure;
+#if ALTIMETER_DUAL
+    state.secondGroundPressure = _secondGroundPressure;
+#endif
+    state.maxAltitude = _maxAltitude;
+    for(byte i = 0; i <= ALTITUDE_FILTER_ORDER; i++) {
+        state.filterInput[i] = _altitudeFilter.getInput(i);
+        state.filterOutput[i] = _altitudeFilter.getOutput(i);
+    }
+#if ALTITUDE_ESTIMATOR_KALMAN
+    state.estimatedAltitude = _estimator.getAltitude();
+    state.estimatedVelocity = _estimator.getVelocity();
+    state.estimatedAcceleration = _estimator.getAcceleration();
+#endif
+}
+
+void Rocket::requestAltitude() {
+/*
+ * Lance la mesure d'altitude sans attendre le résultat. Voir altitudeAvailable(). Avec
+ * ALTIMETER_DUAL, les conversions des deux baromètres se font en même temps.
+ */
+    _altimeter.startMeasurement();
+#if ALTIMETER_DUAL
+    _secondAltimeter.startMeasurement();
+    _altimetersDone = 0;
+#endif
+}
+
+bool Rocket::altitudeAvailable() {
+/*
+ * Doit être appelée à chaque passage dans la boucle principale. Retourne true quand la mesure
+ * lancée par requestAltitude() est terminée, sur les deux baromètres avec ALTIMETER_DUAL;
+ * updateAltitude() peut alors être appelée.
+ */
+#if ALTIMETER_DUAL
+    if(_altimeter.update()) {
+        _altimetersDone |= 1;
+    }
+    if(_secondAltimeter.update()) {
+        _altimetersDone |= 2;
+    }
+    if(_altimetersDone != 3) {
+        return false;
+    }
+    _altimetersDone = 0;
+    return true;
+#else
+    return _altimeter.update();
+#endif
 }
 
 bool Rocket::updateAltitude() {
@@ -43,14 +189,23 @@ bool Rocket::updateAltitude() {
  */
     bool validAltitude;
     float mesuredAltitude;
+    unsigned long sampleTime;
 
-    mesuredAltitude = _altimeter.readAltitude(_groundPressure);
-    validAltitude = _validateAltitude(mesuredAltitude);
+#if ALTIMETER_DUAL
+    validAltitude = _fuseAltitudes(mesuredAltitude, sampleTime);
+#else
+    mesuredAltitude = _pressureToAltitude(_altimeter.getPressure());
+    validAltitude = _altimeter.isValid() && _validateAltitude(mesuredAltitude);
+    sampleTime = _altimeter.getMeasurementTime();
+#endif
     
     if(validAltitude) {
-        _prepareAltitudeVector();
-        _mesuredAltitude[0] = mesuredAltitude;
-        _filterAltitude();
+        _mesuredAltitude = mesuredAltitude;
+        _updateSampleTimes(sampleTime);
+        _filterAltitude(mesuredAltitude);
+#if ALTITUDE_ESTIMATOR_KALMAN
+        _estimator.update(mesuredAltitude, getSampleInterval()/1000000.0);
+#endif
         _calculateSpeed();
         _verifyMaxAltitude();
     }
@@ -58,41 +213,96 @@ bool Rocket::updateAltitude() {
 }
 
 void Rocket::logData() {
-    String dataStream;
-    dataStream += String(ID_LOG_DATA);
-    dataStream += (",");
-    dataStream += String(millis());
-    dataStream += (",");
-    dataStream += String(_mesuredAltitude[0]);
-    dataStream += (",");
-    dataStream += String(_filteredAltitude[0]);
-    dataStream += (",");
-    dataStream += String(_speed);
-    
-    Serial.println(dataStream);
-    if (_logFile) {
-        _logFile.println(dataStream);
-        _logFile.flush(); // Écrit le data physiquement sur la carte
+/*
+ * Met l'échantillon courant dans la file de l'historique, écrite plus tard par writeLogSample():
+ * l'écriture ne retarde pas le plan de vol.
+ */
+    LogEntry entry;
+    entry.sample = _currentSample();
+    entry.event = LOG_EVENT_NONE;
+    _queueEntry(entry);
+}
+
+bool Rocket::writeLogSample() {
+/*
+ * Écrit la plus ancienne entrée de l'historique: d'abord le reste du tampon de la rampe après
+ * stopPadBuffer(), puis la file. Retourne true s'il en reste.
+ */
+#if LOG_UNIT_PAD_BUFFER
+    LogSample sample;
+    if(!_padBuffering && _padBuffer.pop(sample)) {
+        String dataStream;
+        _writeData(sample, dataStream);
+        return true;
     }
+#endif
+    LogEntry entry;
+    if(_dataQueue.pop(entry)) {
+        if(entry.event == LOG_EVENT_NONE) {
+            _logSample(entry.sample);
+        }
+        else {
+            _logEventEntry(entry);
+        }
+    }
+    return _dataQueue.size() > 0;
 }
 
-void Rocket::logEvent(String message) {
+void Rocket::writeLogData() {
+/*
+ * Écrit toutes les entrées en attente, du plus ancien au plus récent.
+ */
+    while(writeLogSample()) {
+    }
+}
+
+void Rocket::logEvent(LogEvent event) {
+/*
+ * Met l'évènement dans la file de l'historique avec l'échantillon courant, après les données qui
+ * le précèdent. Il est écrit et envoyé par writeLogSample(), dans la tâche de l'historique: le
+ * plan de vol n'attend jamais la carte SD.
+ */
+    LogEntry entry;
+    entry.sample = _currentSample();
+    entry.event = event;
+    _queueEntry(entry);
+}
+
+void Rocket::logMessage(String message, bool wait) {
+/*
+ * Écrit une ligne d'information (ID_LOG_MESSAGE) dans l'historique, par exemple le rapport du
+ * LoopProfiler. Avec wait, au sol, la ligne attend la place libre du port série et est écrite
+ * physiquement sur la carte tout de suite, comme un évènement. Sans wait, en vol, elle ne bloque
+ * pas la boucle: elle est perdue sur le port série s'il n'a pas la place, et reste dans le tampon
+ * de l'historique jusqu'à la prochaine écriture d'un secteur.
+ */
+    writeLogData();
     String dataStream;
-    dataStream += String(ID_LOG_EVENT);
-    dataStream += (",");
-    dataStream += String(millis());
-    dataStream += (",");
-    dataStream += String(_mesuredAltitude[0]);
-    dataStream += (",");
-    dataStream += String(_filteredAltitude[0]);
-    dataStream += (",");
-    dataStream += String(_speed);
-    dataStream += (",");
+    dataStream += String(ID_LOG_MESSAGE);
+    dataStream += ',';
     dataStream += message;
-    
-    Serial.println(dataStream);
+
+#if SERIAL_TELEMETRY
+    _sendTelemetryText(message, wait);
+#else
+    if(wait || Serial.availableForWrite() >= (int)dataStream.length() + 2) {
+        Serial.println(dataStream);
+    }
+#endif
     if (_logFile) {
+        _flushPadBuffer();
+#if LOG_UNIT_BINARY
+        _writeLogText(message);
+#elif LOG_UNIT_BUFFERED
+        _logWriter.println(dataStream);
+#else
         _logFile.println(dataStream);
+#endif
+#if LOG_UNIT_BUFFERED
+        if(wait) {
+            _logWriter.commit();
+        }
+#endif
     }
 }
 
@@ -110,50 +320,197 @@ void Rocket::deployParachute(bool parachuteId) {
 
 byte Rocket::verifyParachutes() {
 /*
- * Vérifie la connection des parachutes et envoi un signal sonore selon l'état des parachutes.
+ * Retourne l'état des parachutes d'après la dernière continuité publiée (voir getContinuity()) et
+ * demande le signal sonore de cet état, joué par updateBuzzer().
  */
     byte parachutesState = 0;
-    if(_drogueParachute.verifyMatchConnection() && _mainParachute.verifyMatchConnection()) {
-        parachutesState = TAG_PARACHUTE_BOTH;
-        _buzzer.executeBuzzerSequence(4);
-    }
-    
-    else if(_mainParachute.verifyMatchConnection()) {
-        parachutesState = TAG_PARACHUTE_MAIN_ONLY;
-        _buzzer.executeBuzzerSequence(3);
-    }
-           
-    else if(_drogueParachute.verifyMatchConnection()) {
-        parachutesState = TAG_PARACHUTE_DROGUE_ONLY;
-        _buzzer.executeBuzzerSequence(2);
-    }
-    
-    else {
-        parachutesState = TAG_PARACHUTE_NULL;
-        _buzzer.executeBuzzerSequence(1);
+    switch(getContinuity().connections) {
+        case CONTINUITY_DROGUE | CONTINUITY_MAIN:
+            parachutesState = TAG_PARACHUTE_BOTH;
+            _buzzer.play(BUZZER_PATTERN_BOTH);
+            break;
+
+        case CONTINUITY_MAIN:
+            parachutesState = TAG_PARACHUTE_MAIN_ONLY;
+            _buzzer.play(BUZZER_PATTERN_MAIN_ONLY);
+            break;
+
+        case CONTINUITY_DROGUE:
+            parachutesState = TAG_PARACHUTE_DROGUE_ONLY;
+            _buzzer.play(BUZZER_PATTERN_DROGUE_ONLY);
+            break;
+
+        default:
+            parachutesState = TAG_PARACHUTE_NULL;
+            _buzzer.play(BUZZER_PATTERN_NO_PARACHUTE);
+            break;
     }
     return parachutesState;
 }
 
+ContinuitySnapshot Rocket::getContinuity() {
+/*
+ * Continuité des allumettes, lue par sampleContinuity() et filtrée contre les rebonds (voir
+ * continuity.h).
+ */
+    return _continuity.getSnapshot();
+}
+
+void Rocket::sampleContinuity() {
+/*
+ * Appelée par l'interruption du Timer1: lit les entrées de continuité des allumettes.
+ */
+    _continuity.sample();
+}
+
+void Rocket::updateBuzzer() {
+/*
+ * Appelée par l'interruption du Timer1: fait avancer la séquence du buzzer.
+ */
+    _buzzer.tick(millis());
+}
+
+void Rocket::startPadBuffer() {
+/*
+ * Garde les échantillons en RAM jusqu'à l'appel de stopPadBuffer() (voir logData()). Sans
+ * LOG_UNIT_PAD_BUFFER, chaque échantillon est écrit comme pendant le vol.
+ */
+#if LOG_UNIT_PAD_BUFFER
+    _padBuffer.clear();
+    _padBuffering = true;
+    _samplesSinceData = 0;
+#endif
+}
+
+void Rocket::stopPadBuffer() {
+/*
+ * Revient à l'écriture de chaque échantillon. Les dernières secondes gardées dans le tampon de la
+ * rampe sont écrites par writeLogSample(), un échantillon par exécution de la tâche de
+ * l'historique, avant les entrées de la file qui les suivent: le décollage ne bloque pas la boucle.
+ */
+#if LOG_UNIT_PAD_BUFFER
+    _padBuffering = false;
+#endif
+}
+
 void Rocket::stopLogging() {
+    stopPadBuffer();
+    writeLogData();
+#if LOG_UNIT_BUFFERED
+    _logWriter.commit();
+#endif
     _logFile.close();
+#if SERIAL_TELEMETRY
+    _telemetry.flush();
+#endif
     Serial.end();
 }
 
+void Rocket::updateTelemetry() {
+/*
+ * Appelée par la tâche de télémétrie (TASK_TELEMETRY): envoie la télémétrie en attente sans
+ * jamais attendre le port série.
+ */
+#if SERIAL_TELEMETRY
+    _telemetry.update();
+#endif
+}
+
+String Rocket::getTelemetryReport() {
+#if SERIAL_TELEMETRY
+    return _telemetry.getReportLine();
+#else
+    return String();
+#endif
+}
+
+#if ALTIMETER_DUAL
+BarometerHealth Rocket::getBarometerHealth(byte sensor) {
+/*
+ * Santé d'un baromètre (0 ou 1), voir barometerFusion.h.
+ */
+    return _barometerFusion.getHealth(sensor);
+}
+
+String Rocket::getBarometerReport(byte sensor) {
+    return _barometerFusion.getReportLine(sensor);
+}
+#endif
+
 
 //------------------------------------------------------------------------------------------------------------------------
 // Méthodes privées
 
-void Rocket::_initAltimeter() {
+void Rocket::_initHardware(const FlightState *resumeState) {
+/*
+ * À la reprise d'un vol, l'altimètre est déjà initialisé par resumeHardware().
+ */
+    _initLogUnit(IO_SD_CS, LOG_UNIT_SERIAL_BAUDRATE, F(LOG_UNIT_FILE_NAME), resumeState);
+    if(!resumeState) {
+        _initAltimeter(0);
+    }
+    _buzzer.init(IO_BUZZER_OUT, BUZZER_PATTERNS, BUZZER_PATTERN_COUNT);
+    _drogueParachute.init(IO_DROGUE_OUT);
+    _mainParachute.init(IO_MAIN_OUT);
+    _continuity.init(IO_DROGUE_FEEDBACK, IO_MAIN_FEEDBACK, CONTINUITY_DEBOUNCE_TICKS);
+}
+
+void Rocket::_initAltimeter(const FlightState *resumeState) {
 /*
  * Cette fonction initialise l'altimètre en appelant la méthode contenu dans son driver. L'initialisation
  * comprend aussi le réglage de la pression de référence de l'altimère à l'aide de la variable _groundPressure. 
+ * À la reprise d'un vol, la pression au sol est celle du journal: une mesure donnerait la
+ * pression à l'altitude de la fusée.
+ */
+#if ALTIMETER_DUAL
+    _altimeter.begin(ALTIMETER_OVERSAMPLING, ALTIMETER_TEMPERATURE_PERIOD, ALTIMETER_FIRST_MUX_CHANNEL);
+    _secondAltimeter.begin(ALTIMETER_OVERSAMPLING, ALTIMETER_TEMPERATURE_PERIOD, ALTIMETER_SECOND_MUX_CHANNEL);
+    Wire.setClock(ALTIMETER_I2C_CLOCK);
+    _secondGroundPressure = resumeState ? resumeState->secondGroundPressure : _secondAltimeter.readPressure();
+    _secondInverseGroundPressure = _secondGroundPressure > 0 ? 1/_secondGroundPressure : 0;
+    _barometerFusion.init(BAROMETER_FUSION_TOLERANCE, BAROMETER_FUSION_MAX_RATE, BAROMETER_FAILURE_SAMPLES);
+#else
+    _altimeter.begin(ALTIMETER_OVERSAMPLING, ALTIMETER_TEMPERATURE_PERIOD);
+    Wire.setClock(ALTIMETER_I2C_CLOCK);
+#endif
+    _groundPressure = resumeState ? resumeState->groundPressure : _altimeter.readPressure();
+    _inverseGroundPressure = _groundPressure > 0 ? 1/_groundPressure : 0;
+#if ALTITUDE_ESTIMATOR_KALMAN
+    _estimator.init(DATA_SAMPLING_PERIOD/1000000.0, ESTIMATOR_ALTITUDE_NOISE, ESTIMATOR_JERK_NOISE);
+    if(resumeState) {
+        _estimator.resume(resumeState->estimatedAltitude, resumeState->estimatedVelocity,
+                          resumeState->estimatedAcceleration);
+    }
+#endif
+}
+
+bool Rocket::_isResumeAltitude(const FlightState &state) {
+/*
+ * Mesure l'altitude par rapport à la pression au sol du journal (avec ALTIMETER_DUAL, le second
+ * baromètre remplace le premier s'il ne répond pas). Un vol ne peut être repris que si la fusée
+ * est en l'air: au moins FLIGHT_RESUME_MIN_ALTITUDE, sans quoi le principal serait commandé au sol
+ * (PRE_MAIN) ou la prédiction de l'apogée commanderait le drogue (BURNOUT, PRE_DROGUE). En
+ * descente, la fusée ne peut pas être plus haute que l'altitude maximale du journal, à
+ * FLIGHT_RESUME_ALTITUDE_TOLERANCE près.
  */
-    _altimeter.begin();
-    _groundPressure = _altimeter.readPressure();
+    float altitude = _pressureToAltitude(_altimeter.readPressure());
+    bool valid = _altimeter.isValid() && _validateAltitude(altitude);
+#if ALTIMETER_DUAL
+    if(!valid) {
+        altitude = altitudeFromPressureRatio(_secondAltimeter.readPressure()*_secondInverseGroundPressure);
+        valid = _secondAltimeter.isValid() && _validateAltitude(altitude);
+    }
+#endif
+    if(!valid || altitude < FLIGHT_RESUME_MIN_ALTITUDE) {
+        return false;
+    }
+    if(state.flightPlanStep >= FLIGHT_STEP_PRE_MAIN && altitude > state.maxAltitude + FLIGHT_RESUME_ALTITUDE_TOLERANCE) {
+        return false;
+    }
+    return true;
 }
 
-void Rocket::_initLogUnit(byte chipSelectPin, long serialBaudRate, String fileName) {
+void Rocket::_initLogUnit(byte chipSelectPin, long serialBaudRate, String fileName, const FlightState *resumeState) {
 /*
  * Cette fonction initialise les périphériques d'enregistrement de l'historique du vol
  * de la fusée. Les périphériques sont le port série pour le débug et la carte Sd.
@@ -162,45 +519,473 @@ void Rocket::_initLogUnit(byte chipSelectPin, long serialBaudRate, String fileNa
  *            une exception dans ce cas-ci, car les programmes utilisés ne sont pas 
  *            très gourmant en ressource. De plus, le risque de se faire hacker est
  *            presque nul.
+ *
+ * À la reprise d'un vol, l'historique continue dans le fichier du journal, à la position de
+ * l'état repris, sans nouvel entête.
  */
     Serial.begin(serialBaudRate);
+#if SERIAL_TELEMETRY
+    _telemetry.begin(SERIAL_TELEMETRY_DECIMATION);
+#endif
     
     // Initialisation de la carte SD
     SD.begin(chipSelectPin);
-    for (int i = 1; i <= LOG_UNIT_MAX_NB_OF_FILES; i++) {
-        // Génération d'un nom de fichier unique sur la carte SD (Merci Jonathan Neault)
-        String fileNameTemp = fileName + '_' + String(i) + LOG_UNIT_FILE_EXT;
-        if (!SD.exists(fileNameTemp)) {
-            fileName = fileNameTemp;
-            break;
+    if (resumeState) {
+        _logFileNumber = resumeState->logFileNumber;
+        _logFile = SD.open(_logFileName(fileName, _logFileNumber), LOG_UNIT_FILE_MODE);
+        if (_logFile) {
+            _logFile.seek(resumeState->logPosition);
+        }
+    }
+    else {
+        // Un fichier déjà sur la carte (aucun numéro libre, voir _nextLogFileName()) n'est jamais
+        // réécrit: l'historique est ajouté à sa fin, sans préallocation.
+        _logFile = SD.open(_nextLogFileName(fileName), LOG_UNIT_FILE_MODE);
+        if (_logFile) {
+            _logFile.seek(_logFile.size());
+#if LOG_UNIT_PREALLOCATED_SIZE > 0
+            _preallocating = _logFile.size() == 0;
+#endif
         }
     }
-    _logFile = SD.open(fileName, FILE_WRITE);
   
+#if ALTITUDE_ESTIMATOR_KALMAN
+    String columns = F("timeStamp,rawAltitude,filteredAltitude,speed,estimatedAltitude,verticalSpeed,acceleration,message");
+#else
+    String columns = F("timeStamp,rawAltitude,filteredAltitude,speed,message");
+#endif
+    writeLogData();
     String dataStream;
     dataStream += String(ID_LOG_MESSAGE);
-    dataStream += String(",");
-    dataStream += String("timeStamp,rawAltitude,filteredAltitude,speed,message");
+    dataStream += ',';
+    dataStream += columns;
+#if SERIAL_TELEMETRY
+    _sendTelemetryText(columns, !resumeState); // À la reprise, la fusée est en vol
+#else
     Serial.println(dataStream);    
+#endif
     if (_logFile) {
+#if LOG_UNIT_BUFFERED
+        _logWriter.begin(&_logFile);
+#endif
+        if (resumeState) {
+            return;
+        }
+#if LOG_UNIT_BINARY
+        LogFileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic[0] = LOG_FORMAT_MAGIC_0;
+        header.magic[1] = LOG_FORMAT_MAGIC_1;
+        header.magic[2] = LOG_FORMAT_MAGIC_2;
+        header.magic[3] = LOG_FORMAT_MAGIC_3;
+        header.version = LOG_FORMAT_VERSION;
+        header.recordSize = LOG_RECORD_SIZE;
+        header.samplingPeriod = DATA_SAMPLING_PERIOD/1000;
+        _writeLog((const uint8_t *)&header, sizeof(header));
+#elif LOG_UNIT_BUFFERED
+        _logWriter.println(dataStream);
+#else
         _logFile.println(dataStream);
+#endif
     }
 }
 
-void Rocket::_prepareAltitudeVector() {
+String Rocket::_nextLogFileName(const String &baseName) {
 /*
- * Décale les vecteurs contenant les valeurs d'altitudes passées de 1 vers la droite pour
- * les préparer à la prochaine entré d'altitude. Il est important de définir la valeur
- * d'altitude présente (_mesuredAltitude[0]) à 0 avant la mesure d'altitude pour éviter des
- * problèmes lors du filtrage.
- *              Avant: [y0, y1, y2, y3]    Après: [0, y0, y1, y2]
+ * Génération d'un nom de fichier unique sur la carte SD (Merci Jonathan Neault). Avec
+ * LOG_UNIT_FILE_INDEX, on part du numéro du dernier fichier gardé dans l'EEPROM: le numéro suivant
+ * est normalement libre et un seul SD.exists() suffit. Les numéros suivants ne sont essayés que
+ * si la carte a servi avec un autre circuit, au plus LOG_UNIT_MAX_FILE_PROBES. Après
+ * LOG_UNIT_MAX_NB_OF_FILES, on revient à 1. Si aucun numéro essayé n'est libre, l'historique est
+ * ajouté à la fin du fichier qui suit le dernier utilisé: le vol précédent qu'il contient est gardé.
  */
-    for(int i = ALTITUDE_ARRAY_SIZE - 1; i > 0; i--) {    
-        _mesuredAltitude[i] = _mesuredAltitude[i-1];
-        _filteredAltitude[i] = _filteredAltitude[i-1];
+    uint16_t lastNumber = 0;
+#if LOG_UNIT_FILE_INDEX
+    EEPROM.get(EEPROM_LOG_FILE_NUMBER, lastNumber);
+    if (lastNumber > LOG_UNIT_MAX_NB_OF_FILES) {
+        lastNumber = 0; // EEPROM neuve
+    }
+    uint16_t probes = LOG_UNIT_MAX_FILE_PROBES;
+#else
+    uint16_t probes = LOG_UNIT_MAX_NB_OF_FILES;
+#endif
+    uint16_t number = lastNumber;
+    String fileName;
+    bool found = false;
+    for (uint16_t i = 0; i < probes && !found; i++) {
+        number = number % LOG_UNIT_MAX_NB_OF_FILES + 1;
+        fileName = _logFileName(baseName, number);
+        found = !SD.exists(fileName);
+    }
+    if (!found) {
+        number = lastNumber % LOG_UNIT_MAX_NB_OF_FILES + 1;
+        fileName = _logFileName(baseName, number);
     }
-    _mesuredAltitude[0] = 0;
-    _filteredAltitude[0] = 0;
+#if LOG_UNIT_FILE_INDEX
+    EEPROM.put(EEPROM_LOG_FILE_NUMBER, number);
+#endif
+    _logFileNumber = number;
+    return fileName;
+}
+
+String Rocket::_logFileName(const String &baseName, uint16_t number) {
+    String fileName = baseName;
+    fileName += '_';
+    fileName += String(number);
+    fileName += F(LOG_UNIT_FILE_EXT);
+    return fileName;
+}
+
+void Rocket::preallocateLog() {
+/*
+ * Appelée sur la rampe par la tâche de l'historique: écrit un bloc de remplissage à la fin d'un
+ * nouveau fichier d'historique, jusqu'à LOG_UNIT_PREALLOCATED_SIZE octets, puis revient à la
+ * position d'écriture. Les grappes (clusters) du fichier sont ainsi allouées avant le vol, et la
+ * taille du fichier ne change plus: un flush n'a plus à réécrire l'entrée du répertoire. Un bloc
+ * par exécution (environ 5 ms) laisse le démarrage et la mesure suivante sans attente; les 128 ko
+ * sont écrits en environ 26 s. Les lecteurs de l'historique ignorent le remplissage (lignes vides
+ * en texte, LOG_FORMAT_FILL en binaire). Après le décollage ou au-delà de cette taille, le fichier
+ * grandit normalement.
+ */
+#if LOG_UNIT_PREALLOCATED_SIZE > 0
+    if (!_preallocating || !_logFile) {
+        return;
+    }
+    unsigned long size = _logFile.size();
+    if (size >= LOG_UNIT_PREALLOCATED_SIZE) {
+        _preallocating = false;
+        return;
+    }
+    unsigned long position = _logFile.position();
+    unsigned long end = (size/LOG_UNIT_SECTOR_SIZE + 1)*LOG_UNIT_SECTOR_SIZE;
+    uint8_t fill[64];
+    memset(fill, LOG_UNIT_FILL_BYTE, sizeof(fill));
+    _logFile.seek(size);
+    while (size < end) {
+        size_t chunk = end - size < sizeof(fill) ? end - size : sizeof(fill);
+        if (_logFile.write(fill, chunk) != chunk) {
+            _preallocating = false; // Carte pleine: le fichier grandira pendant le vol
+            break;
+        }
+        size += chunk;
+    }
+    _logFile.seek(position);
+#endif
+}
+
+void Rocket::_writeLog(const uint8_t *data, size_t size) {
+#if LOG_UNIT_BUFFERED
+    _logWriter.write(data, size);
+#else
+    _logFile.write(data, size);
+#endif
+}
+
+void Rocket::_toLogRecord(byte id, byte eventCode, const LogSample &sample, LogRecord &record, LogEstimate &estimate) {
+/*
+ * Convertit un échantillon en enregistrement binaire (voir logFormat.h), pour l'historique et la
+ * télémétrie.
+ */
+    record.id = id;
+    record.event = eventCode;
+    record.speed = logFormatSpeed(sample.speed);
+    record.timeStamp = sample.timeStamp;
+    record.rawAltitude = logFormatCentimeters(sample.mesuredAltitude);
+    record.filteredAltitude = logFormatCentimeters(sample.filteredAltitude);
+    memset(&estimate, 0, sizeof(estimate));
+#if ALTITUDE_ESTIMATOR_KALMAN
+    estimate.altitude = logFormatCentimeters(sample.estimatedAltitude);
+    estimate.verticalSpeed = logFormatSpeed(sample.verticalSpeed);
+    estimate.acceleration = logFormatSpeed(sample.acceleration);
+#endif
+}
+
+void Rocket::_writeLogRecord(byte id, byte eventCode, const LogSample &sample) {
+/*
+ * Écrit un enregistrement binaire (voir logFormat.h). Les altitudes et la vitesse sont converties
+ * en centimètres, ce qui garde la même résolution que le format texte sans passer par la
+ * conversion des nombres réels en texte. Une donnée est écrite en delta, sauf toutes les
+ * LOG_UNIT_KEYFRAME_PERIOD données où elle est complète (point de reprise).
+ */
+#if LOG_UNIT_BINARY
+    LogRecord record;
+    LogEstimate estimate;
+    _toLogRecord(id, eventCode, sample, record, estimate);
+    if(id == ID_LOG_DATA && _recordsSinceKeyframe < LOG_UNIT_KEYFRAME_PERIOD) {
+        _writeLogDelta(record, estimate);
+        _recordsSinceKeyframe++;
+    }
+    else {
+        if(id == ID_LOG_DATA) {
+            record.event = LOG_FORMAT_KEYFRAME;
+        }
+        _writeLog((const uint8_t *)&record, sizeof(record));
+#if ALTITUDE_ESTIMATOR_KALMAN
+        _writeLog((const uint8_t *)&estimate, sizeof(estimate));
+#endif
+        _recordsSinceKeyframe = 0;
+    }
+    _previousRecord = record;
+    _previousEstimate = estimate;
+#endif
+}
+
+void Rocket::_writeLogDelta(const LogRecord &record, const LogEstimate &estimate) {
+/*
+ * Écrit les différences avec l'enregistrement précédent en varints (voir logFormat.h).
+ */
+#if LOG_UNIT_BINARY
+    uint8_t buffer[LOG_FORMAT_MAX_DELTA_SIZE];
+    uint8_t length = 0;
+    buffer[length++] = ID_LOG_DELTA;
+    length += logFormatPutUnsigned(&buffer[length], record.timeStamp - _previousRecord.timeStamp);
+    length += logFormatPutSigned(&buffer[length], record.rawAltitude - _previousRecord.rawAltitude);
+    length += logFormatPutSigned(&buffer[length], record.filteredAltitude - _previousRecord.filteredAltitude);
+    length += logFormatPutSigned(&buffer[length], (int32_t)record.speed - _previousRecord.speed);
+#if ALTITUDE_ESTIMATOR_KALMAN
+    length += logFormatPutSigned(&buffer[length], estimate.altitude - _previousEstimate.altitude);
+    length += logFormatPutSigned(&buffer[length], (int32_t)estimate.verticalSpeed - _previousEstimate.verticalSpeed);
+    length += logFormatPutSigned(&buffer[length], (int32_t)estimate.acceleration - _previousEstimate.acceleration);
+#endif
+    _writeLog(buffer, length);
+#endif
+}
+
+void Rocket::_writeLogText(const String &text) {
+/*
+ * Écrit un enregistrement ID_LOG_MESSAGE suivi du texte, complété par des zéros jusqu'à un
+ * multiple de la taille d'un enregistrement. Le champ event donne le nombre de blocs de texte.
+ */
+    byte blockCount = (text.length() + LOG_RECORD_SIZE - 1)/LOG_RECORD_SIZE;
+    uint8_t padding[LOG_RECORD_SIZE];
+    memset(padding, 0, sizeof(padding));
+
+    LogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.id = ID_LOG_MESSAGE;
+    record.event = blockCount;
+    record.timeStamp = millis() + _timeOffset;
+    _writeLog((const uint8_t *)&record, sizeof(record));
+    _writeLog(padding, LOG_RECORD_SIZE - sizeof(record));
+    _writeLog((const uint8_t *)text.c_str(), text.length());
+    _writeLog(padding, blockCount*LOG_RECORD_SIZE - text.length());
+}
+
+void Rocket::_writeData(const LogSample &sample, String &dataStream) {
+/*
+ * Écrit une ligne de données dans le fichier. dataStream est la ligne déjà formatée par logData(),
+ * ou une chaîne vide pour un échantillon du tampon de la rampe, qui est alors formaté ici.
+ */
+#if LOG_UNIT_BINARY
+    _writeLogRecord(ID_LOG_DATA, 0, sample);
+#else
+    if(dataStream.length() == 0) {
+        _formatSample(dataStream, ID_LOG_DATA, sample);
+    }
+#if LOG_UNIT_BUFFERED
+    _logWriter.println(dataStream);
+#else
+    _logFile.println(dataStream);
+#endif
+#endif
+#if LOG_UNIT_PAD_BUFFER
+    _samplesSinceData = 0;
+#endif
+}
+
+void Rocket::_sendTelemetry(byte id, byte eventCode, const LogSample &sample) {
+/*
+ * Envoie une donnée ou un évènement sans attendre le port série: la trame est perdue si la file
+ * de la télémétrie est pleine.
+ */
+#if SERIAL_TELEMETRY
+    LogRecord record;
+    LogEstimate estimate;
+    _toLogRecord(id, eventCode, sample, record, estimate);
+#if ALTITUDE_ESTIMATOR_KALMAN
+    _telemetry.send(&record, sizeof(record), &estimate, sizeof(estimate), false);
+#else
+    _telemetry.send(&record, sizeof(record), 0, 0, false);
+#endif
+#endif
+}
+
+void Rocket::_sendTelemetryText(const String &text, bool wait) {
+/*
+ * Envoie un message (ID_LOG_MESSAGE). Avec wait, au sol, attend la place libre; sinon le message
+ * est perdu si la file de la télémétrie est pleine, comme une donnée.
+ */
+#if SERIAL_TELEMETRY
+    LogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.id = ID_LOG_MESSAGE;
+    record.timeStamp = millis() + _timeOffset;
+    _telemetry.send(&record, sizeof(record), text.c_str(), text.length() > 255 ? 255 : text.length(), wait);
+#endif
+}
+
+void Rocket::_logSample(const LogSample &sample) {
+/*
+ * Sur la rampe (voir startPadBuffer()), l'échantillon est gardé dans le tampon de la rampe au
+ * lieu d'être écrit. L'échantillon qui sort du tampon plein n'est écrit que s'il vient
+ * LOG_UNIT_PAD_HEARTBEAT_SAMPLES échantillons après la dernière donnée écrite: l'historique reste
+ * en ordre chronologique. Le compte d'échantillons, contrairement à millis(), ne dépend pas des
+ * variations de la durée de la boucle.
+ */
+    String dataStream;
+#if SERIAL_TELEMETRY
+    if(_telemetry.isDataDue()) {
+        _sendTelemetry(ID_LOG_DATA, 0, sample);
+    }
+#elif !LOG_UNIT_BINARY
+    _formatSample(dataStream, ID_LOG_DATA, sample);
+    Serial.println(dataStream);
+#endif
+    if (_logFile) {
+#if LOG_UNIT_PAD_BUFFER
+        if(_padBuffering) {
+            LogSample evicted;
+            if(_padBuffer.push(sample, evicted) && ++_samplesSinceData >= LOG_UNIT_PAD_HEARTBEAT_SAMPLES) {
+                String heartbeat;
+                _writeData(evicted, heartbeat);
+            }
+            return;
+        }
+#endif
+        _writeData(sample, dataStream);
+#if !LOG_UNIT_BUFFERED
+        _logFile.flush(); // Écrit le data physiquement sur la carte
+#endif
+    }
+}
+
+void Rocket::_logEventEntry(const LogEntry &entry) {
+/*
+ * Le texte de l'évènement n'est lu dans la mémoire flash que pour une ligne de texte, sur le port
+ * série ou dans l'historique: le format binaire et la télémétrie n'écrivent que le code.
+ */
+#if !SERIAL_TELEMETRY || !LOG_UNIT_BINARY
+    char text[LOG_EVENT_MAX_LENGTH + 1];
+    logEventText((LogEvent)entry.event, text);
+    String dataStream;
+    _formatSample(dataStream, ID_LOG_EVENT, entry.sample);
+    dataStream += ',';
+    dataStream += text;
+#endif
+    
+#if SERIAL_TELEMETRY
+    _sendTelemetry(ID_LOG_EVENT, entry.event, entry.sample);
+#else
+    Serial.println(dataStream);
+#endif
+    if (_logFile) {
+        _flushPadBuffer(); // Garde l'ordre chronologique si l'évènement arrive sur la rampe
+#if LOG_UNIT_BINARY
+        _writeLogRecord(ID_LOG_EVENT, entry.event, entry.sample);
+#elif LOG_UNIT_BUFFERED
+        _logWriter.println(dataStream);
+#else
+        _logFile.println(dataStream);
+#endif
+#if LOG_UNIT_BUFFERED
+        _logWriter.commit(); // Un évènement est toujours écrit physiquement sur la carte
+#endif
+    }
+}
+
+void Rocket::_queueEntry(const LogEntry &entry) {
+/*
+ * Si la file est pleine, les plus anciennes entrées sont écrites tout de suite pour n'en perdre
+ * aucune et garder l'ordre chronologique.
+ */
+    while(_dataQueue.size() >= LOG_UNIT_DATA_QUEUE_SIZE) {
+        writeLogSample();
+    }
+    LogEntry evicted;
+    _dataQueue.push(entry, evicted);
+}
+
+void Rocket::_flushPadBuffer() {
+/*
+ * Écrit les échantillons du tampon de la rampe, du plus ancien au plus récent. La rampe continue
+ * ensuite d'être enregistrée dans le tampon, qui repart vide.
+ */
+#if LOG_UNIT_PAD_BUFFER
+    LogSample sample;
+    while(_padBuffer.pop(sample)) {
+        String dataStream;
+        _writeData(sample, dataStream);
+    }
+#endif
+}
+
+LogSample Rocket::_currentSample() {
+    LogSample sample;
+    sample.timeStamp = millis() + _timeOffset;
+    sample.mesuredAltitude = _mesuredAltitude;
+    sample.filteredAltitude = _filteredAltitude;
+    sample.speed = _speed;
+#if ALTITUDE_ESTIMATOR_KALMAN
+    sample.estimatedAltitude = _estimator.getAltitude();
+    sample.verticalSpeed = _verticalSpeed;
+    sample.acceleration = _estimator.getAcceleration();
+#endif
+    return sample;
+}
+
+void Rocket::_formatSample(String &dataStream, byte id, const LogSample &sample) {
+/*
+ * Colonnes communes aux lignes de données et d'évènements du format texte, avec les colonnes de
+ * l'estimateur de Kalman s'il est utilisé.
+ */
+    dataStream += String(id);
+    dataStream += ',';
+    dataStream += String(sample.timeStamp);
+    dataStream += ',';
+    dataStream += String(sample.mesuredAltitude);
+    dataStream += ',';
+    dataStream += String(sample.filteredAltitude);
+    dataStream += ',';
+    dataStream += String(sample.speed);
+#if ALTITUDE_ESTIMATOR_KALMAN
+    dataStream += ',';
+    dataStream += String(sample.estimatedAltitude);
+    dataStream += ',';
+    dataStream += String(sample.verticalSpeed);
+    dataStream += ',';
+    dataStream += String(sample.acceleration);
+#endif
+}
+
+#if ALTIMETER_DUAL
+bool Rocket::_fuseAltitudes(float &mesuredAltitude, unsigned long &sampleTime) {
+/*
+ * Altitude fusionnée des deux baromètres, chacun par rapport à sa propre pression au sol (voir
+ * barometerFusion.h). La prédiction part de la dernière altitude mesurée, avec la vitesse
+ * verticale. Le temps de l'échantillon est celui du premier baromètre gardé, les deux
+ * conversions ayant commencé presque en même temps.
+ */
+    float altitudes[BAROMETER_FUSION_SENSORS];
+    bool valid[BAROMETER_FUSION_SENSORS];
+    altitudes[0] = _pressureToAltitude(_altimeter.getPressure());
+    valid[0] = _altimeter.isValid() && _validateAltitude(altitudes[0]);
+    altitudes[1] = altitudeFromPressureRatio(_secondAltimeter.getPressure()*_secondInverseGroundPressure);
+    valid[1] = _secondAltimeter.isValid() && _validateAltitude(altitudes[1]);
+
+    sampleTime = valid[0] || !valid[1] ? _altimeter.getMeasurementTime() : _secondAltimeter.getMeasurementTime();
+    unsigned long elapsedTime = sampleTime - _sampleTimes[0];
+    float predictedAltitude = _mesuredAltitude + _verticalSpeed*(elapsedTime/1000000.0);
+    return _barometerFusion.fuse(altitudes, valid, predictedAltitude, elapsedTime, mesuredAltitude);
+}
+#endif
+
+float Rocket::_pressureToAltitude(int32_t pressure) {
+/*
+ * Convertit la pression mesurée en altitude par rapport au sol avec la table de altitudeTable.h,
+ * au lieu d'évaluer pow() à chaque échantillon. L'inverse de la pression au sol est calculé une
+ * seule fois à l'initialisation: il ne reste qu'une multiplication et une interpolation.
+ */
+    return altitudeFromPressureRatio(pressure*_inverseGroundPressure);
 }
 
 bool Rocket::_validateAltitude(float mesuredAltitude) {
@@ -220,28 +1005,56 @@ bool Rocket::_validateAltitude(float mesuredAltitude) {
     return validAltitude;
 }
 
-void Rocket::_filterAltitude() {
+void Rocket::_updateSampleTimes(unsigned long sampleTime) {
+/*
+ * Décale les temps des mesures comme l'historique du filtre. La première mesure après le
+ * démarrage ou la reprise d'un vol n'a pas de mesure précédente connue: les temps passés sont
+ * alors espacés de la période nominale, comme le suppose l'historique du filtre.
+ */
+    if(!_sampleTimesValid) {
+        _fillSampleTimes(sampleTime);
+        _sampleTimesValid = true;
+        return;
+    }
+    for(byte i = ALTITUDE_FILTER_ORDER; i > 0; i--) {
+        _sampleTimes[i] = _sampleTimes[i-1];
+    }
+    _sampleTimes[0] = sampleTime;
+}
+
+void Rocket::_fillSampleTimes(unsigned long sampleTime) {
+    for(byte i = 0; i <= ALTITUDE_FILTER_ORDER; i++) {
+        _sampleTimes[i] = sampleTime - i*(unsigned long)DATA_SAMPLING_PERIOD;
+    }
+}
+
+void Rocket::_filterAltitude(float mesuredAltitude) {
 /*
  * Filtre la valeur d'altitude mesurée en calculant l'équation aux différence. Pour plus de détails
  * voir fichier configCircuitDeploiement.h ou le rapport de réalisation de la fusée.
  */
-    for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
-        _filteredAltitude[0] += (B[i]*_mesuredAltitude[i] - A[i]*_filteredAltitude[i]);
-    }
+    _filteredAltitude = _altitudeFilter.filter(mesuredAltitude);
 }
 
 void Rocket::_calculateSpeed() {
 /*
  * Calcul la vitesse instantannée de la fusée avec la dérivé de l'altitude (différence d'altitude selon le temps)
  * On calcul plusieurs vitesses différentes à l'aide des valeurs d'altitude contenu dans le vecteur et on fait la
- * moyenne des vitesses.
+ * moyenne des vitesses. La somme des différences successives se simplifie: (y[n] - y[n-N])/(t[n] - t[n-N]),
+ * avec les temps réels des mesures plutôt que N périodes nominales.
+ *
+ * Avec l'estimateur de Kalman, la vitesse est celle de l'estimateur. Dans les deux cas, elle est
+ * en m/s. _speed garde la valeur absolue utilisée par les breakpoints du plan de vol.
  */
-    _speed = 0;
-    for(int i = 0; i < ALTITUDE_ARRAY_SIZE-1; i++) {
-        _speed += (_filteredAltitude[i] - _filteredAltitude[i+1]);
-    }
-    _speed = _speed/(ALTITUDE_ARRAY_SIZE-1);
-        
+#if ALTITUDE_ESTIMATOR_KALMAN
+    _verticalSpeed = _estimator.getVelocity();
+#else
+    int32_t altitudeDifference;
+    unsigned long elapsedTime = _sampleTimes[0] - _sampleTimes[ALTITUDE_FILTER_ORDER];
+    altitudeDifference = _altitudeFilter.getOutput(0) - _altitudeFilter.getOutput(ALTITUDE_FILTER_ORDER);
+    _verticalSpeed = IirFilter<ALTITUDE_FILTER_ORDER>::toFloat(altitudeDifference)*1000000.0/elapsedTime;
+#endif
+    _speed = _verticalSpeed;
     if(_speed < 0) {
         _speed = -_speed;
     }
@@ -251,7 +1064,7 @@ void Rocket::_verifyMaxAltitude() {
 /*
  * Vérifie si l'altitude instantannée est la plus grand atteinte pendant ce vol.
  */
-    if(_filteredAltitude[0] > _maxAltitude) {
-        _maxAltitude = _filteredAltitude[0];
+    if(_filteredAltitude > _maxAltitude) {
+        _maxAltitude = _filteredAltitude;
     }
 }
@@ -10,42 +10,169 @@
 
 #include "configCircuitDeploiement.h"
 
+// Valeurs d'une ligne de données de l'historique (voir Rocket::logData())
+struct LogSample {
+    unsigned long timeStamp;    // ms
+    float mesuredAltitude;
+    float filteredAltitude;
+    float speed;
+#if ALTITUDE_ESTIMATOR_KALMAN
+    float estimatedAltitude;
+    float verticalSpeed;
+    float acceleration;
+#endif
+};
+
+// Entrée de la file de l'historique: une donnée, ou un évènement avec l'échantillon de son temps
+// (voir Rocket::logData() et Rocket::logEvent())
+struct LogEntry {
+    LogSample sample;
+    uint8_t event;              // LogEvent, LOG_EVENT_NONE pour une donnée
+};
+
+// État du vol gardé dans le journal de l'EEPROM pour le reprendre après un redémarrage (voir
+// FLIGHT_JOURNAL et Rocket::getFlightState())
+struct FlightState {
+    uint8_t flightPlanStep;
+    uint16_t logFileNumber;
+    uint32_t apogeeDescentTime; // us, voir ApogeeDetector::getDescentTime()
+    uint32_t logPosition;       // octets, fin de l'historique déjà écrit sur la carte
+    uint32_t timeStamp;         // ms, temps de l'historique
+    float groundPressure;       // Pa
+#if ALTIMETER_DUAL
+    float secondGroundPressure; // Pa, deuxième baromètre
+#endif
+    float maxAltitude;
+    int32_t filterInput[ALTITUDE_FILTER_ORDER+1];   // Q15.16, de la valeur présente à la plus ancienne
+    int32_t filterOutput[ALTITUDE_FILTER_ORDER+1];
+#if ALTITUDE_ESTIMATOR_KALMAN
+    float estimatedAltitude;
+    float estimatedVelocity;    // m/s
+    float estimatedAcceleration;
+#endif
+};
+
 class Rocket {
     public:
         Rocket();
         float getSpeed();
+        float getVerticalSpeed();
         float getAltitude(byte index);
+        unsigned long getSampleTime();
+        unsigned long getSampleInterval();
         float getMaxAltitude();
         
         void initHardware();        
+        bool resumeHardware(const FlightState &state);
+        void getFlightState(FlightState &state);
+        void requestAltitude();
+        bool altitudeAvailable();
         bool updateAltitude();     
         void logData();
-        void logEvent(String message);    
+        bool writeLogSample();
+        void writeLogData();
+        void logEvent(LogEvent event);
+        void logMessage(String message, bool wait);
         void deployParachute(bool parachuteId);
         byte verifyParachutes();
+        ContinuitySnapshot getContinuity();
+        void sampleContinuity();
+        void updateBuzzer();
+        void startPadBuffer();
+        void stopPadBuffer();
+        void preallocateLog();
         void stopLogging();
+        void updateTelemetry();
+        String getTelemetryReport();
+#if ALTIMETER_DUAL
+        BarometerHealth getBarometerHealth(byte sensor);
+        String getBarometerReport(byte sensor);
+#endif
 
    
     private:
-        float _mesuredAltitude[ALTITUDE_ARRAY_SIZE];
-        float _filteredAltitude[ALTITUDE_ARRAY_SIZE];
+        friend class RocketBenchmark;   // Chronomètre les étapes privées (simulation/rocketBenchmark.cpp)
+
+        IirFilter<ALTITUDE_FILTER_ORDER> _altitudeFilter;
+        float _mesuredAltitude;
+        float _filteredAltitude;
         float _maxAltitude;
         float _speed;
+        float _verticalSpeed;
+        unsigned long _sampleTimes[ALTITUDE_FILTER_ORDER+1];   // us, mesure des sorties du filtre, de la présente à la plus ancienne
+        bool _sampleTimesValid;         // false jusqu'à la première mesure après le démarrage ou la reprise
+#if ALTITUDE_ESTIMATOR_KALMAN
+        AltitudeEstimator _estimator;
+#endif
         
         float _groundPressure;
+        float _inverseGroundPressure;
         
-        Adafruit_BMP085 _altimeter;
+        Altimeter _altimeter;
+#if ALTIMETER_DUAL
+        Altimeter _secondAltimeter;
+        float _secondGroundPressure;
+        float _secondInverseGroundPressure;
+        byte _altimetersDone;           // Bits des altimètres dont la mesure demandée est terminée
+        BarometerFusion _barometerFusion;
+#endif
         File _logFile;
+        uint16_t _logFileNumber;
+#if LOG_UNIT_PREALLOCATED_SIZE > 0
+        bool _preallocating;            // Nouveau fichier, rempli sur la rampe (voir preallocateLog())
+#endif
+        unsigned long _timeOffset;      // ms, ajouté à millis() après la reprise d'un vol
+#if LOG_UNIT_BUFFERED
+        LogWriter _logWriter;
+#endif
+#if LOG_UNIT_BINARY
+        LogRecord _previousRecord;
+        LogEstimate _previousEstimate;
+        byte _recordsSinceKeyframe;
+#endif
+        RingBuffer<LogEntry, LOG_UNIT_DATA_QUEUE_SIZE> _dataQueue;
+#if LOG_UNIT_PAD_BUFFER
+        RingBuffer<LogSample, LOG_UNIT_PAD_BUFFER_SIZE> _padBuffer;
+        bool _padBuffering;
+        byte _samplesSinceData;
+#endif
+#if SERIAL_TELEMETRY
+        Telemetry _telemetry;
+#endif
         Buzzer _buzzer;
         Match _drogueParachute;
         Match _mainParachute;
+        ContinuitySampler _continuity;
         
-        void _initLogUnit(byte chipSelectPin, long serialBaudRate, String fileName);
-        void _initAltimeter();
+        void _initHardware(const FlightState *resumeState);
+        void _initLogUnit(byte chipSelectPin, long serialBaudRate, String fileName, const FlightState *resumeState);
+        String _logFileName(const String &baseName, uint16_t number);
+        String _nextLogFileName(const String &baseName);
+        void _initAltimeter(const FlightState *resumeState);
+        bool _isResumeAltitude(const FlightState &state);
+        void _writeLog(const uint8_t *data, size_t size);
+        void _toLogRecord(byte id, byte eventCode, const LogSample &sample, LogRecord &record, LogEstimate &estimate);
+        void _writeLogRecord(byte id, byte eventCode, const LogSample &sample);
+        void _writeLogText(const String &text);
+        void _writeLogDelta(const LogRecord &record, const LogEstimate &estimate);
+        void _writeData(const LogSample &sample, String &dataStream);
+        void _sendTelemetry(byte id, byte eventCode, const LogSample &sample);
+        void _sendTelemetryText(const String &text, bool wait);
+        void _logSample(const LogSample &sample);
+        void _logEventEntry(const LogEntry &entry);
+        void _queueEntry(const LogEntry &entry);
+        void _flushPadBuffer();
+        LogSample _currentSample();
+        void _formatSample(String &dataStream, byte id, const LogSample &sample);
 
+#if ALTIMETER_DUAL
+        bool _fuseAltitudes(float &mesuredAltitude, unsigned long &sampleTime);
+#endif
+        float _pressureToAltitude(int32_t pressure);
         bool _validateAltitude(float mesuredAltitude);
-        void _prepareAltitudeVector();
-        void _filterAltitude();
+        void _updateSampleTimes(unsigned long sampleTime);
+        void _fillSampleTimes(unsigned long sampleTime);
+        void _filterAltitude(float mesuredAltitude);
         void _calculateSpeed();
         void _verifyMaxAltitude();
 };
@@ -0,0 +1,89 @@
+/*
+ * File circulaire sans verrou entre une routine d'interruption (le producteur) et la boucle
+ * principale (le consommateur).
+ *
+ * Chaque index n'est modifié que par un seul côté: push() n'écrit que _head, pop() n'écrit que
+ * _tail. Les index sont des octets, lus et écrits en une seule instruction sur l'AVR, et la
+ * donnée est copiée avant que l'index soit publié. Il n'est donc pas nécessaire de bloquer les
+ * interruptions pour vider la file. SIZE doit être une puissance de 2 d'au plus 128.
+ *
+ * Quand la file est pleine, push() perd la nouvelle donnée et incrémente le compteur de
+ * débordements. Ce compteur n'est écrit que par le producteur.
+ */
+
+#ifndef spscQueue_h
+#define spscQueue_h
+
+#include <stdint.h>
+
+template <typename T, uint8_t SIZE>
+class SpscQueue {
+    public:
+        SpscQueue() {
+            reset();
+        }
+
+        void reset() {
+            _head = 0;
+            _tail = 0;
+            _overflowCount = 0;
+        }
+
+        bool push(const T &value) {
+        /*
+         * Appelée par le producteur seulement (routine d'interruption).
+         */
+            uint8_t head = _head;
+            if((uint8_t)(head - _tail) >= SIZE) {
+                _overflowCount++;
+                return false;
+            }
+            _buffer[head & (SIZE - 1)] = value;
+            _barrier();
+            _head = head + 1;
+            return true;
+        }
+
+        bool pop(T &value) {
+        /*
+         * Appelée par le consommateur seulement (boucle principale).
+         */
+            uint8_t tail = _tail;
+            if(tail == _head) {
+                return false;
+            }
+            _barrier();
+            value = _buffer[tail & (SIZE - 1)];
+            _barrier();
+            _tail = tail + 1;
+            return true;
+        }
+
+        uint8_t size() const {
+            return (uint8_t)(_head - _tail);
+        }
+
+        uint32_t getOverflowCount() const {
+        /*
+         * Le compteur a plusieurs octets: le consommateur doit le lire avec les interruptions
+         * bloquées pour ne pas voir une valeur à moitié écrite.
+         */
+            return _overflowCount;
+        }
+
+    private:
+        T _buffer[SIZE];
+        volatile uint8_t _head;
+        volatile uint8_t _tail;
+        volatile uint32_t _overflowCount;
+
+        static void _barrier() {
+            // Empêche le compilateur de déplacer les accès mémoire de part et d'autre.
+            __asm__ __volatile__("" ::: "memory");
+        }
+
+        // SIZE doit être une puissance de 2 pour que l'index revienne à 0 avec le masque.
+        typedef char _sizeIsPowerOfTwo[(SIZE > 0 && SIZE <= 128 && (SIZE & (SIZE - 1)) == 0) ? 1 : -1];
+};
+
+#endif
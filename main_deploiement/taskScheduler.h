@@ -0,0 +1,183 @@
+/*
+ * Ordonnanceur coopératif des tâches de la boucle principale.
+ *
+ * Les tâches sont numérotées de 0 à COUNT-1 par ordre de priorité, 0 étant la plus prioritaire.
+ * run() exécute une seule tâche, la plus prioritaire parmi celles qui sont prêtes, puis rend la
+ * main: une tâche prioritaire qui devient prête n'attend jamais plus que la durée d'une seule
+ * exécution d'une tâche moins prioritaire. Une tâche ne peut pas être interrompue; une tâche
+ * lente (écriture sur la carte SD) doit donc faire son travail par petits morceaux.
+ *
+ * Une tâche périodique (period > 0) est prête à chaque période, à partir de start(). Une tâche
+ * évènementielle (period = 0) est prête après signal(), qui donne le temps de l'évènement.
+ *
+ * La description des tâches (nom, fonction, période, échéance) ne change pas: c'est une table de
+ * TaskDefinition dans la mémoire flash (PROGMEM), donnée à setTasks(). Seuls le temps de la
+ * prochaine exécution et les compteurs sont en RAM, 17 octets par tâche.
+ *
+ * Le temps de réponse d'une exécution va du moment où la tâche est devenue prête à la fin de son
+ * exécution. Il dépasse l'échéance (deadline) quand la tâche a attendu ou duré trop longtemps: c'est
+ * une échéance manquée. Sont aussi comptées comme manquées les périodes sautées par une tâche
+ * périodique en retard de plus d'une période, et les signaux reçus par une tâche évènementielle
+ * qui n'avait pas encore traité le précédent.
+ *
+ * Le temps est en microsecondes sur 32 bits, comparé par différence. Le rapport (getReportLine())
+ * est écrit avec celui du LoopProfiler:
+ *     profiler,task,<tâche>,<exécutions>,<échéances manquées>,<pire temps de réponse us>
+ */
+
+#ifndef taskScheduler_h
+#define taskScheduler_h
+
+#include "Arduino.h"
+
+typedef void (*TaskFunction)();
+
+struct TaskDefinition {
+    const char *name;           // Chaîne en mémoire flash
+    TaskFunction function;
+    uint32_t period;            // us, 0: tâche évènementielle
+    uint32_t deadline;          // us, temps de réponse maximal
+};
+
+template <uint8_t COUNT>
+class TaskScheduler {
+    public:
+        TaskScheduler() {
+            _definitions = 0;
+            start(0);
+        }
+
+        void setTasks(const TaskDefinition *definitions) {
+        /*
+         * definitions: table de COUNT tâches dans la mémoire flash, par ordre de priorité.
+         */
+            _definitions = definitions;
+        }
+
+        void start(unsigned long timeNow) {
+        /*
+         * Remet les compteurs à zéro et rend les tâches périodiques prêtes à timeNow.
+         */
+            for(uint8_t i = 0; i < COUNT; i++) {
+                _tasks[i].release = timeNow;
+                _tasks[i].signaled = false;
+                _tasks[i].runCount = 0;
+                _tasks[i].missCount = 0;
+                _tasks[i].worstResponse = 0;
+            }
+        }
+
+        void signal(uint8_t task, unsigned long eventTime) {
+        /*
+         * Rend une tâche évènementielle prête. Si elle l'était déjà, elle ne sera exécutée qu'une
+         * fois, à partir du premier évènement.
+         */
+            if(task >= COUNT) {
+                return;
+            }
+            if(_tasks[task].signaled) {
+                _tasks[task].missCount++;
+                return;
+            }
+            _tasks[task].release = eventTime;
+            _tasks[task].signaled = true;
+        }
+
+        bool isPending(uint8_t task) {
+            return task < COUNT && _tasks[task].signaled;
+        }
+
+        bool run() {
+        /*
+         * Exécute la tâche prête la plus prioritaire. Retourne false si aucune tâche n'est prête.
+         */
+            if(!_definitions) {
+                return false;
+            }
+            unsigned long timeNow = micros();
+            for(uint8_t i = 0; i < COUNT; i++) {
+                Task &task = _tasks[i];
+                unsigned long period = pgm_read_dword(&_definitions[i].period);
+                if(period == 0 ? !task.signaled : (long)(timeNow - task.release) < 0) {
+                    continue;
+                }
+                TaskFunction function = (TaskFunction)pgm_read_ptr(&_definitions[i].function);
+                if(function == 0) {
+                    continue;
+                }
+                task.signaled = false; // La tâche peut être signalée de nouveau pendant son exécution
+                function();
+                _finish(task, period, pgm_read_dword(&_definitions[i].deadline), micros());
+                return true;
+            }
+            return false;
+        }
+
+        unsigned long getRunCount(uint8_t task) {
+            return task < COUNT ? _tasks[task].runCount : 0;
+        }
+
+        unsigned long getMissCount(uint8_t task) {
+            return task < COUNT ? _tasks[task].missCount : 0;
+        }
+
+        unsigned long getWorstResponse(uint8_t task) {
+            return task < COUNT ? _tasks[task].worstResponse : 0;
+        }
+
+        String getReportLine(uint8_t task) {
+            String line = F("profiler,task,");
+            if(task < COUNT && _definitions) {
+                line += (const __FlashStringHelper *)pgm_read_ptr(&_definitions[task].name);
+                line += ',';
+                line += String(_tasks[task].runCount);
+                line += ',';
+                line += String(_tasks[task].missCount);
+                line += ',';
+                line += String(_tasks[task].worstResponse);
+            }
+            return line;
+        }
+
+    private:
+        struct Task {
+            unsigned long release;      // us, moment où la tâche est (ou sera) prête
+            bool signaled;
+            unsigned long runCount;
+            unsigned long missCount;
+            unsigned long worstResponse;
+        };
+
+        const TaskDefinition *_definitions;    // Table en mémoire flash
+        Task _tasks[COUNT];
+
+        void _finish(Task &task, unsigned long period, unsigned long deadline, unsigned long timeNow) {
+        /*
+         * Compte l'exécution et prépare la prochaine période d'une tâche périodique. Une tâche en
+         * retard de plus d'une période saute les périodes manquées au lieu de s'exécuter plusieurs
+         * fois de suite pour les rattraper.
+         */
+            unsigned long response = timeNow - task.release;
+            task.runCount++;
+            if(response > task.worstResponse) {
+                task.worstResponse = response;
+            }
+            if(response > deadline) {
+                task.missCount++;
+            }
+            if(period == 0) {
+                return;
+            }
+            task.release += period;
+            unsigned long late = timeNow - task.release;
+            if((long)late >= (long)period) {
+                unsigned long skipped = late/period;
+                task.missCount += skipped;
+                task.release += skipped*period;
+            }
+        }
+
+        typedef char _countIsValid[(COUNT > 0) ? 1 : -1];
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "telemetry.h"
+
+Telemetry::Telemetry() {
+    begin(1);
+}
+
+void Telemetry::begin(byte decimation) {
+/*
+ * Vide la file et remet les compteurs à zéro. decimation est d'au moins 1 (chaque mesure).
+ */
+    _queue.reset();
+    _decimation = decimation > 0 ? decimation : 1;
+    _samplesSinceData = _decimation - 1; // La première mesure est envoyée
+    _sequence = 0;
+    _sentCount = 0;
+    _droppedCount = 0;
+}
+
+bool Telemetry::isDataDue() {
+/*
+ * Appelée une fois par mesure: retourne true pour une mesure sur decimation.
+ */
+    _samplesSinceData++;
+    if(_samplesSinceData < _decimation) {
+        return false;
+    }
+    _samplesSinceData = 0;
+    return true;
+}
+
+bool Telemetry::send(const void *record, uint8_t recordSize, const void *extra, uint8_t extraSize, bool wait) {
+/*
+ * Prépare une trame qui contient record suivi de extra (par exemple un LogRecord et le texte
+ * d'un message). La trame est construite sur place: la séquence, le contenu et le CRC sont
+ * copiés à partir de frame[1], puis codés en COBS. Retourne false si la trame est perdue.
+ */
+    uint8_t frame[TELEMETRY_FORMAT_MAX_FRAME];
+    if(recordSize > TELEMETRY_FORMAT_MAX_PAYLOAD - 1) {
+        recordSize = TELEMETRY_FORMAT_MAX_PAYLOAD - 1;
+    }
+    if(extraSize > TELEMETRY_FORMAT_MAX_PAYLOAD - 1 - recordSize) {
+        extraSize = TELEMETRY_FORMAT_MAX_PAYLOAD - 1 - recordSize;
+    }
+    uint8_t size = 1 + recordSize + extraSize;
+    frame[1] = _sequence++;
+    memcpy(&frame[2], record, recordSize);
+    memcpy(&frame[2 + recordSize], extra, extraSize);
+    uint16_t crc = telemetryFormatCrc(&frame[1], size);
+    frame[1 + size] = crc & 0xFF;
+    frame[2 + size] = crc >> 8;
+    uint8_t length = telemetryFormatEncode(frame, size + TELEMETRY_FORMAT_CRC_SIZE);
+
+    if(wait) {
+        flush(); // Garde l'ordre des trames
+        Serial.write(frame, length);
+        _sentCount++;
+        return true;
+    }
+    if(TELEMETRY_QUEUE_SIZE - _queue.size() < length) {
+        _droppedCount++;
+        return false;
+    }
+    for(uint8_t i = 0; i < length; i++) {
+        _queue.push(frame[i]);
+    }
+    _sentCount++;
+    return true;
+}
+
+void Telemetry::update() {
+/*
+ * Remplit le tampon d'émission du port série sans jamais attendre.
+ */
+    int space = Serial.availableForWrite();
+    uint8_t value;
+    while(space > 0 && _queue.pop(value)) {
+        Serial.write(value);
+        space--;
+    }
+}
+
+void Telemetry::flush() {
+/*
+ * Envoie toute la file, en attendant la place libre dans le tampon d'émission.
+ */
+    uint8_t value;
+    while(_queue.pop(value)) {
+        Serial.write(value);
+    }
+}
+
+String Telemetry::getReportLine() {
+/*
+ * telemetry,<trames envoyées>,<trames perdues>
+ */
+    String line = F("telemetry,");
+    line += String(_sentCount);
+    line += ',';
+    line += String(_droppedCount);
+    return line;
+}
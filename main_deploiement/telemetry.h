@@ -0,0 +1,46 @@
+/*
+ * Ce module envoie la télémétrie binaire sur le port série (SERIAL_TELEMETRY à 1, voir
+ * telemetryFormat.h pour le format des trames).
+ *
+ * Serial.write() attend quand le tampon d'émission du port série (64 octets sur l'AVR) est plein:
+ * à 115200 bauds, un octet part toutes les 87 us. Pour ne jamais retarder la boucle
+ * d'échantillonnage, une trame est d'abord placée au complet dans une file en RAM, puis update(),
+ * appelée à chaque passage dans la boucle principale, remplit le tampon d'émission selon la place
+ * libre (Serial.availableForWrite()). Si la file n'a pas la place pour toute la trame, la trame
+ * est perdue et comptée; son numéro de séquence est tout de même utilisé, ce qui permet au
+ * récepteur de compter les pertes.
+ *
+ * Les données ne sont envoyées qu'une fois toutes les decimation mesures (isDataDue()). Les
+ * messages (démarrage, rapport du LoopProfiler) ne sont pas envoyés pendant la boucle de vol: ils
+ * peuvent attendre la place libre (paramètre wait de send()) au lieu d'être perdus. De même,
+ * flush() envoie le reste de la file en attendant, une fois le vol terminé.
+ */
+
+#ifndef telemetry_h
+#define telemetry_h
+
+#include "Arduino.h"
+#include "spscQueue.h"
+#include "telemetryFormat.h"
+
+#define TELEMETRY_QUEUE_SIZE  128 // Octets, puissance de 2 (voir spscQueue.h)
+
+class Telemetry {
+    public:
+        Telemetry();
+        void begin(byte decimation);
+        bool isDataDue();
+        bool send(const void *record, uint8_t recordSize, const void *extra, uint8_t extraSize, bool wait);
+        void update();
+        void flush();
+        String getReportLine();
+
+    private:
+        SpscQueue<uint8_t, TELEMETRY_QUEUE_SIZE> _queue;
+        byte _decimation;
+        byte _samplesSinceData;
+        uint8_t _sequence;
+        unsigned long _sentCount;
+        unsigned long _droppedCount;
+};
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Format des trames de télémétrie binaire du port série (SERIAL_TELEMETRY à 1 dans
+ * configCircuitDeploiement.h, voir telemetry.h).
+ *
+ * Une trame contient:
+ *     numéro de séquence (1 octet, +1 à chaque trame préparée, même si elle est perdue)
+ *     LogRecord (voir logFormat.h): ID_LOG_DATA, ID_LOG_EVENT ou ID_LOG_MESSAGE
+ *     LogEstimate, pour une donnée ou un évènement avec ALTITUDE_ESTIMATOR_KALMAN à 1
+ *     texte du message, sans zéro final, pour ID_LOG_MESSAGE
+ *     CRC-16/CCITT (polynôme 0x1021, valeur initiale 0xFFFF) des octets précédents, petit-boutiste
+ * La trame est codée en COBS (Consistent Overhead Byte Stuffing): elle ne contient alors aucun
+ * octet nul et est suivie de l'octet 0, qui sépare les trames. Un récepteur qui démarre au milieu
+ * du flot ou qui perd des octets se resynchronise au 0 suivant; une trame abîmée est rejetée par
+ * son CRC et un saut du numéro de séquence indique les trames perdues.
+ *
+ * Une donnée prend 21 octets sur le port série (37 avec LogEstimate), contre 30 à 60 en texte.
+ *
+ * Ce fichier ne dépend pas de la librairie Arduino pour pouvoir être inclus par le décodeur
+ * de l'ordinateur hôte (simulation/telemetryStream.h).
+ */
+
+#ifndef telemetryFormat_h
+#define telemetryFormat_h
+
+#include <stdint.h>
+
+#define TELEMETRY_FORMAT_DELIMITER    0x00
+#define TELEMETRY_FORMAT_MAX_PAYLOAD  100 // Octets avant le CRC; un texte plus long est tronqué
+#define TELEMETRY_FORMAT_CRC_SIZE     2
+// Séquence, contenu et CRC, plus l'octet de code COBS et le délimiteur (un seul bloc COBS: la
+// trame fait moins de 254 octets)
+#define TELEMETRY_FORMAT_MAX_FRAME    (TELEMETRY_FORMAT_MAX_PAYLOAD + TELEMETRY_FORMAT_CRC_SIZE + 2)
+
+inline uint16_t telemetryFormatCrc(const uint8_t *data, uint8_t size) {
+    uint16_t crc = 0xFFFF;
+    for(uint8_t i = 0; i < size; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+inline uint8_t telemetryFormatEncode(uint8_t *frame, uint8_t size) {
+/*
+ * Code en COBS, sur place, les size octets de frame[1] à frame[size] et retourne la taille de la
+ * trame (size + 2): frame[0] reçoit l'octet de code et frame[size + 1] le délimiteur. Chaque octet
+ * nul est remplacé par la distance jusqu'au suivant (ou jusqu'à la fin); l'octet de code donne la
+ * distance jusqu'au premier.
+ */
+    uint8_t codePosition = 0;
+    for(uint8_t i = 1; i <= size; i++) {
+        if(frame[i] == 0) {
+            frame[codePosition] = i - codePosition;
+            codePosition = i;
+        }
+    }
+    frame[codePosition] = size + 1 - codePosition;
+    frame[size + 1] = TELEMETRY_FORMAT_DELIMITER;
+    return size + 2;
+}
+
+inline int telemetryFormatDecode(const uint8_t *frame, int size, uint8_t *data) {
+/*
+ * Décode une trame COBS sans son délimiteur. Retourne la taille des données, ou -1 si la trame
+ * est invalide (zéro dans la trame ou code qui dépasse sa fin).
+ */
+    int length = 0;
+    int position = 0;
+    while(position < size) {
+        uint8_t code = frame[position++];
+        if(code == 0 || position + code - 1 > size) {
+            return -1;
+        }
+        for(uint8_t i = 1; i < code; i++) {
+            if(frame[position] == 0) {
+                return -1;
+            }
+            data[length++] = frame[position++];
+        }
+        if(code < 0xFF && position < size) {
+            data[length++] = 0;
+        }
+    }
+    return length;
+}
+
+#endif
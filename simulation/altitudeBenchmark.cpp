@@ -0,0 +1,129 @@
+/*
+ * Précision et vitesse de la conversion pression -> altitude par table (altitudeTable.h)
+ * comparée à la formule barométrique évaluée avec pow().
+ *
+ * La précision est mesurée pour chaque pression entière (Pa) entre le sol et FLIGHT_MAXIMAL_ALTITUDE,
+ * pour plusieurs pressions au sol. La formule exacte est calculée en double. Le programme retourne
+ * 1 si l'erreur dépasse ALTITUDE_BENCHMARK_TOLERANCE.
+ *
+ * Le temps mesuré sur l'ordinateur hôte, qui a une unité de calcul en virgule flottante, ne donne
+ * qu'un ordre de grandeur de l'écart sur l'AVR, où pow() est émulée en logiciel.
+ *
+ * Utilisation: altitudeBenchmark           précision et temps de calcul
+ *              altitudeBenchmark --table   réécrit le contenu de ALTITUDE_TABLE
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "configCircuitDeploiement.h"
+
+#define ALTITUDE_BENCHMARK_TOLERANCE    0.10     // m
+#define ALTITUDE_BENCHMARK_CONVERSIONS  10000000
+
+namespace {
+    double exactAltitude(double ratio) {
+        return 44330*(1 - pow(ratio, 0.1903));
+    }
+
+    void printTable() {
+        for(int i = 0; i < ALTITUDE_TABLE_SIZE; i++) {
+            double ratio = ALTITUDE_TABLE_MIN_RATIO + (double)i/ALTITUDE_TABLE_STEPS_PER_RATIO;
+            double altitude = exactAltitude(ratio);
+            if(fabs(altitude) < 0.005) {
+                altitude = 0;
+            }
+            printf("%s%.2ff%s", i % 8 == 0 ? "    " : "", altitude,
+                   i == ALTITUDE_TABLE_SIZE - 1 ? "\n" : (i % 8 == 7 ? ",\n" : ", "));
+        }
+    }
+
+    double measureError(double groundPressure, double minimalAltitude, double maximalAltitude, double &worstAltitude) {
+    /*
+     * Erreur maximale pour chaque pression entière entre les deux altitudes, avec le même calcul
+     * que Rocket::_pressureToAltitude().
+     */
+        double worstError = 0;
+        float inverseGroundPressure = 1/(float)groundPressure;
+        int32_t lowPressure = (int32_t)ceil(groundPressure*pow(1 - maximalAltitude/44330, 1/0.1903));
+        int32_t highPressure = (int32_t)floor(groundPressure*pow(1 - minimalAltitude/44330, 1/0.1903));
+        for(int32_t pressure = lowPressure; pressure <= highPressure; pressure++) {
+            double expected = exactAltitude(pressure/groundPressure);
+            double error = fabs(altitudeFromPressureRatio(pressure*inverseGroundPressure) - expected);
+            if(error > worstError) {
+                worstError = error;
+                worstAltitude = expected;
+            }
+        }
+        return worstError;
+    }
+
+    volatile float benchmarkSink;
+
+    template <typename Conversion>
+    double measureTime(Conversion convert) {
+    /*
+     * Temps moyen d'une conversion (ns). La somme des altitudes empêche le compilateur
+     * d'éliminer les calculs.
+     */
+        volatile float groundPressure = 101325;
+        float inverseGroundPressure = 1/groundPressure;
+        float checksum = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int32_t i = 0; i < ALTITUDE_BENCHMARK_CONVERSIONS; i++) {
+            int32_t pressure = 60000 + (i % 42000);
+            checksum += convert(pressure, groundPressure, inverseGroundPressure);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        benchmarkSink = checksum;
+        return elapsed.count()/ALTITUDE_BENCHMARK_CONVERSIONS;
+    }
+
+    float convertWithPow(int32_t pressure, float groundPressure, float) {
+        return 44330*(1.0f - powf(pressure/groundPressure, 0.1903f));
+    }
+
+    float convertWithTable(int32_t pressure, float, float inverseGroundPressure) {
+        return altitudeFromPressureRatio(pressure*inverseGroundPressure);
+    }
+}
+
+int main(int argc, char **argv) {
+    if(argc == 2 && strcmp(argv[1], "--table") == 0) {
+        printTable();
+        return 0;
+    }
+    if(argc != 1) {
+        fprintf(stderr, "Utilisation: altitudeBenchmark [--table]\n");
+        return 2;
+    }
+
+    const double groundPressures[] = {95000, 101325, 103500};
+    double worstFlightError = 0;
+    printf("Erreur maximale de la table (%d entrées) par rapport à la formule exacte:\n", ALTITUDE_TABLE_SIZE);
+    for(size_t i = 0; i < sizeof(groundPressures)/sizeof(groundPressures[0]); i++) {
+        double flightAltitude = 0;
+        double rangeAltitude = 0;
+        double flightError = measureError(groundPressures[i], FLIGHT_MINIMAL_ALTITUDE, FLIGHT_MAXIMAL_ALTITUDE, flightAltitude);
+        double rangeError = measureError(groundPressures[i], FLIGHT_MINIMAL_ALTITUDE - ALTIMETER_INVALID_ALTITUDE_TOLERANCE,
+                                         FLIGHT_MAXIMAL_ALTITUDE + ALTIMETER_INVALID_ALTITUDE_TOLERANCE, rangeAltitude);
+        printf("    p0 = %6.0f Pa: %.3f m de 0 à 4000 m (à %.0f m), %.3f m de -1000 à 5000 m (à %.0f m)\n",
+               groundPressures[i], flightError, flightAltitude, rangeError, rangeAltitude);
+        if(flightError > worstFlightError) {
+            worstFlightError = flightError;
+        }
+    }
+
+    double powTime = measureTime(convertWithPow);
+    double tableTime = measureTime(convertWithTable);
+    printf("Temps par conversion sur l'hôte: pow() %.1f ns, table %.1f ns (%.1f fois plus rapide)\n",
+           powTime, tableTime, powTime/tableTime);
+
+    if(worstFlightError > ALTITUDE_BENCHMARK_TOLERANCE) {
+        printf("ÉCHEC: erreur supérieure à %.2f m\n", ALTITUDE_BENCHMARK_TOLERANCE);
+        return 1;
+    }
+    printf("OK: erreur sous %.2f m de 0 à 4000 m\n", ALTITUDE_BENCHMARK_TOLERANCE);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Mesure le délai de détection de l'apogée (commande du drogue - apogée réelle) du sketch compilé
+ * avec la configuration courante (voir apogeeDetector.h), sur des vols enregistrés rejoués et sur
+ * des vols synthétiques.
+ *
+ * Vols synthétiques (voir flightSimulation.h): l'apogée réelle est celle du modèle. Le rapport donne
+ * aussi le retard de la vitesse du sketch, du passage à zéro de la vitesse réelle (l'apogée) à
+ * celui de la vitesse mesurée: APOGEE_SPEED_LAG doit rester sous son minimum, sans quoi la
+ * prédiction commande le drogue avant l'apogée.
+ *
+ * Vols enregistrés (format alt_N.csv, voir flightReplay.h): l'apogée de référence est celle de
+ * findReplayApogee(), la même que pour breakpointTuner.
+ *
+ * Toute commande du drogue avant l'apogée est un échec, quelle que soit la vitesse de montée, comme
+ * un drogue jamais commandé: le programme retourne alors 1.
+ *
+ * Utilisation: apogeeBenchmark [--runs N] [--jobs N] [--seed N] [vol.csv...]
+ *     --runs  nombre de vols synthétiques (1000)
+ *     --jobs  nombre de processus (nombre de coeurs)
+ *     --seed  germe des tirages aléatoires (1)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "flightReplay.h"
+#include "flightSimulation.h"
+#include "parallel.h"
+#include "configCircuitDeploiement.h"
+
+namespace {
+    void printUsage() {
+        fprintf(stderr, "Utilisation: apogeeBenchmark [--runs N] [--jobs N] [--seed N] [vol.csv...]\n");
+    }
+
+    void printStatistics(const char *name, const Statistics &statistics) {
+        printf("    %s (s, %lu vols):\n", name, statistics.count);
+        printf("        moyenne %.3f, min %.3f, p5 %.3f, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n",
+               statistics.mean, statistics.minimum, statistics.p5, statistics.p50, statistics.p95,
+               statistics.p99, statistics.maximum);
+    }
+
+    bool benchmarkRecordedFlight(const char *path, unsigned long &failures) {
+        std::vector<ReplaySample> samples;
+        if(!loadReplaySamples(path, samples)) {
+            fprintf(stderr, "Impossible de lire %s\n", path);
+            return false;
+        }
+        double apogeeTime, apogeeAltitude;
+        if(!findReplayApogee(samples, apogeeTime, apogeeAltitude)) {
+            printf("    %s: apogée introuvable\n", path);
+            return true;
+        }
+        FlightReplay replay;
+        replay.run(samples);
+        const std::vector<ReplayEvent> &events = replay.getEvents();
+        for(size_t i = 0; i < events.size(); i++) {
+            if(events[i].type == REPLAY_EVENT_PARACHUTE && events[i].description == "drogue command") {
+                double latency = events[i].timeStamp/1000.0 - apogeeTime;
+                printf("    %s: apogée de %.1f m à %.3f s, drogue à %.3f s (%.1f m), délai %.3f s%s\n", path, apogeeAltitude,
+                       apogeeTime, events[i].timeStamp/1000.0, events[i].altitude, latency,
+                       latency < 0 ? ", ÉCHEC: avant l'apogée" : "");
+                if(latency < 0) {
+                    failures++;
+                }
+                return true;
+            }
+        }
+        printf("    %s: apogée de %.1f m à %.3f s, ÉCHEC: drogue jamais commandé\n", path, apogeeAltitude, apogeeTime);
+        failures++;
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t runs = 1000;
+    unsigned jobs = getProcessorCount();
+    uint64_t seed = 1;
+    std::vector<const char *> paths;
+    unsigned long failures = 0;
+
+    for(int i = 1; i < argc; i++) {
+        if(argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        }
+        else if(i + 1 >= argc) {
+            printUsage();
+            return 2;
+        }
+        else if(strcmp(argv[i], "--runs") == 0) {
+            runs = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--jobs") == 0) {
+            jobs = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], 0, 10);
+        }
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    printf("Détection de l'apogée: estimateur de Kalman %d, prédiction %d (retard %d ms), hystérésis %.1f m/s, "
+           "confirmation %d ms\n", ALTITUDE_ESTIMATOR_KALMAN, APOGEE_PREDICTOR, APOGEE_SPEED_LAG,
+           APOGEE_SPEED_HYSTERESIS, BREAKPOINT_DELTA_TIME_APOGEE);
+
+    if(!paths.empty()) {
+        printf("Vols enregistrés:\n");
+        for(size_t i = 0; i < paths.size(); i++) {
+            if(!benchmarkRecordedFlight(paths[i], failures)) {
+                return 1;
+            }
+        }
+    }
+
+    if(runs > 0) {
+        // Mêmes capteurs que monteCarlo par défaut
+        SensorOptions sensor;
+        sensor.noise = 0.5;
+        sensor.dropoutRate = 0.002;
+        sensor.maxDropout = 3;
+        sensor.transonicSpike = 30;
+        std::vector<FlightResult> results;
+        if(!simulateFlights(sensor, seed, runs, jobs, results)) {
+            fprintf(stderr, "Échec d'un processus de simulation\n");
+            return 1;
+        }
+        SimulationSummary summary = summarizeFlights(results);
+        unsigned long beforeApogee = 0;
+        float worstSpeed = 0;
+        for(size_t i = 0; i < results.size(); i++) {
+            if(results[i].drogueTime >= 0 && results[i].drogueTime < results[i].apogeeTime) {
+                beforeApogee++;
+                worstSpeed = std::max(worstSpeed, results[i].drogueSpeed);
+            }
+        }
+        printf("Vols synthétiques:\n");
+        printStatistics("Retard de la vitesse mesurée (passage à zéro - apogée)", summary.speedLag);
+        printStatistics("Délai de détection (commande du drogue - apogée)", summary.apogeeLatency);
+        printf("    échecs: %lu drogues avant l'apogée (vitesse de montée max %.2f m/s), %lu jamais commandés\n",
+               beforeApogee, worstSpeed, summary.drogueMissed);
+        failures += beforeApogee + summary.drogueMissed;
+    }
+    if(failures > 0) {
+        printf("ÉCHEC: %lu drogues avant l'apogée ou jamais commandés\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,594 @@
+#include "Arduino.h"
+
+#include <stdio.h>
+#include <string>
+
+namespace sim {
+    // Remises à zéro des autres périphériques simulés (SD.cpp, EEPROM.cpp, bmp085Device.cpp, TimerOne.cpp).
+    void resetSd();
+    void resetEeprom();
+    void resetBarometer();
+    void resetTimer();
+}
+
+volatile uint8_t MCUSR = _BV(PORF);
+uint8_t bootloaderResetFlags = 0;
+
+namespace {
+    uint64_t simulatedMicros = 0;
+    uint64_t bootMicros = 0; // Temps simulé du dernier redémarrage (voir sim::reboot())
+    uint8_t pinModes[NUM_DIGITAL_PINS];
+    uint8_t pinOutputs[NUM_DIGITAL_PINS];
+    uint8_t pinInputs[NUM_DIGITAL_PINS];
+    volatile uint8_t portInputs[PD + 1]; // Registres PINx, indexés par port
+    sim::PinListener pinListener = 0;
+    sim::SerialListener serialListener = 0;
+    bool serialEcho = false;
+    unsigned long stringAllocations = 0;
+    std::string serialInput;
+
+    void updatePortInput(uint8_t pin) {
+    /*
+     * Comme sur l'AVR, le registre PINx donne le niveau de la broche: la sortie pour une broche en
+     * sortie, l'entrée sinon.
+     */
+        uint8_t port = digitalPinToPort(pin);
+        if(port == NOT_A_PORT) {
+            return;
+        }
+        if(digitalRead(pin) == HIGH) {
+            portInputs[port] |= digitalPinToBitMask(pin);
+        }
+        else {
+            portInputs[port] &= ~digitalPinToBitMask(pin);
+        }
+    }
+
+    void updatePortInputs() {
+        for(uint8_t pin = 0; pin < NUM_DIGITAL_PINS; pin++) {
+            updatePortInput(pin);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// Contrôle du simulateur
+
+void sim::reset() {
+    simulatedMicros = 0;
+    bootMicros = 0;
+    MCUSR = _BV(PORF);
+    bootloaderResetFlags = 0;
+    for(int i = 0; i < NUM_DIGITAL_PINS; i++) {
+        pinModes[i] = INPUT;
+        pinOutputs[i] = LOW;
+        pinInputs[i] = LOW;
+    }
+    updatePortInputs();
+    pinListener = 0;
+    serialListener = 0;
+    serialEcho = false;
+    serialInput.clear();
+    stringAllocations = 0;
+    Serial.end();
+    resetSd();
+    resetEeprom();
+    resetBarometer();
+    resetTimer();
+}
+
+void sim::reboot(uint8_t resetFlags, bool optiboot) {
+    bootMicros = simulatedMicros;
+    MCUSR = optiboot ? 0 : resetFlags;
+    bootloaderResetFlags = optiboot ? resetFlags : 0;
+    for(int i = 0; i < NUM_DIGITAL_PINS; i++) {
+        pinModes[i] = INPUT;
+        pinOutputs[i] = LOW;
+    }
+    updatePortInputs();
+    serialInput.clear();
+    Serial.end();
+    resetTimer();
+}
+
+void sim::setMicros(uint64_t timeNow) {
+    simulatedMicros = timeNow;
+}
+
+void sim::advanceMicros(uint64_t delta) {
+    simulatedMicros += delta;
+}
+
+uint64_t sim::getMicros() {
+    return simulatedMicros;
+}
+
+void sim::setPinListener(PinListener listener) {
+    pinListener = listener;
+}
+
+void sim::setPinInput(uint8_t pin, uint8_t value) {
+    if(pin < NUM_DIGITAL_PINS) {
+        pinInputs[pin] = value ? HIGH : LOW;
+        updatePortInput(pin);
+    }
+}
+
+uint8_t sim::getPinOutput(uint8_t pin) {
+    return pin < NUM_DIGITAL_PINS ? pinOutputs[pin] : LOW;
+}
+
+uint8_t sim::getPinMode(uint8_t pin) {
+    return pin < NUM_DIGITAL_PINS ? pinModes[pin] : INPUT;
+}
+
+void sim::setSerialListener(SerialListener listener) {
+    serialListener = listener;
+}
+
+void sim::setSerialEcho(bool enabled) {
+    serialEcho = enabled;
+}
+
+void sim::sendSerialInput(const std::string &data) {
+    serialInput += data;
+}
+
+unsigned long sim::getStringAllocationCount() {
+    return stringAllocations;
+}
+
+//------------------------------------------------------------------------------------------------
+// Broches et temps
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if(pin < NUM_DIGITAL_PINS) {
+        pinModes[pin] = mode;
+        updatePortInput(pin);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if(pin >= NUM_DIGITAL_PINS) {
+        return;
+    }
+    value = value ? HIGH : LOW;
+    bool changed = pinOutputs[pin] != value;
+    pinOutputs[pin] = value;
+    updatePortInput(pin);
+    if(changed && pinListener) {
+        pinListener(pin, value);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if(pin >= NUM_DIGITAL_PINS) {
+        return LOW;
+    }
+    return pinModes[pin] == OUTPUT ? pinOutputs[pin] : pinInputs[pin];
+}
+
+uint8_t digitalPinToPort(uint8_t pin) {
+    if(pin < 8) {
+        return PD;
+    }
+    if(pin < 14) {
+        return PB;
+    }
+    if(pin < 20) {
+        return PC;
+    }
+    return NOT_A_PORT;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin) {
+    if(pin < 8) {
+        return _BV(pin);
+    }
+    if(pin < 14) {
+        return _BV(pin - 8);
+    }
+    if(pin < 20) {
+        return _BV(pin - 14);
+    }
+    return 0;
+}
+
+volatile uint8_t *portInputRegister(uint8_t port) {
+    return port != NOT_A_PORT && port <= PD ? &portInputs[port] : 0;
+}
+
+unsigned long millis() {
+    return (unsigned long)((simulatedMicros - bootMicros) / 1000);
+}
+
+unsigned long micros() {
+    // Chaque lecture coûte un peu de temps, comme sur l'AVR (résolution de 4 us): une boucle
+    // d'attente active sur micros() finit donc toujours par se terminer.
+    simulatedMicros += 4;
+    return (unsigned long)(simulatedMicros - bootMicros);
+}
+
+void delay(unsigned long ms) {
+    simulatedMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    simulatedMicros += us;
+}
+
+void noInterrupts() {
+}
+
+void interrupts() {
+}
+
+//------------------------------------------------------------------------------------------------
+// String
+
+namespace {
+    std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+        if(base < 2 || base > 16) {
+            base = 10;
+        }
+        char digits[sizeof(unsigned long)*8 + 2];
+        int i = sizeof(digits) - 1;
+        digits[i] = '\0';
+        do {
+            digits[--i] = "0123456789abcdef"[value % base];
+            value /= base;
+        } while(value != 0);
+        if(negative) {
+            digits[--i] = '-';
+        }
+        return std::string(&digits[i]);
+    }
+
+    std::string formatSigned(long value, unsigned char base) {
+        if(value < 0 && base == 10) {
+            return formatInteger(0UL - (unsigned long)value, true, base);
+        }
+        return formatInteger((unsigned long)value, false, base);
+    }
+
+    std::string formatReal(double value, unsigned char decimalPlaces) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimalPlaces, value);
+        return std::string(buffer);
+    }
+}
+
+String::String(const char *cstr) : _buffer(cstr ? cstr : ""), _capacity(0), _allocated(false) {
+    if(cstr) {
+        _reserve(_buffer.length());
+    }
+}
+
+String::String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+String::String(const String &value) : _buffer(value._buffer), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(char c) : _buffer(1, c), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(unsigned char value, unsigned char base) : _buffer(formatInteger(value, false, base)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(int value, unsigned char base) : _buffer(formatSigned(value, base)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(unsigned int value, unsigned char base) : _buffer(formatInteger(value, false, base)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(long value, unsigned char base) : _buffer(formatSigned(value, base)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(unsigned long value, unsigned char base) : _buffer(formatInteger(value, false, base)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(float value, unsigned char decimalPlaces) : _buffer(formatReal(value, decimalPlaces)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::String(double value, unsigned char decimalPlaces) : _buffer(formatReal(value, decimalPlaces)), _capacity(0), _allocated(false) {
+    _reserve(_buffer.length());
+}
+
+String::~String() {}
+
+String &String::operator=(const String &rhs) {
+    if(this != &rhs) {
+        _buffer = rhs._buffer;
+        _reserve(_buffer.length());
+    }
+    return *this;
+}
+
+String &String::operator=(const char *cstr) {
+    _buffer = cstr ? cstr : "";
+    _reserve(_buffer.length());
+    return *this;
+}
+
+String &String::operator+=(const String &rhs) {
+    if(rhs._buffer.length() > 0) {
+        _buffer += rhs._buffer;
+        _reserve(_buffer.length());
+    }
+    return *this;
+}
+
+String &String::operator+=(const char *cstr) {
+    if(cstr && cstr[0] != '\0') {
+        _buffer += cstr;
+        _reserve(_buffer.length());
+    }
+    return *this;
+}
+
+String &String::operator+=(const __FlashStringHelper *str) {
+    return *this += reinterpret_cast<const char *>(str);
+}
+
+String &String::operator+=(char c) {
+    _buffer += c;
+    _reserve(_buffer.length());
+    return *this;
+}
+
+void String::_reserve(unsigned int length) {
+/*
+ * Comme String::reserve() du Arduino: le tampon n'est agrandi (realloc(), ou malloc() pour le
+ * premier) que s'il est trop petit, et exactement à la longueur demandée.
+ */
+    if(_allocated && _capacity >= length) {
+        return;
+    }
+    _allocated = true;
+    _capacity = length;
+    stringAllocations++;
+}
+
+bool String::operator==(const String &rhs) const {
+    return _buffer == rhs._buffer;
+}
+
+bool String::operator==(const char *cstr) const {
+    return _buffer == (cstr ? cstr : "");
+}
+
+bool String::operator!=(const String &rhs) const {
+    return !(*this == rhs);
+}
+
+bool String::operator!=(const char *cstr) const {
+    return !(*this == cstr);
+}
+
+unsigned int String::length() const {
+    return _buffer.length();
+}
+
+const char *String::c_str() const {
+    return _buffer.c_str();
+}
+
+char String::charAt(unsigned int index) const {
+    return index < _buffer.length() ? _buffer[index] : '\0';
+}
+
+String operator+(const String &lhs, const String &rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(const String &lhs, const char *rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+String operator+(const String &lhs, char rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+//------------------------------------------------------------------------------------------------
+// Print
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while(size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::write(const char *str) {
+    return str ? write((const uint8_t *)str, strlen(str)) : 0;
+}
+
+size_t Print::print(const String &value) {
+    return write((const uint8_t *)value.c_str(), value.length());
+}
+
+size_t Print::print(const char *value) {
+    return write(value);
+}
+
+size_t Print::print(const __FlashStringHelper *value) {
+    return print(reinterpret_cast<const char *>(value));
+}
+
+size_t Print::print(char value) {
+    return write((uint8_t)value);
+}
+
+size_t Print::print(int value) {
+    return print(String(value));
+}
+
+size_t Print::print(unsigned int value) {
+    return print(String(value));
+}
+
+size_t Print::print(long value) {
+    return print(String(value));
+}
+
+size_t Print::print(unsigned long value) {
+    return print(String(value));
+}
+
+size_t Print::print(double value, int digits) {
+    return print(String(value, (unsigned char)digits));
+}
+
+size_t Print::println() {
+    return write((const uint8_t *)"\r\n", 2);
+}
+
+size_t Print::println(const String &value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(const char *value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(const __FlashStringHelper *value) {
+    return println(reinterpret_cast<const char *>(value));
+}
+
+size_t Print::println(char value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(int value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(unsigned int value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(long value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(unsigned long value) {
+    size_t n = print(value);
+    return n + println();
+}
+
+size_t Print::println(double value, int digits) {
+    size_t n = print(value, digits);
+    return n + println();
+}
+
+//------------------------------------------------------------------------------------------------
+// HardwareSerial
+
+HardwareSerial Serial;
+
+HardwareSerial::HardwareSerial() : _started(false), _byteMicros(0), _sendEnd(0) {}
+
+void HardwareSerial::begin(unsigned long baudRate) {
+    _started = true;
+    _byteMicros = baudRate > 0 ? 10e6/baudRate : 0;
+    _sendEnd = 0;
+}
+
+void HardwareSerial::end() {
+    _started = false;
+}
+
+int HardwareSerial::available() {
+    return _started ? serialInput.size() : 0;
+}
+
+int HardwareSerial::read() {
+    if(!_started || serialInput.empty()) {
+        return -1;
+    }
+    uint8_t value = serialInput[0];
+    serialInput.erase(0, 1);
+    return value;
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    if(!_started) {
+        return 0;
+    }
+    // Le tampon contient les octets qui ne sont pas encore partis: on attend qu'une place se
+    // libère pour chaque octet de trop.
+    for(size_t i = 0; i < size; i++) {
+        double now = (double)simulatedMicros;
+        if(_sendEnd < now) {
+            _sendEnd = now;
+        }
+        double fullUntil = _sendEnd - (SERIAL_TX_BUFFER_SIZE - 1)*_byteMicros;
+        if(fullUntil > now) {
+            simulatedMicros = (uint64_t)ceil(fullUntil);
+        }
+        _sendEnd += _byteMicros;
+    }
+    if(serialListener) {
+        serialListener(buffer, size);
+    }
+    if(serialEcho) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+int HardwareSerial::availableForWrite() {
+/*
+ * Comme sur l'AVR, au plus SERIAL_TX_BUFFER_SIZE - 1 octets.
+ */
+    if(!_started) {
+        return 0;
+    }
+    double pending = _byteMicros > 0 ? (_sendEnd - (double)simulatedMicros)/_byteMicros : 0;
+    if(pending <= 0) {
+        return SERIAL_TX_BUFFER_SIZE - 1;
+    }
+    int used = (int)ceil(pending);
+    return used >= SERIAL_TX_BUFFER_SIZE - 1 ? 0 : SERIAL_TX_BUFFER_SIZE - 1 - used;
+}
+
+void HardwareSerial::flush() {
+    if(_started && _sendEnd > (double)simulatedMicros) {
+        simulatedMicros = (uint64_t)ceil(_sendEnd);
+    }
+}
+
+HardwareSerial::operator bool() const {
+    return _started;
+}
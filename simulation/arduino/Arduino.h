@@ -0,0 +1,67 @@
+/*
+ * Couche Arduino de remplacement pour compiler le code du déploiement sur l'ordinateur hôte.
+ * Seule la partie de l'API Arduino utilisée par main_deploiement est reproduite. Le temps,
+ * les broches et les périphériques sont contrôlés par le simulateur (voir simulator.h).
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH    0x1
+#define LOW     0x0
+
+#define INPUT         0x0
+#define OUTPUT        0x1
+#define INPUT_PULLUP  0x2
+
+#define A0  14
+#define A1  15
+#define A2  16
+#define A3  17
+#define A4  18
+#define A5  19
+#define A6  20
+#define A7  21
+
+#define NUM_DIGITAL_PINS  22
+
+// Ports de l'ATmega328P (Arduino Nano): broches 0 à 7 sur PD, 8 à 13 sur PB, A0 à A5 sur PC. A6
+// et A7 sont des entrées analogiques seulement.
+#define NOT_A_PORT  0
+#define PB          2
+#define PC          3
+#define PD          4
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+// Registre PINx du port: l'état de ses 8 broches, tenu à jour par le simulateur
+volatile uint8_t *portInputRegister(uint8_t port);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void noInterrupts();
+void interrupts();
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+#include "simulator.h"
+
+#endif /* Arduino_h */
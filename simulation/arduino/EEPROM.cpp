@@ -0,0 +1,73 @@
+#include "EEPROM.h"
+
+namespace sim {
+    void resetEeprom();
+}
+
+namespace {
+    const uint64_t EEPROM_WRITE_MICROS = 3400;
+
+    uint8_t eepromContent[EEPROM_SIZE];
+    unsigned long eepromWrites[EEPROM_SIZE];
+    uint64_t writeEnd = 0; // Temps simulé de la fin de l'écriture en cours
+
+    void waitReady() {
+        if(sim::getMicros() < writeEnd) {
+            sim::setMicros(writeEnd);
+        }
+    }
+}
+
+EEPROMClass EEPROM;
+
+//------------------------------------------------------------------------------------------------
+// Contrôle du simulateur
+
+void sim::resetEeprom() {
+    memset(eepromContent, 0xFF, sizeof(eepromContent));
+    memset(eepromWrites, 0, sizeof(eepromWrites));
+    writeEnd = 0;
+}
+
+unsigned long sim::getEepromWriteCount(int address) {
+    return address >= 0 && address < EEPROM_SIZE ? eepromWrites[address] : 0;
+}
+
+unsigned long sim::getEepromTotalWriteCount() {
+    unsigned long total = 0;
+    for(int i = 0; i < EEPROM_SIZE; i++) {
+        total += eepromWrites[i];
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------------------------
+// avr/eeprom.h
+
+bool eeprom_is_ready() {
+    return sim::getMicros() >= writeEnd;
+}
+
+//------------------------------------------------------------------------------------------------
+// EEPROMClass
+
+uint8_t EEPROMClass::read(int address) {
+    waitReady();
+    return address >= 0 && address < EEPROM_SIZE ? eepromContent[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if(address < 0 || address >= EEPROM_SIZE) {
+        return;
+    }
+    waitReady();
+    eepromContent[address] = value;
+    eepromWrites[address]++;
+    writeEnd = sim::getMicros() + EEPROM_WRITE_MICROS;
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+    if(read(address) != value) {
+        write(address, value);
+    }
+}
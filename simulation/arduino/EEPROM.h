@@ -0,0 +1,45 @@
+/*
+ * Librairie EEPROM de remplacement. La mémoire (1024 octets, comme sur le ATmega328P) garde son
+ * contenu quand le sketch redémarre (resetSketch()); seul sim::reset() l'efface à 0xFF, comme une
+ * puce neuve. Comme sur l'AVR, une écriture d'un octet se poursuit pendant 3,4 ms après son appel:
+ * une lecture ou une écriture faite avant la fin attend, ce qui fait avancer le temps simulé (voir
+ * eeprom_is_ready()). Chaque écriture est comptée (voir sim::getEepromWriteCount()).
+ */
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "Arduino.h"
+#include <avr/eeprom.h>
+
+#define EEPROM_SIZE  1024
+
+class EEPROMClass {
+    public:
+        uint8_t read(int address);
+        void write(int address, uint8_t value);
+        void update(int address, uint8_t value);
+        uint16_t length() { return EEPROM_SIZE; }
+
+        template <typename T>
+        T &get(int address, T &value) {
+            uint8_t *bytes = (uint8_t *)&value;
+            for(size_t i = 0; i < sizeof(T); i++) {
+                bytes[i] = read(address + i);
+            }
+            return value;
+        }
+
+        template <typename T>
+        const T &put(int address, const T &value) {
+            const uint8_t *bytes = (const uint8_t *)&value;
+            for(size_t i = 0; i < sizeof(T); i++) {
+                update(address + i, bytes[i]);
+            }
+            return value;
+        }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif /* EEPROM_h */
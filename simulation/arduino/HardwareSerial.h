@@ -0,0 +1,39 @@
+/*
+ * Port série de remplacement. Les octets transmis sont remis au simulateur (voir
+ * sim::setSerialListener) et, si demandé, affichés sur la sortie standard.
+ *
+ * Comme sur l'AVR, les octets passent par un tampon d'émission de SERIAL_TX_BUFFER_SIZE octets qui
+ * se vide à la vitesse du port (10 bits par octet): write() attend, en faisant avancer le temps
+ * simulé, quand le tampon est plein.
+ */
+
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include "Print.h"
+
+#define SERIAL_TX_BUFFER_SIZE  64
+
+class HardwareSerial : public Print {
+    public:
+        HardwareSerial();
+        void begin(unsigned long baudRate);
+        void end();
+        int available();
+        int read();
+        using Print::write;
+        size_t write(uint8_t value);
+        size_t write(const uint8_t *buffer, size_t size);
+        int availableForWrite();
+        void flush();
+        operator bool() const;
+
+    private:
+        bool _started;
+        double _byteMicros;     // Durée de l'émission d'un octet
+        double _sendEnd;        // Temps simulé (us) où le tampon d'émission sera vide
+};
+
+extern HardwareSerial Serial;
+
+#endif /* HardwareSerial_h */
@@ -0,0 +1,41 @@
+/*
+ * Classe de base Print de remplacement, partagée par le port série et les fichiers de la carte SD.
+ */
+
+#ifndef Print_h
+#define Print_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t value) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size);
+        size_t write(const char *str);
+
+        size_t print(const String &value);
+        size_t print(const char *value);
+        size_t print(const __FlashStringHelper *value);
+        size_t print(char value);
+        size_t print(int value);
+        size_t print(unsigned int value);
+        size_t print(long value);
+        size_t print(unsigned long value);
+        size_t print(double value, int digits = 2);
+
+        size_t println();
+        size_t println(const String &value);
+        size_t println(const char *value);
+        size_t println(const __FlashStringHelper *value);
+        size_t println(char value);
+        size_t println(int value);
+        size_t println(unsigned int value);
+        size_t println(long value);
+        size_t println(unsigned long value);
+        size_t println(double value, int digits = 2);
+};
+
+#endif /* Print_h */
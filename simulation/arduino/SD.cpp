@@ -0,0 +1,363 @@
+#include "SD.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sim {
+    void resetSd();
+}
+
+namespace {
+/*
+ * Modèle de latence de la librairie SD sur le bus SPI du Arduino Nano. La librairie possède une
+ * seule cache d'un bloc (512 octets) partagée entre les données, le répertoire et la FAT:
+ *    - un bloc complet et aligné est écrit directement sur la carte;
+ *    - une écriture partielle doit d'abord lire le bloc dans la cache (sauf pour un nouveau bloc
+ *      à la fin du fichier);
+ *    - un flush écrit la cache, puis lit et réécrit le bloc du répertoire qui contient la taille
+ *      du fichier, ce qui chasse le bloc de données de la cache;
+ *    - l'allocation d'une nouvelle grappe (cluster) lit la FAT et écrit ses deux copies.
+ * Chaque accès fait avancer le temps simulé. Une carte SD peut aussi bloquer une écriture
+ * pendant des centaines de ms pour sa gestion interne: sim::addSdWriteStall() reproduit ces pauses.
+ */
+    const uint32_t SD_BLOCK_SIZE          = 512;
+    const uint32_t SD_BLOCKS_PER_CLUSTER  = 64;
+    const uint32_t SD_ENTRIES_PER_BLOCK   = 16;
+    const uint64_t SD_BLOCK_READ_MICROS   = 1300;
+    const uint64_t SD_BLOCK_WRITE_MICROS  = 2000;
+
+    const char *const SD_DIRECTORY = "/";
+    const char *const SD_FAT       = "/FAT";
+
+    struct SdFileData {
+        std::vector<uint8_t> content;
+        uint32_t allocatedBlocks;
+    };
+
+    std::map<std::string, SdFileData> sdFiles;
+    std::string lastOpenedFile;
+    bool sdCardPresent = true;
+    bool sdStarted = false;
+    sim::SdStatistics statistics;
+
+    struct SdWriteStall {
+        uint64_t time;
+        uint64_t duration;
+    };
+    std::deque<SdWriteStall> writeStalls;
+
+    bool cacheValid = false;
+    bool cacheDirty = false;
+    std::string cacheOwner;
+    uint32_t cacheBlock = 0;
+
+    void readBlock() {
+        statistics.blockReads++;
+        sim::advanceMicros(SD_BLOCK_READ_MICROS);
+    }
+
+    void writeBlock() {
+        statistics.blockWrites++;
+        sim::advanceMicros(SD_BLOCK_WRITE_MICROS);
+        if(!writeStalls.empty() && sim::getMicros() >= writeStalls.front().time) {
+            sim::advanceMicros(writeStalls.front().duration);
+            writeStalls.pop_front();
+        }
+    }
+
+    void cacheFlush() {
+        if(cacheValid && cacheDirty) {
+            writeBlock();
+        }
+        cacheDirty = false;
+    }
+
+    void cacheLoad(const std::string &owner, uint32_t block, bool needRead) {
+        if(cacheValid && cacheOwner == owner && cacheBlock == block) {
+            return;
+        }
+        cacheFlush();
+        if(needRead) {
+            readBlock();
+        }
+        cacheValid = true;
+        cacheOwner = owner;
+        cacheBlock = block;
+    }
+
+    void scanDirectory() {
+        uint32_t blocks = sdFiles.size()/SD_ENTRIES_PER_BLOCK + 1;
+        for(uint32_t i = 0; i < blocks; i++) {
+            cacheLoad(SD_DIRECTORY, i, true);
+        }
+    }
+
+    void allocateCluster(SdFileData &file) {
+        cacheLoad(SD_FAT, 0, true);
+        writeBlock();
+        writeBlock();
+        file.allocatedBlocks += SD_BLOCKS_PER_CLUSTER;
+    }
+}
+
+SDClass SD;
+
+//------------------------------------------------------------------------------------------------
+// Contrôle du simulateur
+
+void sim::resetSd() {
+    sdFiles.clear();
+    lastOpenedFile.clear();
+    sdCardPresent = true;
+    sdStarted = false;
+    statistics = SdStatistics();
+    cacheValid = false;
+    cacheDirty = false;
+    writeStalls.clear();
+}
+
+void sim::addSdWriteStall(uint64_t time, uint64_t duration) {
+    SdWriteStall stall;
+    stall.time = time;
+    stall.duration = duration;
+    std::deque<SdWriteStall>::iterator position = writeStalls.begin();
+    while(position != writeStalls.end() && position->time <= time) {
+        ++position;
+    }
+    writeStalls.insert(position, stall);
+}
+
+void sim::setSdCardPresent(bool present) {
+    sdCardPresent = present;
+}
+
+bool sim::sdFileExists(const std::string &fileName) {
+    return sdFiles.count(fileName) != 0;
+}
+
+void sim::createSdFile(const std::string &fileName, size_t size) {
+    SdFileData &file = sdFiles[fileName];
+    file.content.assign(size, 0);
+    file.allocatedBlocks = (size + SD_BLOCK_SIZE*SD_BLOCKS_PER_CLUSTER - 1)/(SD_BLOCK_SIZE*SD_BLOCKS_PER_CLUSTER)*SD_BLOCKS_PER_CLUSTER;
+}
+
+std::string sim::getLastOpenedSdFile() {
+    return lastOpenedFile;
+}
+
+const std::vector<uint8_t> &sim::sdFileContent(const std::string &fileName) {
+    return sdFiles[fileName].content;
+}
+
+sim::SdStatistics sim::getSdStatistics() {
+    return statistics;
+}
+
+//------------------------------------------------------------------------------------------------
+// SDClass
+
+bool SDClass::begin(uint8_t) {
+    sdStarted = sdCardPresent;
+    if(sdStarted) {
+        // Lecture du MBR, du secteur de démarrage du volume et du premier bloc de la FAT
+        readBlock();
+        readBlock();
+        cacheLoad(SD_FAT, 0, true);
+    }
+    return sdStarted;
+}
+
+bool SDClass::exists(const char *filePath) {
+    if(!sdStarted) {
+        return false;
+    }
+    scanDirectory();
+    return sdFiles.count(filePath) != 0;
+}
+
+File SDClass::open(const char *filePath, uint8_t mode) {
+    if(!sdStarted) {
+        return File();
+    }
+    scanDirectory();
+    if(sdFiles.count(filePath) == 0) {
+        if(!(mode & O_CREAT)) {
+            return File();
+        }
+        sdFiles[filePath].allocatedBlocks = 0;
+        cacheDirty = true; // Nouvelle entrée dans le répertoire
+        cacheFlush();
+    }
+    else if(mode & O_EXCL) {
+        return File();
+    }
+    if(mode & O_WRITE) {
+        lastOpenedFile = filePath;
+    }
+    if((mode & (O_WRITE | O_TRUNC)) == (O_WRITE | O_TRUNC)) {
+        sdFiles[filePath].content.clear();
+        sdFiles[filePath].allocatedBlocks = 0;
+    }
+    return File(filePath, mode);
+}
+
+bool SDClass::remove(const char *filePath) {
+    if(!sdStarted) {
+        return false;
+    }
+    scanDirectory();
+    return sdFiles.erase(filePath) != 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// File
+
+File::File() : _mode(0), _position(0), _open(false), _modified(false) {}
+
+File::File(const char *name, uint8_t mode) : _name(name), _mode(mode), _position(0), _open(true), _modified(false) {
+/*
+ * Comme SDClass::open() de la librairie, O_APPEND place la position à la fin du fichier; sinon,
+ * elle est au début.
+ */
+    if(_mode & O_APPEND) {
+        _position = sdFiles[_name].content.size();
+    }
+}
+
+size_t File::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    if(!_open || !(_mode & O_WRITE)) {
+        return 0;
+    }
+    SdFileData &file = sdFiles[_name];
+    if(_mode & O_APPEND) {
+        _position = file.content.size(); // SdFile::write() appelle seekEnd()
+    }
+    size_t initialSize = file.content.size();
+    size_t written = 0;
+    while(written < size) {
+        uint32_t block = _position/SD_BLOCK_SIZE;
+        uint32_t offset = _position%SD_BLOCK_SIZE;
+        uint32_t chunk = SD_BLOCK_SIZE - offset;
+        if(chunk > size - written) {
+            chunk = size - written;
+        }
+        if(block >= file.allocatedBlocks) {
+            allocateCluster(file);
+        }
+        if(offset == 0 && chunk == SD_BLOCK_SIZE) {
+            if(cacheValid && cacheOwner == _name && cacheBlock == block) {
+                cacheValid = false;
+                cacheDirty = false;
+            }
+            writeBlock();
+        }
+        else {
+            bool newBlock = offset == 0 && _position >= file.content.size();
+            cacheLoad(_name, block, !newBlock);
+            cacheDirty = true;
+        }
+
+        if(_position + chunk > file.content.size()) {
+            file.content.resize(_position + chunk);
+        }
+        memcpy(&file.content[_position], &buffer[written], chunk);
+        _position += chunk;
+        written += chunk;
+    }
+    // Comme la librairie SD, l'entrée du répertoire n'est à réécrire que si la taille change: les
+    // écritures dans un fichier préalloué n'y touchent pas.
+    if(file.content.size() != initialSize) {
+        _modified = true;
+    }
+    statistics.bytesWritten += written;
+    return written;
+}
+
+int File::read() {
+    int value = peek();
+    if(value >= 0) {
+        _position++;
+    }
+    return value;
+}
+
+int File::peek() {
+    if(!_open || !(_mode & O_READ)) {
+        return -1;
+    }
+    SdFileData &file = sdFiles[_name];
+    if(_position >= file.content.size()) {
+        return -1;
+    }
+    cacheLoad(_name, _position/SD_BLOCK_SIZE, true);
+    return file.content[_position];
+}
+
+int File::available() {
+    return _open ? size() - _position : 0;
+}
+
+void File::flush() {
+/*
+ * Écrit la cache si elle contient des données, puis met à jour l'entrée du répertoire
+ * (lecture-modification-écriture du bloc du répertoire) si la taille du fichier a changé.
+ */
+    if(!_open) {
+        return;
+    }
+    cacheFlush();
+    if(_modified) {
+        cacheLoad(SD_DIRECTORY, 0, true);
+        cacheDirty = true;
+        cacheFlush();
+        _modified = false;
+    }
+    statistics.flushes++;
+}
+
+bool File::seek(uint32_t position) {
+/*
+ * Comme SdFile::seekSet(), la grappe de la nouvelle position est trouvée en suivant la chaîne de
+ * la FAT: depuis la grappe courante en avançant, depuis la première en reculant. Chaque pas lit
+ * la FAT dans la cache.
+ */
+    if(!_open || position > size()) {
+        return false;
+    }
+    const uint32_t clusterSize = SD_BLOCK_SIZE*SD_BLOCKS_PER_CLUSTER;
+    uint32_t currentCluster = _position > 0 ? (_position - 1)/clusterSize : 0;
+    uint32_t newCluster = position > 0 ? (position - 1)/clusterSize : 0;
+    uint32_t steps = newCluster < currentCluster || _position == 0 ? newCluster : newCluster - currentCluster;
+    if(steps > 0) {
+        cacheLoad(SD_FAT, 0, true);
+    }
+    _position = position;
+    return true;
+}
+
+uint32_t File::position() {
+    return _position;
+}
+
+uint32_t File::size() {
+    return _open ? sdFiles[_name].content.size() : 0;
+}
+
+void File::close() {
+    flush();
+    _open = false;
+}
+
+const char *File::name() {
+    return _name.c_str();
+}
+
+File::operator bool() {
+    return _open;
+}
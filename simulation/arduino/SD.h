@@ -0,0 +1,72 @@
+/*
+ * Librairie SD de remplacement. La carte est simulée en mémoire: chaque fichier est un vecteur
+ * d'octets que les outils hôtes peuvent relire avec sim::sdFileContent(). Les accès aux blocs de
+ * la carte font avancer le temps simulé (voir le modèle de latence dans SD.cpp).
+ */
+
+#ifndef __SD_H__
+#define __SD_H__
+
+#include "Arduino.h"
+
+// Drapeaux d'ouverture de la librairie SD (utility/SdFat.h). Comme dans la librairie 1.2, FILE_WRITE
+// contient O_APPEND: chaque écriture revient d'abord à la fin du fichier, même après seek(). Les
+// drapeaux de <fcntl.h> du même nom sont remplacés, comme sur le Arduino.
+#undef O_RDWR
+#undef O_APPEND
+#undef O_SYNC
+#undef O_CREAT
+#undef O_EXCL
+#undef O_TRUNC
+#define O_READ      0x01
+#define O_WRITE     0x02
+#define O_RDWR      (O_READ | O_WRITE)
+#define O_APPEND    0x04
+#define O_SYNC      0x08
+#define O_CREAT     0x10
+#define O_EXCL      0x20
+#define O_TRUNC     0x40
+
+#define FILE_READ   O_READ
+#define FILE_WRITE  (O_READ | O_WRITE | O_CREAT | O_APPEND)
+
+class File : public Print {
+    public:
+        File();
+        File(const char *name, uint8_t mode);
+        using Print::write;
+        size_t write(uint8_t value);
+        size_t write(const uint8_t *buffer, size_t size);
+        int read();
+        int peek();
+        int available();
+        void flush();
+        bool seek(uint32_t position);
+        uint32_t position();
+        uint32_t size();
+        void close();
+        const char *name();
+        operator bool();
+
+    private:
+        std::string _name;
+        uint8_t _mode;
+        uint32_t _position;
+        bool _open;
+        bool _modified;
+};
+
+class SDClass {
+    public:
+        bool begin(uint8_t chipSelectPin);
+        bool exists(const char *filePath);
+        bool exists(const String &filePath) { return exists(filePath.c_str()); }
+        File open(const char *filePath, uint8_t mode = FILE_READ);
+        File open(const String &filePath, uint8_t mode = FILE_READ) { return open(filePath.c_str(), mode); }
+        bool remove(const char *filePath);
+        bool remove(const String &filePath) { return remove(filePath.c_str()); }
+};
+
+extern SDClass SD;
+
+#endif /* __SD_H__ */
@@ -0,0 +1,19 @@
+/*
+ * Librairie SPI de remplacement. La carte SD simulée n'utilise pas le bus, seule l'interface
+ * est fournie pour que le code du déploiement compile.
+ */
+
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include "Arduino.h"
+
+class SPIClass {
+    public:
+        static void begin() {}
+        static void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif /* _SPI_H_INCLUDED */
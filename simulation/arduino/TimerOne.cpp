@@ -0,0 +1,44 @@
+#include "TimerOne.h"
+
+namespace sim {
+    void resetTimer();
+}
+
+TimerOne Timer1;
+
+void (*TimerOne::isrCallback)() = 0;
+
+//------------------------------------------------------------------------------------------------
+// Contrôle du simulateur
+
+void sim::resetTimer() {
+    Timer1.detachInterrupt();
+}
+
+void sim::fireTimerInterrupt() {
+    if(TimerOne::isrCallback) {
+        TimerOne::isrCallback();
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// TimerOne
+
+void TimerOne::initialize(unsigned long microseconds) {
+    _period = microseconds;
+}
+
+void TimerOne::attachInterrupt(void (*isr)(), unsigned long microseconds) {
+    if(microseconds > 0) {
+        _period = microseconds;
+    }
+    isrCallback = isr;
+}
+
+void TimerOne::detachInterrupt() {
+    isrCallback = 0;
+}
+
+unsigned long TimerOne::getPeriod() {
+    return _period;
+}
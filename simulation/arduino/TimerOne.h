@@ -0,0 +1,26 @@
+/*
+ * Librairie TimerOne de remplacement. L'interruption n'est jamais déclenchée par le temps
+ * simulé: c'est l'outil hôte qui l'appelle avec sim::fireTimerInterrupt().
+ */
+
+#ifndef TimerOne_h_
+#define TimerOne_h_
+
+#include "Arduino.h"
+
+class TimerOne {
+    public:
+        void initialize(unsigned long microseconds = 1000000);
+        void attachInterrupt(void (*isr)(), unsigned long microseconds = 0);
+        void detachInterrupt();
+        unsigned long getPeriod();
+
+        static void (*isrCallback)();
+
+    private:
+        unsigned long _period;
+};
+
+extern TimerOne Timer1;
+
+#endif /* TimerOne_h_ */
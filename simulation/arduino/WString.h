@@ -0,0 +1,66 @@
+/*
+ * Classe String de remplacement. Le formatage des nombres reproduit celui de la librairie
+ * Arduino (base 10 pour les entiers, 2 décimales par défaut pour les nombres réels).
+ *
+ * Les allocations du tas de la classe String du Arduino sont comptées (voir
+ * sim::getStringAllocationCount()): elle réserve exactement la longueur demandée, sans marge, et
+ * chaque chaîne construite ou agrandie appelle malloc() ou realloc().
+ */
+
+#ifndef String_class_h
+#define String_class_h
+
+#include <string>
+#include <avr/pgmspace.h>
+
+// Comme sur le Arduino, F() garde une chaîne constante dans la mémoire flash plutôt que dans la RAM
+// (voir avr/pgmspace.h); les chaînes ainsi marquées sont acceptées par String et Print.
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+class String {
+    public:
+        String(const char *cstr = "");
+        String(const __FlashStringHelper *str);
+        String(const String &value);
+        explicit String(char c);
+        explicit String(unsigned char value, unsigned char base = 10);
+        explicit String(int value, unsigned char base = 10);
+        explicit String(unsigned int value, unsigned char base = 10);
+        explicit String(long value, unsigned char base = 10);
+        explicit String(unsigned long value, unsigned char base = 10);
+        explicit String(float value, unsigned char decimalPlaces = 2);
+        explicit String(double value, unsigned char decimalPlaces = 2);
+        ~String();
+
+        String &operator=(const String &rhs);
+        String &operator=(const char *cstr);
+
+        String &operator+=(const String &rhs);
+        String &operator+=(const char *cstr);
+        String &operator+=(const __FlashStringHelper *str);
+        String &operator+=(char c);
+
+        bool operator==(const String &rhs) const;
+        bool operator==(const char *cstr) const;
+        bool operator!=(const String &rhs) const;
+        bool operator!=(const char *cstr) const;
+
+        unsigned int length() const;
+        const char *c_str() const;
+        char charAt(unsigned int index) const;
+
+    private:
+        std::string _buffer;
+        unsigned int _capacity;     // Capacité qu'aurait le tampon de la classe String du Arduino
+        bool _allocated;
+
+        void _reserve(unsigned int length);
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+String operator+(const String &lhs, char rhs);
+
+#endif /* String_class_h */
@@ -0,0 +1,105 @@
+#include "Wire.h"
+#include "i2cDevice.h"
+
+#include <vector>
+
+namespace {
+    std::vector<I2cDevice *> i2cDevices;
+
+    I2cDevice *findDevice(uint8_t address) {
+        for(size_t i = 0; i < i2cDevices.size(); i++) {
+            I2cDevice *device = i2cDevices[i]->find(address);
+            if(device) {
+                return device;
+            }
+        }
+        return 0;
+    }
+}
+
+TwoWire Wire;
+
+//------------------------------------------------------------------------------------------------
+// Contrôle du simulateur
+
+void sim::attachI2cDevice(I2cDevice *device) {
+    i2cDevices.push_back(device);
+}
+
+void sim::detachI2cDevices() {
+    i2cDevices.clear();
+}
+
+//------------------------------------------------------------------------------------------------
+// TwoWire
+
+TwoWire::TwoWire() : _clock(100000), _address(0), _txLength(0), _rxLength(0), _rxIndex(0) {}
+
+void TwoWire::begin() {
+    _clock = 100000;
+}
+
+void TwoWire::setClock(uint32_t clock) {
+    _clock = clock;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    _address = address;
+    _txLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+/*
+ * Codes de retour de la librairie Wire: 0 succès, 2 adresse non reconnue (NACK).
+ */
+    _chargeBusTime(_txLength + 1);
+    I2cDevice *device = findDevice(_address);
+    if(!device || !device->receive(_txBuffer, _txLength)) {
+        return 2;
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    if(quantity > WIRE_BUFFER_LENGTH) {
+        quantity = WIRE_BUFFER_LENGTH;
+    }
+    _rxIndex = 0;
+    _rxLength = 0;
+    _chargeBusTime(quantity + 1);
+    I2cDevice *device = findDevice(address);
+    if(!device || !device->transmit(_rxBuffer, quantity)) {
+        return 0;
+    }
+    _rxLength = quantity;
+    return quantity;
+}
+
+size_t TwoWire::write(uint8_t value) {
+    if(_txLength >= WIRE_BUFFER_LENGTH) {
+        return 0;
+    }
+    _txBuffer[_txLength++] = value;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+    size_t written = 0;
+    while(written < quantity && write(data[written])) {
+        written++;
+    }
+    return written;
+}
+
+int TwoWire::available() {
+    return _rxLength - _rxIndex;
+}
+
+int TwoWire::read() {
+    return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1;
+}
+
+void TwoWire::_chargeBusTime(size_t bytes) {
+    // 9 coups d'horloge par octet (8 bits et l'acquittement), plus le start et le stop
+    sim::advanceMicros((bytes*9 + 2) * 1000000ULL / _clock);
+}
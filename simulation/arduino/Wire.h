@@ -0,0 +1,41 @@
+/*
+ * Librairie Wire (I2C) de remplacement. Les transactions sont transmises aux périphériques
+ * simulés branchés sur le bus (voir i2cDevice.h) et font avancer le temps simulé selon la
+ * fréquence d'horloge du bus.
+ */
+
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include "Arduino.h"
+
+#define WIRE_BUFFER_LENGTH  32
+
+class TwoWire {
+    public:
+        TwoWire();
+        void begin();
+        void setClock(uint32_t clock);
+        void beginTransmission(uint8_t address);
+        uint8_t endTransmission(bool sendStop = true);
+        uint8_t requestFrom(uint8_t address, uint8_t quantity);
+        size_t write(uint8_t value);
+        size_t write(const uint8_t *data, size_t quantity);
+        int available();
+        int read();
+
+    private:
+        uint32_t _clock;
+        uint8_t _address;
+        uint8_t _txBuffer[WIRE_BUFFER_LENGTH];
+        uint8_t _txLength;
+        uint8_t _rxBuffer[WIRE_BUFFER_LENGTH];
+        uint8_t _rxLength;
+        uint8_t _rxIndex;
+
+        void _chargeBusTime(size_t bytes);
+};
+
+extern TwoWire Wire;
+
+#endif /* TwoWire_h */
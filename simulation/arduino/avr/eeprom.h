@@ -0,0 +1,14 @@
+/*
+ * Sur l'AVR, une écriture dans l'EEPROM dure 3,4 ms après le retour de EEPROM.write():
+ * eeprom_is_ready() indique que la précédente est terminée et qu'une lecture ou une écriture ne
+ * bloquera pas. Le simulateur suit la même durée (voir EEPROM.h).
+ */
+
+#ifndef eeprom_h
+#define eeprom_h
+
+#include <stdint.h>
+
+bool eeprom_is_ready();
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * Registres de l'AVR utilisés par main_deploiement. Seul MCUSR (cause du dernier redémarrage) est
+ * simulé: sim::reset() y met PORF, comme une mise sous tension, et sim::reboot() la cause demandée.
+ * Optiboot efface MCUSR et passe la cause dans le registre r2, que le sketch garde dans
+ * bootloaderResetFlags (voir main_deploiement.ino); sim::reboot() simule aussi cette variable.
+ */
+
+#ifndef io_h
+#define io_h
+
+#include <stdint.h>
+
+#define _BV(bit)  (1 << (bit))
+
+#define PORF   0    // Mise sous tension
+#define EXTRF  1    // Broche RESET
+#define BORF   2    // Baisse de tension (brown-out)
+#define WDRF   3    // Chien de garde
+
+extern volatile uint8_t MCUSR;
+extern uint8_t bootloaderResetFlags;
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * Sur l'AVR, les données PROGMEM restent dans la mémoire flash et sont lues avec pgm_read_*().
+ * Sur l'ordinateur hôte, la mémoire est unique: ce sont des lectures ordinaires.
+ */
+
+#ifndef pgmspace_h
+#define pgmspace_h
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+#define pgm_read_byte(address)   (*(const uint8_t *)(address))
+#define pgm_read_word(address)   (*(const uint16_t *)(address))
+#define pgm_read_dword(address)  (*(const uint32_t *)(address))
+#define pgm_read_float(address)  (*(const float *)(address))
+#define pgm_read_ptr(address)    (*(const void * const *)(address))
+
+#define memcpy_P  memcpy
+#define strcpy_P  strcpy
+#define strlen_P  strlen
+#define strncpy_P strncpy
+
+#endif
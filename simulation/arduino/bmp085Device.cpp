@@ -0,0 +1,291 @@
+#include "bmp085Device.h"
+#include "i2cMuxDevice.h"
+#include "Arduino.h"
+
+namespace sim {
+    void resetBarometer();
+}
+
+namespace {
+    // Coefficients de calibration de l'exemple de la fiche technique du BMP085
+    const int16_t AC1 = 408;
+    const int16_t AC2 = -72;
+    const int16_t AC3 = -14383;
+    const uint16_t AC4 = 32741;
+    const uint16_t AC5 = 32757;
+    const uint16_t AC6 = 23153;
+    const int16_t B1 = 6190;
+    const int16_t B2 = 4;
+    const int16_t MB = -32768;
+    const int16_t MC = -8711;
+    const int16_t MD = 2868;
+
+    const uint64_t TEMPERATURE_CONVERSION_MICROS = 4500;
+    const uint64_t PRESSURE_CONVERSION_MICROS[4] = {4500, 7500, 13500, 25500};
+
+    const uint8_t BAROMETER_COUNT = 2;
+
+    // Sans multiplexeur, seul le premier baromètre est sur le bus
+    SimulatedBmp085 barometers[BAROMETER_COUNT];
+    SimulatedI2cMux barometerMux;
+
+    void putWord(uint8_t *registers, uint8_t address, uint16_t value) {
+        registers[address] = value >> 8;
+        registers[address + 1] = value & 0xFF;
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// Contrôle du simulateur
+
+void sim::resetBarometer() {
+    for(uint8_t i = 0; i < BAROMETER_COUNT; i++) {
+        barometers[i].reset();
+    }
+    barometerMux = SimulatedI2cMux();
+    sim::detachI2cDevices();
+    sim::attachI2cDevice(&barometers[0]);
+}
+
+void sim::setBarometerMux(uint8_t firstChannel, uint8_t secondChannel) {
+    barometerMux = SimulatedI2cMux();
+    barometerMux.attach(firstChannel, &barometers[0]);
+    barometerMux.attach(secondChannel, &barometers[1]);
+    sim::detachI2cDevices();
+    sim::attachI2cDevice(&barometerMux);
+}
+
+void sim::setBarometerAltitude(float altitude) {
+    for(uint8_t i = 0; i < BAROMETER_COUNT; i++) {
+        barometers[i].setAltitude(altitude);
+    }
+}
+
+void sim::setBarometerAltitude(uint8_t barometer, float altitude) {
+    if(barometer < BAROMETER_COUNT) {
+        barometers[barometer].setAltitude(altitude);
+    }
+}
+
+void sim::setBarometerGroundPressure(int32_t groundPressure) {
+    for(uint8_t i = 0; i < BAROMETER_COUNT; i++) {
+        barometers[i].setGroundPressure(groundPressure);
+    }
+}
+
+void sim::setBarometerGroundPressure(uint8_t barometer, int32_t groundPressure) {
+    if(barometer < BAROMETER_COUNT) {
+        barometers[barometer].setGroundPressure(groundPressure);
+    }
+}
+
+void sim::setBarometerResponding(bool responding) {
+    for(uint8_t i = 0; i < BAROMETER_COUNT; i++) {
+        barometers[i].setResponding(responding);
+    }
+}
+
+void sim::setBarometerResponding(uint8_t barometer, bool responding) {
+    if(barometer < BAROMETER_COUNT) {
+        barometers[barometer].setResponding(responding);
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// SimulatedBmp085
+
+SimulatedBmp085::SimulatedBmp085(uint8_t address) {
+    _address = address;
+    reset();
+}
+
+void SimulatedBmp085::reset() {
+/*
+ * Remet le capteur dans son état de mise sous tension, sur place: copier un capteur temporaire
+ * copierait aussi ses membres pas encore initialisés (-Wuninitialized).
+ */
+    _responding = true;
+    _altitude = 0;
+    _groundPressure = 101325;
+    memset(_registers, 0, sizeof(_registers));
+    memset(_pendingData, 0, sizeof(_pendingData));
+    _registerPointer = 0;
+    _conversionPending = false;
+    _conversionEnd = 0;
+    _b5 = 0;
+    _lastPressureData = 0;
+
+    _registers[0xD0] = 0x55;
+    putWord(_registers, 0xAA, AC1);
+    putWord(_registers, 0xAC, AC2);
+    putWord(_registers, 0xAE, AC3);
+    putWord(_registers, 0xB0, AC4);
+    putWord(_registers, 0xB2, AC5);
+    putWord(_registers, 0xB4, AC6);
+    putWord(_registers, 0xB6, B1);
+    putWord(_registers, 0xB8, B2);
+    putWord(_registers, 0xBA, MB);
+    putWord(_registers, 0xBC, MC);
+    putWord(_registers, 0xBE, MD);
+}
+
+void SimulatedBmp085::setAltitude(float altitude) {
+    _altitude = altitude;
+}
+
+void SimulatedBmp085::setGroundPressure(int32_t groundPressure) {
+    _groundPressure = groundPressure;
+}
+
+void SimulatedBmp085::setResponding(bool responding) {
+    _responding = responding;
+}
+
+uint8_t SimulatedBmp085::getAddress() {
+    return _address;
+}
+
+bool SimulatedBmp085::receive(const uint8_t *data, size_t length) {
+    if(!_responding) {
+        return false;
+    }
+    if(length == 0) {
+        return true;
+    }
+    _registerPointer = data[0];
+    if(length >= 2 && _registerPointer == 0xF4) {
+        _startConversion(data[1]);
+    }
+    return true;
+}
+
+bool SimulatedBmp085::transmit(uint8_t *data, size_t length) {
+    if(!_responding) {
+        return false;
+    }
+    if(_conversionPending && sim::getMicros() >= _conversionEnd) {
+        memcpy(&_registers[0xF6], _pendingData, sizeof(_pendingData));
+        _conversionPending = false;
+    }
+    for(size_t i = 0; i < length; i++) {
+        data[i] = _registers[(uint8_t)(_registerPointer + i)];
+    }
+    return true;
+}
+
+void SimulatedBmp085::_startConversion(uint8_t command) {
+/*
+ * Cherche par dichotomie la valeur brute qui donne la température ou la pression voulue une
+ * fois compensée (les deux fonctions de compensation sont croissantes).
+ */
+    double temperature = 15.0 - 0.0065*_altitude;     // atmosphère standard, en degrés Celsius
+    double pressure = _groundPressure * pow(1.0 - _altitude/44330.0, 5.255);
+
+    if(command == 0x2E) {
+        int32_t target = (int32_t)lround(temperature*10);
+        int32_t low = 0;
+        int32_t high = 0xFFFF;
+        while(low < high) {
+            int32_t middle = (low + high)/2;
+            if(((_computeB5(middle) + 8) >> 4) < target) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        _b5 = _computeB5(low);
+        _pendingData[0] = low >> 8;
+        _pendingData[1] = low & 0xFF;
+        _pendingData[2] = 0;
+        _conversionEnd = sim::getMicros() + TEMPERATURE_CONVERSION_MICROS;
+    }
+    else if((command & 0x3F) == 0x34) {
+        uint8_t oversampling = command >> 6;
+        int32_t target = (int32_t)lround(pressure);
+        // Sous B3, le calcul non signé de la fiche technique déborde: la recherche commence à B3
+        int32_t low = _computeB3(oversampling) > 0 ? _computeB3(oversampling) : 0;
+        int32_t high = (1L << (16 + oversampling)) - 1;
+        _narrowSearch(_lastPressureData, target, oversampling, low, high);
+        while(low < high) {
+            int32_t middle = (low + high)/2;
+            if(_computePressure(middle, oversampling) < target) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        _lastPressureData = low;
+        uint32_t raw = (uint32_t)low << (8 - oversampling);
+        _pendingData[0] = (raw >> 16) & 0xFF;
+        _pendingData[1] = (raw >> 8) & 0xFF;
+        _pendingData[2] = raw & 0xFF;
+        _conversionEnd = sim::getMicros() + PRESSURE_CONVERSION_MICROS[oversampling];
+    }
+    else {
+        return;
+    }
+    _conversionPending = true;
+}
+
+void SimulatedBmp085::_narrowSearch(int32_t guess, int32_t target, uint8_t oversampling, int32_t &low, int32_t &high) {
+/*
+ * L'altitude change peu d'une mesure à l'autre: en partant de la valeur brute précédente, on
+ * double le pas jusqu'à encadrer la solution, ce qui réduit l'intervalle de la dichotomie. La
+ * solution reste la plus petite valeur brute qui donne au moins la pression voulue.
+ */
+    if(guess < low || guess > high) {
+        return;
+    }
+    int32_t step = 1;
+    if(_computePressure(guess, oversampling) < target) {
+        low = guess + 1;
+        while(low + step - 1 < high && _computePressure(low + step - 1, oversampling) < target) {
+            low += step;
+            step *= 2;
+        }
+        if(low + step - 1 < high) {
+            high = low + step - 1;
+        }
+    }
+    else {
+        high = guess;
+        while(high - step >= low && _computePressure(high - step, oversampling) >= target) {
+            high -= step;
+            step *= 2;
+        }
+        if(high - step + 1 > low) {
+            low = high - step + 1;
+        }
+    }
+}
+
+int32_t SimulatedBmp085::_computeB5(int32_t ut) {
+    int32_t x1 = ((ut - (int32_t)AC6) * (int32_t)AC5) >> 15;
+    int32_t x2 = ((int32_t)MC << 11) / (x1 + MD);
+    return x1 + x2;
+}
+
+int32_t SimulatedBmp085::_computeB3(uint8_t oversampling) {
+    int32_t b6 = _b5 - 4000;
+    int32_t x1 = ((int32_t)B2 * ((b6 * b6) >> 12)) >> 11;
+    int32_t x2 = ((int32_t)AC2 * b6) >> 11;
+    return ((((int32_t)AC1 * 4 + x1 + x2) << oversampling) + 2) / 4;
+}
+
+int32_t SimulatedBmp085::_computePressure(int32_t up, uint8_t oversampling) {
+    int32_t b6 = _b5 - 4000;
+    int32_t b3 = _computeB3(oversampling);
+    int32_t x1 = ((int32_t)AC3 * b6) >> 13;
+    int32_t x2, x3;
+    x2 = ((int32_t)B1 * ((b6 * b6) >> 12)) >> 16;
+    x3 = ((x1 + x2) + 2) >> 2;
+    uint32_t b4 = ((uint32_t)AC4 * (uint32_t)(x3 + 32768)) >> 15;
+    uint32_t b7 = ((uint32_t)up - b3) * (uint32_t)(50000UL >> oversampling);
+    int32_t p = b7 < 0x80000000 ? (b7 * 2) / b4 : (b7 / b4) * 2;
+    x1 = (p >> 8) * (p >> 8);
+    x1 = (x1 * 3038) >> 16;
+    x2 = (-7357 * p) >> 16;
+    return p + ((x1 + x2 + (int32_t)3791) >> 4);
+}
@@ -0,0 +1,50 @@
+/*
+ * BMP085/BMP180 simulé, branché sur le bus I2C de remplacement. Le capteur répond aux mêmes
+ * registres que le vrai: identifiant, coefficients de calibration (valeurs d'exemple de la
+ * fiche technique), registre de contrôle et registres de données. Les valeurs brutes UT et UP
+ * sont calculées en inversant les formules de compensation de la fiche technique pour que le
+ * pilote retrouve la pression correspondant à l'altitude imposée par le simulateur.
+ *
+ * Le résultat d'une conversion n'apparaît dans les registres de données qu'après la durée de
+ * conversion maximale: un pilote qui lit trop tôt relit l'ancienne valeur, comme sur le vrai
+ * capteur.
+ */
+
+#ifndef bmp085Device_h
+#define bmp085Device_h
+
+#include "i2cDevice.h"
+
+class SimulatedBmp085 : public I2cDevice {
+    public:
+        SimulatedBmp085(uint8_t address = 0x77);
+        void reset();
+        void setAltitude(float altitude);
+        void setGroundPressure(int32_t groundPressure);
+        void setResponding(bool responding);
+
+        uint8_t getAddress();
+        bool receive(const uint8_t *data, size_t length);
+        bool transmit(uint8_t *data, size_t length);
+
+    private:
+        uint8_t _address;
+        bool _responding;
+        float _altitude;
+        int32_t _groundPressure;
+        uint8_t _registers[256];
+        uint8_t _registerPointer;
+        uint8_t _pendingData[3];
+        bool _conversionPending;
+        uint64_t _conversionEnd;
+        int32_t _b5;
+        int32_t _lastPressureData;
+
+        void _startConversion(uint8_t command);
+        void _narrowSearch(int32_t guess, int32_t target, uint8_t oversampling, int32_t &low, int32_t &high);
+        int32_t _computeB5(int32_t ut);
+        int32_t _computeB3(uint8_t oversampling);
+        int32_t _computePressure(int32_t up, uint8_t oversampling);
+};
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * Périphérique simulé branché sur le bus I2C de remplacement.
+ */
+
+#ifndef i2cDevice_h
+#define i2cDevice_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+class I2cDevice {
+    public:
+        virtual ~I2cDevice() {}
+        virtual uint8_t getAddress() = 0;
+        // Octets écrits par le maître (le premier est habituellement le numéro de registre).
+        // Retourne false si le périphérique ne répond pas (NACK).
+        virtual bool receive(const uint8_t *data, size_t length) = 0;
+        // Octets lus par le maître. Retourne false si le périphérique ne répond pas.
+        virtual bool transmit(uint8_t *data, size_t length) = 0;
+        // Périphérique qui répond à address: lui-même, ou un périphérique derrière lui (multiplexeur).
+        virtual I2cDevice *find(uint8_t address) {
+            return getAddress() == address ? this : 0;
+        }
+};
+
+namespace sim {
+    void attachI2cDevice(I2cDevice *device);
+    void detachI2cDevices();
+}
+
+#endif
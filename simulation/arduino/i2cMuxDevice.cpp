@@ -0,0 +1,52 @@
+#include "i2cMuxDevice.h"
+
+SimulatedI2cMux::SimulatedI2cMux(uint8_t address) {
+    _address = address;
+    _control = 0;
+    for(uint8_t i = 0; i < I2C_MUX_CHANNELS; i++) {
+        _devices[i] = 0;
+    }
+}
+
+void SimulatedI2cMux::attach(uint8_t channel, I2cDevice *device) {
+    if(channel < I2C_MUX_CHANNELS) {
+        _devices[channel] = device;
+    }
+}
+
+uint8_t SimulatedI2cMux::getAddress() {
+    return _address;
+}
+
+bool SimulatedI2cMux::receive(const uint8_t *data, size_t length) {
+    if(length > 0) {
+        _control = data[0];
+    }
+    return true;
+}
+
+bool SimulatedI2cMux::transmit(uint8_t *data, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        data[i] = _control;
+    }
+    return true;
+}
+
+I2cDevice *SimulatedI2cMux::find(uint8_t address) {
+/*
+ * Si deux canaux choisis ont un périphérique à la même adresse, le premier répond (sur le vrai
+ * bus, les deux répondraient en même temps).
+ */
+    if(address == _address) {
+        return this;
+    }
+    for(uint8_t i = 0; i < I2C_MUX_CHANNELS; i++) {
+        if((_control & (1 << i)) && _devices[i]) {
+            I2cDevice *device = _devices[i]->find(address);
+            if(device) {
+                return device;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+/*
+ * Multiplexeur I2C TCA9548A simulé. Le registre de contrôle (un octet, un bit par canal) choisit
+ * les canaux reliés au bus principal: seuls les périphériques des canaux choisis répondent, ce qui
+ * permet de brancher deux capteurs qui ont la même adresse.
+ */
+
+#ifndef i2cMuxDevice_h
+#define i2cMuxDevice_h
+
+#include "i2cDevice.h"
+
+#define I2C_MUX_CHANNELS  8
+
+class SimulatedI2cMux : public I2cDevice {
+    public:
+        SimulatedI2cMux(uint8_t address = 0x70);
+        void attach(uint8_t channel, I2cDevice *device);
+
+        uint8_t getAddress();
+        bool receive(const uint8_t *data, size_t length);
+        bool transmit(uint8_t *data, size_t length);
+        I2cDevice *find(uint8_t address);
+
+    private:
+        uint8_t _address;
+        uint8_t _control;
+        I2cDevice *_devices[I2C_MUX_CHANNELS];
+};
+
+#endif
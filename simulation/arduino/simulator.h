@@ -0,0 +1,94 @@
+/*
+ * Points de contrôle du simulateur. Ces fonctions n'existent pas sur le Arduino: elles permettent
+ * aux outils hôtes de faire avancer le temps, de définir l'altitude vue par le baromètre, de
+ * déclencher l'interruption du Timer1 et d'observer les sorties du programme (broches, port série
+ * et fichiers de la carte SD).
+ */
+
+#ifndef simulator_h
+#define simulator_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace sim {
+    typedef void (*PinListener)(uint8_t pin, uint8_t value);
+    typedef void (*SerialListener)(const uint8_t *data, size_t size);
+
+    struct SdStatistics {
+        unsigned long blockReads;
+        unsigned long blockWrites;
+        unsigned long flushes;
+        unsigned long bytesWritten;
+    };
+
+    // Remet tout l'état simulé à zéro (temps, broches, port série, carte SD, baromètre).
+    void reset();
+
+    // Redémarre le Arduino sans couper le simulateur: millis() et micros() repartent de zéro, les
+    // sorties reviennent en entrées, le port série et le Timer1 s'arrêtent. La carte SD, l'EEPROM
+    // et le baromètre gardent leur état. resetFlags est la cause du redémarrage (PORF, BORF...):
+    // elle est dans MCUSR, ou, avec optiboot, MCUSR est effacé et elle est passée dans r2 comme le
+    // fait Optiboot (bootloaderResetFlags). L'appelant doit ensuite rappeler setup() (voir
+    // resetSketch()).
+    void reboot(uint8_t resetFlags, bool optiboot = false);
+
+    // Temps simulé, en micro-secondes depuis sim::reset(). millis() et micros() comptent depuis
+    // le dernier redémarrage.
+    void setMicros(uint64_t timeNow);
+    void advanceMicros(uint64_t delta);
+    uint64_t getMicros();
+
+    // Broches numériques.
+    void setPinListener(PinListener listener);
+    void setPinInput(uint8_t pin, uint8_t value);
+    uint8_t getPinOutput(uint8_t pin);
+    uint8_t getPinMode(uint8_t pin);
+
+    // Port série.
+    void setSerialListener(SerialListener listener);
+    void setSerialEcho(bool enabled);
+    // Octets que le programme lira avec Serial.read().
+    void sendSerialInput(const std::string &data);
+
+    // Baromètre (BMP085 simulé sur le bus I2C, voir bmp085Device.h): altitude réelle vue par le
+    // capteur par rapport à une pression au sol donnée. Sans numéro de baromètre, les fonctions
+    // s'appliquent aux deux baromètres simulés.
+    void setBarometerAltitude(float altitude);
+    void setBarometerAltitude(uint8_t barometer, float altitude);
+    void setBarometerGroundPressure(int32_t groundPressure);
+    void setBarometerGroundPressure(uint8_t barometer, int32_t groundPressure);
+    // Un baromètre qui ne répond plus refuse les transferts I2C (NACK), comme un capteur débranché.
+    void setBarometerResponding(bool responding);
+    void setBarometerResponding(uint8_t barometer, bool responding);
+    // Branche les deux baromètres (0 et 1) sur les canaux d'un multiplexeur TCA9548A simulé (voir
+    // i2cMuxDevice.h). Par défaut (et après reset()), seul le baromètre 0 est sur le bus.
+    void setBarometerMux(uint8_t firstChannel, uint8_t secondChannel);
+
+    // Timer1: appelle la routine d'interruption attachée par le programme.
+    void fireTimerInterrupt();
+
+    // Carte SD.
+    void setSdCardPresent(bool present);
+    // La première écriture de bloc faite au temps time (us) ou après dure duration us de plus.
+    void addSdWriteStall(uint64_t time, uint64_t duration);
+    bool sdFileExists(const std::string &fileName);
+    // Crée un fichier de size octets, comme ceux des vols précédents sur la carte.
+    void createSdFile(const std::string &fileName, size_t size);
+    // Dernier fichier ouvert en écriture par le programme.
+    std::string getLastOpenedSdFile();
+    const std::vector<uint8_t> &sdFileContent(const std::string &fileName);
+    SdStatistics getSdStatistics();
+
+    // Classe String: nombre de malloc() et realloc() qu'aurait fait la classe String du Arduino
+    // depuis sim::reset() (voir WString.h).
+    unsigned long getStringAllocationCount();
+
+    // EEPROM: nombre d'écritures d'un octet depuis sim::reset().
+    unsigned long getEepromWriteCount(int address);
+    unsigned long getEepromTotalWriteCount();
+}
+
+#endif /* simulator_h */
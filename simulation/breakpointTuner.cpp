@@ -0,0 +1,609 @@
+/*
+ * Recherche des breakpoints du plan de vol et des coefficients du filtre d'altitude sur des vols
+ * enregistrés (format alt_N.csv).
+ *
+ * Les historiques sont lus une seule fois. Pour chaque filtre candidat (le filtre actuel de
+ * configCircuitDeploiement.h et des filtres de Butterworth d'ordre ALTITUDE_FILTER_ORDER de
+ * différentes fréquences de coupure), l'altitude brute est refiltrée par IirFilter, le même code
+ * que sur le Arduino, et la vitesse verticale (m/s, sur les temps des échantillons) est gardée en
+ * mémoire. Chaque combinaison de breakpoints est ensuite évaluée sur ces traces en suivant les mêmes
+ * règles que followFlightPlan() (sans l'estimateur de Kalman), avec le même ApogeeDetector. Les combinaisons sont réparties sur tous les
+ * coeurs (voir parallel.h).
+ *
+ * La référence est l'altitude brute lissée par une moyenne mobile centrée: le décollage est le
+ * dernier échantillon sous TUNER_LAUNCH_ALTITUDE avant son maximum. L'apogée de référence est celle
+ * de findReplayApogee() (parabole ajustée), la même que pour apogeeBenchmark. Pour chaque
+ * combinaison, on mesure:
+ *     - le délai entre l'apogée de référence et la commande du drogue;
+ *     - le même délai sans la prédiction de l'apogée (APOGEE_PREDICTOR), par la seule descente
+ *       confirmée: sans lui, la prédiction cache le coût du délai de confirmation et le classement
+ *       l'allongerait sans limite;
+ *     - la marge sur la rampe: 1 - la plus grande fraction des deux seuils de décollage atteinte
+ *       avant le décollage (1: jamais approché, 0: déclenché);
+ *     - la marge à l'apogée: le délai de confirmation (BREAKPOINT_APOGEE_DELAY) moins le plus long
+ *       temps en descente vu par le détecteur avant l'apogée de référence, en ms, avec et sans la
+ *       prédiction;
+ *     - l'erreur d'altitude de référence à la commande du principal.
+ * Avec plusieurs vols, on garde le pire cas. Une combinaison est admissible si aucun
+ * déploiement n'est manqué ou prématuré, avec ou sans la prédiction, et si les marges atteignent
+ * TUNER_MIN_LAUNCH_MARGIN et TUNER_MIN_APOGEE_MARGIN. Les combinaisons admissibles sont classées
+ * par délai du drogue, puis par délai sans la prédiction, puis par erreur du principal, puis par
+ * marges; à égalité, celle qui change le moins de paramètres
+ * de la configuration actuelle passe devant.
+ *
+ * Avant la recherche, la configuration actuelle est vérifiée en rejouant chaque vol dans le
+ * sketch (voir flightReplay.h): les commandes du drogue doivent tomber au même échantillon.
+ *
+ * Utilisation: breakpointTuner [--jobs N] [--top N] [--main-altitude m] [--config fichier] vol.csv...
+ *     --jobs           nombre de processus (nombre de coeurs)
+ *     --top            nombre de combinaisons affichées (10)
+ *     --main-altitude  altitude visée pour le principal (BREAKPOINT_ALTITUDE_TO_DRIFT)
+ *     --config         écrit le fragment de configCircuitDeploiement.h de la meilleure
+ *                      combinaison dans ce fichier au lieu de l'afficher
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "flightReplay.h"
+#include "parallel.h"
+#include "configCircuitDeploiement.h"
+
+#define TUNER_REFERENCE_HALF_WIDTH  5     // échantillons, demi-largeur de la moyenne mobile de référence
+#define TUNER_LAUNCH_ALTITUDE       2.0   // m
+#define TUNER_MIN_LAUNCH_MARGIN     0.5
+#define TUNER_MIN_APOGEE_MARGIN     150   // ms, un peu moins de 2 échantillons
+
+namespace {
+    // Fréquences de coupure des filtres de Butterworth, normalisées par la fréquence de Nyquist
+    const double BUTTERWORTH_CUTOFFS[] = {0.05, 0.075, 0.1, 0.15, 0.2, 0.3};
+    const float SPEEDS_TO_BURNOUT[] = {10, 20, 30, 40, 50};               // m/s
+    const float ALTITUDES_TO_BURNOUT[] = {3, 6, 10, 15, 20};              // m
+    const float SPEEDS_TO_PRE_DROGUE[] = {10, 20, 30, 40, 50};            // m/s
+    const float DRIFT_OFFSETS[] = {0, 5, 10, 15, 20, 25, 30};             // m au-dessus de l'altitude visée
+    const uint16_t DELTA_TIMES_APOGEE[] = {100, 200, 300, 400, 500, 600, 700, 800}; // ms
+
+    template <typename T, size_t N>
+    size_t countOf(const T (&)[N]) {
+        return N;
+    }
+
+    struct FilterDesign {
+        char name[48];
+        float a[ALTITUDE_ARRAY_SIZE];
+        float b[ALTITUDE_ARRAY_SIZE];
+    };
+
+    struct Breakpoints {
+        uint8_t filter;
+        uint16_t deltaTimeApogee;   // ms
+        float speedToBurnout;
+        float altitudeToBurnout;
+        float speedToPreDrogue;
+        float altitudeToDrift;
+    };
+
+    struct Score {
+        uint8_t missed;          // un déploiement n'a pas eu lieu
+        uint8_t falseTrigger;    // décollage détecté sur la rampe ou drogue avant l'apogée
+        float launchMargin;
+        int16_t apogeeMargin;    // ms
+        float drogueDelay;       // ms
+        float confirmationDelay; // ms, délai du drogue sans la prédiction
+        float mainError;         // m
+    };
+
+    // Altitude filtrée et vitesse verticale d'un vol avec un filtre
+    struct Trace {
+        std::vector<float> altitude;
+        std::vector<float> verticalSpeed;
+    };
+
+    struct Flight {
+        std::string path;
+        std::vector<ReplaySample> samples;  // échantillons valides seulement
+        std::vector<float> reference;
+        size_t launch;
+        size_t peak;                        // maximum de la référence lissée
+        double apogeeTime;                  // ms, apogée de référence
+        double apogeeAltitude;              // m
+        double commandLatency;              // ms, de l'échantillon à la commande du sketch
+        std::vector<Trace> traces;          // une par filtre
+    };
+
+    struct Search {
+        std::vector<Flight> flights;
+        std::vector<FilterDesign> filters;
+        std::vector<Breakpoints> candidates;
+        float mainAltitude;
+    };
+
+    void printUsage() {
+        fprintf(stderr, "Utilisation: breakpointTuner [--jobs N] [--top N] [--main-altitude m] [--config fichier] vol.csv...\n");
+    }
+
+    FilterDesign designButterworth(double cutoff) {
+    /*
+     * Butterworth d'ordre 3, 1/((s + 1)(s² + s + 1)), transformé par la transformation bilinéaire
+     * avec précompensation de la fréquence de coupure (comme butter() de MatLab).
+     */
+        double k = tan(M_PI*cutoff/2);
+        double k2 = k*k;
+        double k3 = k2*k;
+        double a[4] = {1 + 2*k + 2*k2 + k3, -3 - 2*k + 2*k2 + 3*k3, 3 - 2*k - 2*k2 + 3*k3, -1 + 2*k - 2*k2 + k3};
+        double b[4] = {k3, 3*k3, 3*k3, k3};
+        FilterDesign design;
+        snprintf(design.name, sizeof(design.name), "Butterworth Wn = %.3f", cutoff);
+        for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
+            design.a[i] = a[i]/a[0];
+            design.b[i] = b[i]/a[0];
+        }
+        return design;
+    }
+
+    std::vector<FilterDesign> makeFilters() {
+        std::vector<FilterDesign> filters;
+        FilterDesign current;
+        snprintf(current.name, sizeof(current.name), "elliptique actuel");
+        memcpy(current.a, A, sizeof(current.a));
+        memcpy(current.b, B, sizeof(current.b));
+        filters.push_back(current);
+#if ALTITUDE_FILTER_ORDER == 3
+        for(size_t i = 0; i < countOf(BUTTERWORTH_CUTOFFS); i++) {
+            filters.push_back(designButterworth(BUTTERWORTH_CUTOFFS[i]));
+        }
+#endif
+        return filters;
+    }
+
+    std::vector<Breakpoints> makeCandidates(size_t filterCount, float mainAltitude) {
+        std::vector<Breakpoints> candidates;
+        Breakpoints candidate;
+        for(size_t f = 0; f < filterCount; f++)
+        for(size_t d = 0; d < countOf(DELTA_TIMES_APOGEE); d++)
+        for(size_t sb = 0; sb < countOf(SPEEDS_TO_BURNOUT); sb++)
+        for(size_t ab = 0; ab < countOf(ALTITUDES_TO_BURNOUT); ab++)
+        for(size_t sp = 0; sp < countOf(SPEEDS_TO_PRE_DROGUE); sp++)
+        for(size_t ad = 0; ad < countOf(DRIFT_OFFSETS); ad++) {
+            candidate.filter = f;
+            candidate.deltaTimeApogee = DELTA_TIMES_APOGEE[d];
+            candidate.speedToBurnout = SPEEDS_TO_BURNOUT[sb];
+            candidate.altitudeToBurnout = ALTITUDES_TO_BURNOUT[ab];
+            candidate.speedToPreDrogue = SPEEDS_TO_PRE_DROGUE[sp];
+            candidate.altitudeToDrift = mainAltitude + DRIFT_OFFSETS[ad];
+            candidates.push_back(candidate);
+        }
+        return candidates;
+    }
+
+    Breakpoints currentBreakpoints() {
+        Breakpoints current;
+        current.filter = 0;
+        current.deltaTimeApogee = BREAKPOINT_DELTA_TIME_APOGEE;
+        current.speedToBurnout = BREAKPOINT_SPEED_TO_BURNOUT;
+        current.altitudeToBurnout = BREAKPOINT_ALTITUDE_TO_BURNOUT;
+        current.speedToPreDrogue = BREAKPOINT_SPEED_TO_PRE_DROGUE;
+        current.altitudeToDrift = BREAKPOINT_ALTITUDE_TO_DRIFT;
+        return current;
+    }
+
+    bool loadFlight(const char *path, Flight &flight) {
+    /*
+     * Garde les échantillons que Rocket::updateAltitude() accepte et calcule la référence.
+     */
+        std::vector<ReplaySample> samples;
+        if(!loadReplaySamples(path, samples)) {
+            return false;
+        }
+        flight.path = path;
+        for(size_t i = 0; i < samples.size(); i++) {
+            if(samples[i].altitude >= FLIGHT_MINIMAL_ALTITUDE - ALTIMETER_INVALID_ALTITUDE_TOLERANCE &&
+               samples[i].altitude <= FLIGHT_MAXIMAL_ALTITUDE + ALTIMETER_INVALID_ALTITUDE_TOLERANCE) {
+                flight.samples.push_back(samples[i]);
+            }
+        }
+        size_t count = flight.samples.size();
+        flight.reference.resize(count);
+        flight.peak = 0;
+        for(size_t i = 0; i < count; i++) {
+            size_t first = i > TUNER_REFERENCE_HALF_WIDTH ? i - TUNER_REFERENCE_HALF_WIDTH : 0;
+            size_t last = std::min(i + TUNER_REFERENCE_HALF_WIDTH, count - 1);
+            double sum = 0;
+            for(size_t j = first; j <= last; j++) {
+                sum += flight.samples[j].altitude;
+            }
+            flight.reference[i] = sum/(last - first + 1);
+            if(flight.reference[i] > flight.reference[flight.peak]) {
+                flight.peak = i;
+            }
+        }
+        if(findReplayApogee(flight.samples, flight.apogeeTime, flight.apogeeAltitude)) {
+            flight.apogeeTime *= 1000;
+        }
+        else if(count > 0) {
+            flight.apogeeTime = flight.samples[flight.peak].timeStamp;
+            flight.apogeeAltitude = flight.reference[flight.peak];
+        }
+        flight.commandLatency = 0;
+        flight.launch = 0;
+        for(size_t i = flight.peak; i > 0; i--) {
+            if(flight.reference[i] <= TUNER_LAUNCH_ALTITUDE) {
+                flight.launch = i;
+                break;
+            }
+        }
+        return count > 0;
+    }
+
+    unsigned long sampleTime(const Flight &flight, long index) {
+    /*
+     * Temps d'un échantillon en us. Avant le premier, les temps continuent à la période nominale.
+     */
+        if(index < 0) {
+            return flight.samples[0].timeStamp*1000UL + index*(long)DATA_SAMPLING_PERIOD;
+        }
+        return flight.samples[index].timeStamp*1000UL;
+    }
+
+    void computeTraces(Flight &flight, const std::vector<FilterDesign> &filters) {
+    /*
+     * Même calcul que Rocket::_filterAltitude() et _calculateSpeed(). Les
+     * temps des ALTITUDE_FILTER_ORDER premiers échantillons passés sont espacés de la période
+     * nominale, comme au démarrage du Arduino.
+     */
+        flight.traces.resize(filters.size());
+        for(size_t f = 0; f < filters.size(); f++) {
+            int32_t a[ALTITUDE_ARRAY_SIZE];
+            int32_t b[ALTITUDE_ARRAY_SIZE];
+            for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
+                a[i] = iirFilterCoefficient(filters[f].a[i]/filters[f].a[0]);
+                b[i] = iirFilterCoefficient(filters[f].b[i]/filters[f].a[0]);
+            }
+            IirFilter<ALTITUDE_FILTER_ORDER> filter(a, b);
+            Trace &trace = flight.traces[f];
+            for(size_t i = 0; i < flight.samples.size(); i++) {
+                float altitude = filter.filter(flight.samples[i].altitude);
+                int32_t difference = filter.getOutput(0) - filter.getOutput(ALTITUDE_FILTER_ORDER);
+                unsigned long elapsedTime = sampleTime(flight, i) - sampleTime(flight, i - (long)ALTITUDE_FILTER_ORDER);
+                trace.altitude.push_back(altitude);
+                trace.verticalSpeed.push_back(IirFilter<ALTITUDE_FILTER_ORDER>::toFloat(difference)*1000000.0/elapsedTime);
+            }
+        }
+    }
+
+    Score evaluateFlight(const Flight &flight, const Breakpoints &breakpoints, float mainAltitude, bool prediction,
+                         size_t *drogueIndex) {
+    /*
+     * Suit le plan de vol échantillon par échantillon, comme followFlightPlan(): une étape
+     * commence à l'échantillon qui suit la transition. Sans prediction, l'apogée n'est détecté que
+     * par la descente confirmée.
+     */
+        Score score = Score();
+        const Trace &trace = flight.traces[breakpoints.filter];
+        size_t count = flight.samples.size();
+        size_t i = 0;
+
+        float launchRatio = 0;
+        for(; i < count; i++) {
+            float speed = fabsf(trace.verticalSpeed[i]);
+            if(speed > breakpoints.speedToBurnout && trace.altitude[i] > breakpoints.altitudeToBurnout) {
+                break;
+            }
+            if(i < flight.launch) {
+                float ratio = std::min(speed/breakpoints.speedToBurnout, trace.altitude[i]/breakpoints.altitudeToBurnout);
+                launchRatio = std::max(launchRatio, ratio);
+            }
+        }
+        if(i < flight.launch) {
+            score.falseTrigger = 1;
+            launchRatio = 1;
+        }
+        score.launchMargin = 1 - launchRatio;
+
+        for(i++; i < count && fabsf(trace.verticalSpeed[i]) >= breakpoints.speedToPreDrogue; i++) {
+        }
+
+        unsigned long apogeeDelay = breakpoints.deltaTimeApogee*1000UL - DATA_SAMPLING_PERIOD/2;
+        unsigned long worstApogeeTime = 0;
+        ApogeeDetector detector;
+        detector.init(apogeeDelay, APOGEE_SPEED_HYSTERESIS, prediction ? APOGEE_SPEED_LAG*1000UL : 0);
+        for(i++; i < count; i++) {
+            if(detector.update(trace.verticalSpeed[i], sampleTime(flight, i) - sampleTime(flight, i - 1))) {
+                break;
+            }
+            if(flight.samples[i].timeStamp < flight.apogeeTime) {
+                worstApogeeTime = std::max(worstApogeeTime, detector.getDescentTime());
+            }
+        }
+        if(drogueIndex) {
+            *drogueIndex = i;
+        }
+        if(i >= count) {
+            score.missed = 1;
+            return score;
+        }
+        double commandTime = flight.samples[i].timeStamp + flight.commandLatency;
+        if(commandTime < flight.apogeeTime) {
+            score.falseTrigger = 1;
+            worstApogeeTime = apogeeDelay;
+        }
+        score.apogeeMargin = ((long)apogeeDelay - (long)worstApogeeTime)/1000;
+        score.drogueDelay = commandTime - flight.apogeeTime;
+        score.confirmationDelay = score.drogueDelay;
+
+        for(i++; i < count && trace.altitude[i] >= breakpoints.altitudeToDrift; i++) {
+        }
+        if(i >= count) {
+            score.missed = 1;
+            return score;
+        }
+        score.mainError = flight.reference[i] - mainAltitude;
+        return score;
+    }
+
+    Score evaluateBothPaths(const Flight &flight, const Breakpoints &breakpoints, float mainAltitude) {
+    /*
+     * Plan de vol avec la prédiction de la configuration, puis par la seule descente confirmée.
+     */
+        Score score = evaluateFlight(flight, breakpoints, mainAltitude, APOGEE_PREDICTOR, 0);
+        if(!APOGEE_PREDICTOR) {
+            return score;
+        }
+        Score confirmation = evaluateFlight(flight, breakpoints, mainAltitude, false, 0);
+        score.missed |= confirmation.missed;
+        score.falseTrigger |= confirmation.falseTrigger;
+        score.apogeeMargin = std::min(score.apogeeMargin, confirmation.apogeeMargin);
+        score.confirmationDelay = confirmation.drogueDelay;
+        return score;
+    }
+
+    Score evaluate(const Search &search, const Breakpoints &breakpoints) {
+    /*
+     * Pire cas sur tous les vols.
+     */
+        Score worst = Score();
+        for(size_t f = 0; f < search.flights.size(); f++) {
+            Score score = evaluateBothPaths(search.flights[f], breakpoints, search.mainAltitude);
+            if(f == 0) {
+                worst = score;
+                continue;
+            }
+            worst.missed |= score.missed;
+            worst.falseTrigger |= score.falseTrigger;
+            worst.launchMargin = std::min(worst.launchMargin, score.launchMargin);
+            worst.apogeeMargin = std::min(worst.apogeeMargin, score.apogeeMargin);
+            worst.drogueDelay = std::max(worst.drogueDelay, score.drogueDelay);
+            worst.confirmationDelay = std::max(worst.confirmationDelay, score.confirmationDelay);
+            if(fabsf(score.mainError) > fabsf(worst.mainError)) {
+                worst.mainError = score.mainError;
+            }
+        }
+        return worst;
+    }
+
+    void evaluateTask(uint32_t index, void *result, void *context) {
+        const Search &search = *(const Search *)context;
+        *(Score *)result = evaluate(search, search.candidates[index]);
+    }
+
+    bool isAdmissible(const Score &score) {
+        return !score.missed && !score.falseTrigger && score.launchMargin >= TUNER_MIN_LAUNCH_MARGIN &&
+               score.apogeeMargin >= TUNER_MIN_APOGEE_MARGIN;
+    }
+
+    bool isBetter(const Score &a, const Score &b) {
+        if(isAdmissible(a) != isAdmissible(b)) {
+            return isAdmissible(a);
+        }
+        if(a.drogueDelay != b.drogueDelay) {
+            return a.drogueDelay < b.drogueDelay;
+        }
+        if(a.confirmationDelay != b.confirmationDelay) {
+            return a.confirmationDelay < b.confirmationDelay;
+        }
+        if(fabsf(a.mainError) != fabsf(b.mainError)) {
+            return fabsf(a.mainError) < fabsf(b.mainError);
+        }
+        if(a.apogeeMargin != b.apogeeMargin) {
+            return a.apogeeMargin > b.apogeeMargin;
+        }
+        return a.launchMargin > b.launchMargin;
+    }
+
+    int countChanges(const Breakpoints &breakpoints) {
+        Breakpoints current = currentBreakpoints();
+        return (breakpoints.filter != current.filter) + (breakpoints.deltaTimeApogee != current.deltaTimeApogee) +
+               (breakpoints.speedToBurnout != current.speedToBurnout) + (breakpoints.altitudeToBurnout != current.altitudeToBurnout) +
+               (breakpoints.speedToPreDrogue != current.speedToPreDrogue) + (breakpoints.altitudeToDrift != current.altitudeToDrift);
+    }
+
+    struct CandidateOrder {
+        const std::vector<Score> *scores;
+        const std::vector<Breakpoints> *candidates;
+        bool operator()(uint32_t a, uint32_t b) const {
+            if(isBetter((*scores)[a], (*scores)[b])) {
+                return true;
+            }
+            if(isBetter((*scores)[b], (*scores)[a])) {
+                return false;
+            }
+            return countChanges((*candidates)[a]) < countChanges((*candidates)[b]);
+        }
+    };
+
+    void printCandidate(const char *rank, const Search &search, const Breakpoints &breakpoints, const Score &score) {
+        printf("%5s  %-22s %6.0f %6.0f %6.0f %6d %6.0f  %8.0f %8.0f %7.2f %6d %8.1f%s\n", rank,
+               search.filters[breakpoints.filter].name, breakpoints.speedToBurnout, breakpoints.altitudeToBurnout,
+               breakpoints.speedToPreDrogue, breakpoints.deltaTimeApogee, breakpoints.altitudeToDrift,
+               score.drogueDelay, score.confirmationDelay, score.launchMargin, score.apogeeMargin, score.mainError,
+               score.missed ? "  manqué" : (score.falseTrigger ? "  prématuré" : (isAdmissible(score) ? "" : "  marge")));
+    }
+
+    void writeConfig(FILE *file, const Search &search, const Breakpoints &breakpoints, const Score &score) {
+        const FilterDesign &filter = search.filters[breakpoints.filter];
+        fprintf(file, "// Généré par breakpointTuner à partir de:");
+        for(size_t i = 0; i < search.flights.size(); i++) {
+            fprintf(file, " %s", search.flights[i].path.c_str());
+        }
+        fprintf(file, "\n// Délai du drogue %.0f ms (%.0f ms sans la prédiction), marge sur la rampe %.2f, marge à\n",
+                score.drogueDelay, score.confirmationDelay, score.launchMargin);
+        fprintf(file, "// l'apogée %d ms,", score.apogeeMargin);
+        fprintf(file, " erreur d'altitude du principal %.1f m. Filtre: %s.\n\n", score.mainError, filter.name);
+        fprintf(file, "constexpr float A[ALTITUDE_ARRAY_SIZE] = {\n");
+        for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
+            fprintf(file, "    %.15f%s  // A%d\n", filter.a[i], i < ALTITUDE_ARRAY_SIZE - 1 ? "," : " ", i);
+        }
+        fprintf(file, "};\n\nconstexpr float B[ALTITUDE_ARRAY_SIZE] = {\n");
+        for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
+            fprintf(file, "    %.15f%s  // B%d\n", filter.b[i], i < ALTITUDE_ARRAY_SIZE - 1 ? "," : " ", i);
+        }
+        fprintf(file, "};\n\n");
+        fprintf(file, "#define BREAKPOINT_SPEED_TO_BURNOUT     %g\n", breakpoints.speedToBurnout);
+        fprintf(file, "#define BREAKPOINT_SPEED_TO_PRE_DROGUE  %g\n", breakpoints.speedToPreDrogue);
+        fprintf(file, "#define BREAKPOINT_ALTITUDE_TO_BURNOUT  %g\n", breakpoints.altitudeToBurnout);
+        fprintf(file, "#define BREAKPOINT_ALTITUDE_TO_DRIFT    %g\n", breakpoints.altitudeToDrift);
+        fprintf(file, "#define BREAKPOINT_DELTA_TIME_APOGEE    %d\n", breakpoints.deltaTimeApogee);
+    }
+
+    bool verifyWithReplay(Flight &flight) {
+    /*
+     * Le modèle du plan de vol doit commander le drogue au même échantillon que le sketch. Le
+     * sketch commande pendant le traitement de l'échantillon, donc un peu après son temps: ce
+     * retard est gardé pour comparer la commande, et non l'échantillon, à l'apogée de référence,
+     * comme apogeeBenchmark.
+     */
+        size_t drogueIndex;
+        evaluateFlight(flight, currentBreakpoints(), BREAKPOINT_ALTITUDE_TO_DRIFT, APOGEE_PREDICTOR, &drogueIndex);
+        FlightReplay replay;
+        replay.run(flight.samples);
+        const std::vector<ReplayEvent> &events = replay.getEvents();
+        for(size_t i = 0; i < events.size(); i++) {
+            if(events[i].type == REPLAY_EVENT_PARACHUTE && events[i].description == "drogue command") {
+                bool same = drogueIndex < flight.samples.size() && events[i].timeStamp >= flight.samples[drogueIndex].timeStamp &&
+                            events[i].timeStamp < flight.samples[drogueIndex].timeStamp + DATA_SAMPLING_PERIOD/1000;
+                if(same) {
+                    flight.commandLatency = events[i].timeStamp - flight.samples[drogueIndex].timeStamp;
+                }
+                printf("    vérification: drogue du sketch à %lu ms, du modèle à %lu ms: %s\n", events[i].timeStamp,
+                       drogueIndex < flight.samples.size() ? flight.samples[drogueIndex].timeStamp : 0UL,
+                       same ? "OK" : "DIFFÉRENT");
+                return same;
+            }
+        }
+        printf("    vérification: le sketch n'a pas commandé le drogue\n");
+        return drogueIndex >= flight.samples.size();
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned jobs = getProcessorCount();
+    size_t top = 10;
+    const char *configPath = 0;
+    Search search;
+    search.mainAltitude = BREAKPOINT_ALTITUDE_TO_DRIFT;
+    std::vector<const char *> paths;
+
+    for(int i = 1; i < argc; i++) {
+        if(argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        }
+        else if(i + 1 >= argc) {
+            printUsage();
+            return 2;
+        }
+        else if(strcmp(argv[i], "--jobs") == 0) {
+            jobs = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--top") == 0) {
+            top = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--main-altitude") == 0) {
+            search.mainAltitude = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--config") == 0) {
+            configPath = argv[++i];
+        }
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if(paths.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    search.filters = makeFilters();
+    bool verified = true;
+    for(size_t i = 0; i < paths.size(); i++) {
+        Flight flight;
+        if(!loadFlight(paths[i], flight)) {
+            fprintf(stderr, "Impossible de lire %s\n", paths[i]);
+            return 1;
+        }
+        computeTraces(flight, search.filters);
+        printf("%s: %zu échantillons, décollage à %lu ms, apogée de %.1f m à %.0f ms\n", paths[i],
+               flight.samples.size(), flight.samples[flight.launch].timeStamp, flight.apogeeAltitude, flight.apogeeTime);
+        verified &= verifyWithReplay(flight);
+        search.flights.push_back(flight);
+    }
+
+    search.candidates = makeCandidates(search.filters.size(), search.mainAltitude);
+    std::vector<Score> scores(search.candidates.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if(!runParallel(search.candidates.size(), jobs, sizeof(Score), scores.data(), evaluateTask, &search)) {
+        fprintf(stderr, "Échec d'un processus de recherche\n");
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<uint32_t> ranking(scores.size());
+    size_t admissible = 0;
+    for(uint32_t i = 0; i < ranking.size(); i++) {
+        ranking[i] = i;
+        admissible += isAdmissible(scores[i]);
+    }
+    CandidateOrder order = {&scores, &search.candidates};
+    std::stable_sort(ranking.begin(), ranking.end(), order);
+
+    Score currentScore = evaluate(search, currentBreakpoints());
+    size_t currentRank = 0;
+    while(currentRank < ranking.size() && isBetter(scores[ranking[currentRank]], currentScore)) {
+        currentRank++;
+    }
+
+    printf("%zu combinaisons évaluées en %.2f s sur %u processus, %zu admissibles\n\n", scores.size(), elapsed, jobs, admissible);
+    printf("%5s  %-22s %6s %6s %6s %6s %6s  %8s %8s %7s %6s %8s\n", "rang", "filtre", "v.burn", "a.burn", "v.drog",
+           "apogée", "drift", "délai ms", "confirm.", "m.rampe", "m.apo", "err. m");
+    for(size_t i = 0; i < top && i < ranking.size(); i++) {
+        char rank[16];
+        snprintf(rank, sizeof(rank), "%zu", i + 1);
+        printCandidate(rank, search, search.candidates[ranking[i]], scores[ranking[i]]);
+    }
+    char rank[16];
+    snprintf(rank, sizeof(rank), "%zu", currentRank + 1);
+    printf("Configuration actuelle:\n");
+    printCandidate(rank, search, currentBreakpoints(), currentScore);
+    printf("\n");
+
+    if(ranking.empty() || !isAdmissible(scores[ranking[0]])) {
+        printf("Aucune combinaison admissible\n");
+        return 1;
+    }
+    FILE *config = configPath ? fopen(configPath, "w") : stdout;
+    if(!config) {
+        fprintf(stderr, "Impossible d'écrire %s\n", configPath);
+        return 1;
+    }
+    writeConfig(config, search, search.candidates[ranking[0]], scores[ranking[0]]);
+    if(configPath) {
+        fclose(config);
+        printf("Fragment de configuration écrit dans %s\n", configPath);
+    }
+    return verified ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+/*
+ * Compare le filtre d'altitude en virgule fixe (IirFilter, iirFilter.h) au calcul en float qu'il
+ * remplace, sur la colonne d'altitude brute d'un historique de vol. Le calcul de référence est
+ * celui de Rocket avant IirFilter (FloatAltitudeFilter, floatAltitudeFilter.h).
+ *
+ * L'écart maximal toléré sur l'altitude filtrée et sur la vitesse est de 1 cm (1 cm/ech), la
+ * résolution de l'historique de vol. Le programme retourne 1 si la tolérance est dépassée.
+ *
+ * Utilisation: filterCompare vol.csv
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "flightLog.h"
+#include "floatAltitudeFilter.h"
+
+#define FILTER_COMPARE_TOLERANCE  0.01 // m
+
+int main(int argc, char **argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Utilisation: filterCompare vol.csv\n");
+        return 2;
+    }
+    std::vector<FlightLogRecord> records;
+    if(!readFlightLog(argv[1], records)) {
+        fprintf(stderr, "Impossible de lire %s\n", argv[1]);
+        return 2;
+    }
+
+    typedef IirFilter<ALTITUDE_FILTER_ORDER> AltitudeFilter;
+    FloatAltitudeFilter reference;
+    AltitudeFilter fixedPoint(ALTITUDE_FILTER_A, ALTITUDE_FILTER_B);
+    double worstAltitudeError = 0;
+    double worstSpeedError = 0;
+    unsigned long worstTimeStamp = 0;
+    unsigned long sampleCount = 0;
+
+    for(size_t i = 0; i < records.size(); i++) {
+        if(records[i].id != ID_LOG_DATA) {
+            continue;
+        }
+        float expected = reference.filter(records[i].rawAltitude);
+        float actual = fixedPoint.filter(records[i].rawAltitude);
+        float speed = fabsf(AltitudeFilter::toFloat(fixedPoint.getOutput(0) - fixedPoint.getOutput(ALTITUDE_FILTER_ORDER))/ALTITUDE_FILTER_ORDER);
+
+        double altitudeError = fabs((double)actual - expected);
+        double speedError = fabs((double)speed - reference.getSpeed());
+        if(altitudeError > worstAltitudeError) {
+            worstAltitudeError = altitudeError;
+            worstTimeStamp = records[i].timeStamp;
+        }
+        if(speedError > worstSpeedError) {
+            worstSpeedError = speedError;
+        }
+        sampleCount++;
+    }
+
+    printf("%lu échantillons filtrés\n", sampleCount);
+    printf("Altitude filtrée: écart maximal %.6f m (à %lu ms)\n", worstAltitudeError, worstTimeStamp);
+    printf("Vitesse:          écart maximal %.6f m/ech\n", worstSpeedError);
+    if(sampleCount == 0 || worstAltitudeError > FILTER_COMPARE_TOLERANCE || worstSpeedError > FILTER_COMPARE_TOLERANCE) {
+        printf("ÉCHEC: tolérance de %.2f m dépassée\n", FILTER_COMPARE_TOLERANCE);
+        return 1;
+    }
+    printf("OK: écarts sous la tolérance de %.2f m\n", FILTER_COMPARE_TOLERANCE);
+    return 0;
+}
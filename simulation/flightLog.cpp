@@ -0,0 +1,100 @@
+#include "flightLog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+    bool parseLine(const char *line, size_t length, FlightLogRecord &record) {
+    /*
+     * Découpe une ligne en champs séparés par des virgules. Les tableurs ajoutent souvent une
+     * virgule finale et des fins de ligne Windows, on les tolère. Le message est le dernier champ
+     * d'une ligne d'évènement, après les colonnes de l'estimateur s'il y en a.
+     */
+        std::string fields[9];
+        int fieldCount = 0;
+        size_t start = 0;
+        while(length > 0 && (line[length-1] == '\r' || line[length-1] == '\n')) {
+            length--;
+        }
+        for(size_t i = 0; i <= length && fieldCount < 9; i++) {
+            if(i == length || line[i] == ',') {
+                fields[fieldCount++].assign(line + start, i - start);
+                start = i + 1;
+            }
+        }
+        if(fieldCount < 1 || fields[0].empty()) {
+            return false;
+        }
+
+        char *end;
+        record.id = strtol(fields[0].c_str(), &end, 10);
+        if(*end != '\0') {
+            return false;
+        }
+        record.timeStamp = 0;
+        record.rawAltitude = 0;
+        record.filteredAltitude = 0;
+        record.speed = 0;
+        record.hasEstimate = false;
+        record.estimatedAltitude = 0;
+        record.verticalSpeed = 0;
+        record.acceleration = 0;
+        record.message.clear();
+        if(record.id == 0) {
+            record.message = fieldCount > 1 ? std::string(line, length).substr(fields[0].size() + 1) : "";
+            return true;
+        }
+        if(fieldCount < 5) {
+            return false;
+        }
+        record.timeStamp = strtoul(fields[1].c_str(), &end, 10);
+        record.rawAltitude = strtof(fields[2].c_str(), &end);
+        record.filteredAltitude = strtof(fields[3].c_str(), &end);
+        record.speed = strtof(fields[4].c_str(), &end);
+        if(fieldCount >= 8 && !fields[5].empty()) {
+            record.estimatedAltitude = strtof(fields[5].c_str(), &end);
+            record.hasEstimate = *end == '\0';
+        }
+        if(record.hasEstimate) {
+            record.verticalSpeed = strtof(fields[6].c_str(), &end);
+            record.acceleration = strtof(fields[7].c_str(), &end);
+            if(fieldCount > 8) {
+                record.message = fields[8];
+            }
+        }
+        else if(fieldCount > 5) {
+            record.message = fields[5];
+        }
+        return true;
+    }
+}
+
+void parseFlightLog(const char *text, size_t size, std::vector<FlightLogRecord> &records) {
+    size_t lineStart = 0;
+    for(size_t i = 0; i <= size; i++) {
+        if(i == size || text[i] == '\n') {
+            FlightLogRecord record;
+            if(i > lineStart && parseLine(text + lineStart, i - lineStart, record)) {
+                records.push_back(record);
+            }
+            lineStart = i + 1;
+        }
+    }
+}
+
+bool readFlightLog(const std::string &path, std::vector<FlightLogRecord> &records) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if(!file) {
+        return false;
+    }
+    std::vector<char> content;
+    char buffer[65536];
+    size_t n;
+    while((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.insert(content.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    parseFlightLog(content.empty() ? "" : &content[0], content.size(), records);
+    return true;
+}
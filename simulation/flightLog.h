@@ -0,0 +1,34 @@
+/*
+ * Lecture des fichiers d'historique de vol écrits par Rocket (alt_N.csv). Chaque ligne a la forme
+ *     id,timeStamp,rawAltitude,filteredAltitude,speed,message
+ * où id vaut ID_LOG_MESSAGE, ID_LOG_DATA ou ID_LOG_EVENT. Avec l'estimateur de Kalman, les colonnes
+ *     estimatedAltitude,verticalSpeed,acceleration
+ * sont insérées avant le message.
+ */
+
+#ifndef flightLog_h
+#define flightLog_h
+
+#include <string>
+#include <vector>
+
+struct FlightLogRecord {
+    int id;
+    unsigned long timeStamp;
+    float rawAltitude;
+    float filteredAltitude;
+    float speed;
+    bool hasEstimate;
+    float estimatedAltitude;
+    float verticalSpeed;
+    float acceleration;
+    std::string message;
+};
+
+// Retourne false si le fichier ne peut pas être ouvert. Les lignes mal formées sont ignorées.
+bool readFlightLog(const std::string &path, std::vector<FlightLogRecord> &records);
+
+// Lit un historique de vol déjà chargé en mémoire (par exemple, un fichier de la carte SD simulée).
+void parseFlightLog(const char *text, size_t size, std::vector<FlightLogRecord> &records);
+
+#endif
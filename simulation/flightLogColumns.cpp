@@ -0,0 +1,225 @@
+#include "flightLogColumns.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "configCircuitDeploiement.h"
+
+#define FLIGHT_LOG_HEADER  "timeStamp,"
+
+namespace {
+    const uint64_t POWERS_OF_TEN[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+    };
+    const double EXACT_POWERS_OF_TEN[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+        1e17, 1e18, 1e19
+    };
+    const unsigned MAX_DIGITS = 19;
+
+    uint64_t convertEightDigits(uint64_t digits) {
+    /*
+     * Huit chiffres (0 à 9, un par octet, le plus significatif dans l'octet de poids faible):
+     * on additionne les paires, puis les groupes de quatre, puis les deux moitiés.
+     */
+        digits = (digits*10 + (digits >> 8)) & 0x00FF00FF00FF00FFULL;
+        digits = (digits*100 + (digits >> 16)) & 0x0000FFFF0000FFFFULL;
+        return (digits*10000 + (digits >> 32)) & 0xFFFFFFFFULL;
+    }
+
+    unsigned scanDigits(const char *&p, const char *end, uint64_t &value) {
+    /*
+     * Lit une suite de chiffres et retourne leur nombre. Tant qu'il reste au moins 8 octets, un
+     * mot entier est testé: un octet est un chiffre si son quartet haut vaut 3 avant et après
+     * l'ajout de 6. Le premier octet qui n'est pas un chiffre donne le nombre de chiffres du mot.
+     */
+        value = 0;
+        unsigned count = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while(end - p >= 8 && count + 8 <= MAX_DIGITS) {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            uint64_t nonDigits = ((word & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) |
+                                 (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL);
+            unsigned n = nonDigits ? __builtin_ctzll(nonDigits)/8 : 8;
+            if(n > 0) {
+                // Les chiffres sont poussés vers les octets de poids fort: les octets libérés
+                // deviennent des zéros en tête du nombre.
+                uint64_t digits = (word & 0x0F0F0F0F0F0F0F0FULL) << (8*(8 - n));
+                value = value*POWERS_OF_TEN[n] + convertEightDigits(digits);
+                p += n;
+                count += n;
+            }
+            if(n < 8) {
+                return count;
+            }
+        }
+#endif
+        while(p < end && *p >= '0' && *p <= '9' && count < MAX_DIGITS) {
+            value = value*10 + (*p - '0');
+            p++;
+            count++;
+        }
+        return count;
+    }
+
+    bool scanUnsigned(const char *&p, const char *end, uint32_t &value) {
+        uint64_t digits;
+        if(scanDigits(p, end, digits) == 0) {
+            return false;
+        }
+        value = (uint32_t)digits;
+        return true;
+    }
+
+    bool scanDecimal(const char *&p, const char *end, float &value) {
+    /*
+     * Nombre décimal écrit par String(float): signe, partie entière, point et décimales. Les
+     * chiffres forment un entier divisé par une puissance de 10 exacte, ce qui donne le même
+     * arrondi que strtof() pour les nombres de l'historique.
+     */
+        bool negative = p < end && *p == '-';
+        if(negative) {
+            p++;
+        }
+        uint64_t mantissa;
+        unsigned digits = scanDigits(p, end, mantissa);
+        unsigned fractionDigits = 0;
+        if(p < end && *p == '.') {
+            p++;
+            uint64_t fraction;
+            fractionDigits = scanDigits(p, end, fraction);
+            if(digits + fractionDigits > MAX_DIGITS) {
+                return false;
+            }
+            mantissa = mantissa*POWERS_OF_TEN[fractionDigits] + fraction;
+            digits += fractionDigits;
+        }
+        double result = mantissa/EXACT_POWERS_OF_TEN[fractionDigits];
+        value = (float)(negative ? -result : result);
+        return digits > 0;
+    }
+
+    bool expect(const char *&p, const char *end, char c) {
+        if(p < end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    const char *trimLine(const char *lineStart, const char *lineEnd) {
+        while(lineEnd > lineStart && (lineEnd[-1] == '\r' || lineEnd[-1] == '\n')) {
+            lineEnd--;
+        }
+        return lineEnd;
+    }
+
+    void parseLine(const char *p, const char *lineEnd, FlightLogColumns &columns) {
+        uint32_t id;
+        if(!scanUnsigned(p, lineEnd, id)) {
+            return;
+        }
+        if(id == ID_LOG_MESSAGE) {
+            const char *end = trimLine(p, lineEnd);
+            if(expect(p, end, ',') && strncmp(p, FLIGHT_LOG_HEADER, strlen(FLIGHT_LOG_HEADER)) != 0) {
+                columns.messages.push_back(std::string(p, end - p));
+            }
+            return;
+        }
+
+        uint32_t timeStamp;
+        float rawAltitude, filteredAltitude, speed;
+        if(!expect(p, lineEnd, ',') || !scanUnsigned(p, lineEnd, timeStamp) ||
+           !expect(p, lineEnd, ',') || !scanDecimal(p, lineEnd, rawAltitude) ||
+           !expect(p, lineEnd, ',') || !scanDecimal(p, lineEnd, filteredAltitude) ||
+           !expect(p, lineEnd, ',') || !scanDecimal(p, lineEnd, speed)) {
+            return;
+        }
+        if(id == ID_LOG_DATA) {
+            columns.timeStamp.push_back(timeStamp);
+            columns.rawAltitude.push_back(rawAltitude);
+            columns.filteredAltitude.push_back(filteredAltitude);
+            columns.speed.push_back(speed);
+        }
+        else if(id == ID_LOG_EVENT) {
+            // Le message est le dernier champ, avant l'éventuelle virgule finale.
+            const char *end = trimLine(p, lineEnd);
+            if(end > p && end[-1] == ',') {
+                end--;
+            }
+            const char *start = end;
+            while(start > p && start[-1] != ',') {
+                start--;
+            }
+            FlightLogEvent event;
+            event.dataIndex = columns.timeStamp.size();
+            event.timeStamp = timeStamp;
+            event.rawAltitude = rawAltitude;
+            event.filteredAltitude = filteredAltitude;
+            event.speed = speed;
+            event.message.assign(start, end - start);
+            columns.events.push_back(event);
+        }
+    }
+}
+
+void FlightLogColumns::clear() {
+    timeStamp.clear();
+    rawAltitude.clear();
+    filteredAltitude.clear();
+    speed.clear();
+    events.clear();
+    messages.clear();
+}
+
+void parseFlightLogColumns(const char *text, size_t size, FlightLogColumns &columns) {
+    const char *end = text + size;
+    const char *p = text;
+    columns.clear();
+    // Une ligne de données fait environ 28 octets: on réserve les colonnes une seule fois.
+    size_t expected = size/24 + 1;
+    columns.timeStamp.reserve(expected);
+    columns.rawAltitude.reserve(expected);
+    columns.filteredAltitude.reserve(expected);
+    columns.speed.reserve(expected);
+    while(p < end) {
+        const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+        if(!lineEnd) {
+            lineEnd = end;
+        }
+        parseLine(p, lineEnd, columns);
+        p = lineEnd + 1;
+    }
+}
+
+bool mapFlightLog(const std::string &path, FlightLogColumns &columns) {
+    int file = open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        return false;
+    }
+    struct stat status;
+    if(fstat(file, &status) < 0) {
+        close(file);
+        return false;
+    }
+    if(status.st_size == 0) {
+        close(file);
+        columns.clear();
+        return true;
+    }
+    void *text = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if(text == MAP_FAILED) {
+        return false;
+    }
+    madvise(text, status.st_size, MADV_SEQUENTIAL);
+    parseFlightLogColumns((const char *)text, status.st_size, columns);
+    munmap(text, status.st_size);
+    return true;
+}
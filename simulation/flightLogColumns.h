@@ -0,0 +1,46 @@
+/*
+ * Lecture rapide des historiques de vol texte (alt_N.csv, voir flightLog.h) en colonnes.
+ *
+ * Le fichier est projeté en mémoire (mmap) au lieu d'être copié, et les nombres sont lus sans
+ * découper la ligne en chaînes: les chiffres sont reconnus et convertis huit à la fois dans un
+ * mot de 64 bits (SWAR). Les lignes de données (ID_LOG_DATA) sont rangées en colonnes; les
+ * évènements et les messages, beaucoup plus rares, sont gardés à part avec leur texte.
+ *
+ * Les colonnes de l'estimateur de Kalman sont ignorées. Comme pour readFlightLog(), les lignes
+ * mal formées sont ignorées et les fins de ligne Windows et les virgules finales sont tolérées.
+ */
+
+#ifndef flightLogColumns_h
+#define flightLogColumns_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct FlightLogEvent {
+    size_t dataIndex;        // nombre de lignes de données avant l'évènement
+    uint32_t timeStamp;      // ms
+    float rawAltitude;
+    float filteredAltitude;
+    float speed;
+    std::string message;
+};
+
+struct FlightLogColumns {
+    std::vector<uint32_t> timeStamp;     // ms
+    std::vector<float> rawAltitude;      // m
+    std::vector<float> filteredAltitude; // m
+    std::vector<float> speed;            // m/s (m/ech dans les anciens historiques, comme vol_2017.csv)
+    std::vector<FlightLogEvent> events;
+    std::vector<std::string> messages;   // lignes ID_LOG_MESSAGE, sans l'en-tête des colonnes
+
+    void clear();
+};
+
+// Retourne false si le fichier ne peut pas être ouvert ou projeté en mémoire.
+bool mapFlightLog(const std::string &path, FlightLogColumns &columns);
+
+void parseFlightLogColumns(const char *text, size_t size, FlightLogColumns &columns);
+
+#endif
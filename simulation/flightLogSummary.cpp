@@ -0,0 +1,126 @@
+#include "flightLogSummary.h"
+
+#include "configCircuitDeploiement.h"
+
+namespace {
+    int findEvent(const FlightLogColumns &columns, const char *message) {
+        for(size_t i = 0; i < columns.events.size(); i++) {
+            if(columns.events[i].message == message) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    float descentRate(const FlightLogColumns &columns, size_t first, size_t last) {
+    /*
+     * Pente de la droite des moindres carrés de l'altitude filtrée en fonction du temps, avec
+     * le signe changé (une descente donne une vitesse positive).
+     */
+        if(last <= first + 1) {
+            return 0;
+        }
+        double origin = columns.timeStamp[first];
+        double sumT = 0, sumA = 0, sumTT = 0, sumTA = 0;
+        size_t count = last - first;
+        for(size_t i = first; i < last; i++) {
+            double t = (columns.timeStamp[i] - origin)/1000.0;
+            double a = columns.filteredAltitude[i];
+            sumT += t;
+            sumA += a;
+            sumTT += t*t;
+            sumTA += t*a;
+        }
+        double denominator = count*sumTT - sumT*sumT;
+        return denominator > 0 ? -(count*sumTA - sumT*sumA)/denominator : 0;
+    }
+}
+
+FlightLogSummary summarizeFlightLog(const FlightLogColumns &columns) {
+    FlightLogSummary summary = FlightLogSummary();
+    size_t count = columns.timeStamp.size();
+    summary.samples = count;
+    summary.events = columns.events.size();
+    summary.launchTime = -1;
+    summary.apogeeTime = -1;
+    summary.mainTime = -1;
+    summary.landingTime = -1;
+    for(size_t i = 0; i < columns.events.size(); i++) {
+        summary.invalidAltitudes += columns.events[i].message == MESSAGE_INVALID_ALTITUDE;
+    }
+    if(count == 0) {
+        return summary;
+    }
+
+    summary.duration = (columns.timeStamp[count-1] - columns.timeStamp[0])/1000.0f;
+    summary.minInterval = count > 1 ? 1e9f : 0;
+    uint32_t gapInterval = DATA_SAMPLING_PERIOD*3/2000;
+    size_t apogee = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(i > 0) {
+            uint32_t interval = columns.timeStamp[i] - columns.timeStamp[i-1];
+            if(interval < summary.minInterval) {
+                summary.minInterval = interval;
+            }
+            if(interval > summary.maxInterval) {
+                summary.maxInterval = interval;
+            }
+            summary.gaps += interval > gapInterval;
+        }
+        if(columns.filteredAltitude[i] > columns.filteredAltitude[apogee]) {
+            apogee = i;
+        }
+    }
+    summary.meanInterval = count > 1 ? summary.duration*1000/(count - 1) : 0;
+    summary.apogeeTime = columns.timeStamp[apogee]/1000.0f;
+    summary.apogeeAltitude = columns.filteredAltitude[apogee];
+
+    int launchEvent = findEvent(columns, MESSAGE_BURNOUT_STARTED);
+    if(launchEvent >= 0) {
+        summary.launchTime = columns.events[launchEvent].timeStamp/1000.0f;
+    }
+    else {
+        for(size_t i = apogee; i > 0; i--) {
+            if(columns.filteredAltitude[i] <= BREAKPOINT_ALTITUDE_TO_BURNOUT) {
+                summary.launchTime = columns.timeStamp[i]/1000.0f;
+                break;
+            }
+        }
+    }
+    if(summary.launchTime >= 0) {
+        summary.timeToApogee = summary.apogeeTime - summary.launchTime;
+    }
+
+    size_t main = count;
+    int mainEvent = findEvent(columns, MESSAGE_MAIN_OUT);
+    if(mainEvent >= 0 && columns.events[mainEvent].dataIndex > apogee) {
+        main = columns.events[mainEvent].dataIndex;
+    }
+    else {
+        for(size_t i = apogee; i < count; i++) {
+            if(columns.filteredAltitude[i] < BREAKPOINT_ALTITUDE_TO_DRIFT) {
+                main = i;
+                break;
+            }
+        }
+    }
+    size_t landing = count;
+    for(size_t i = main; i < count; i++) {
+        if(columns.filteredAltitude[i] < LOG_SUMMARY_LANDING_ALTITUDE) {
+            landing = i;
+            break;
+        }
+    }
+    if(mainEvent >= 0 && main == columns.events[mainEvent].dataIndex) {
+        summary.mainTime = columns.events[mainEvent].timeStamp/1000.0f;
+    }
+    else if(main < count) {
+        summary.mainTime = columns.timeStamp[main]/1000.0f;
+    }
+    if(landing < count) {
+        summary.landingTime = columns.timeStamp[landing]/1000.0f;
+    }
+    summary.drogueRate = descentRate(columns, apogee, main);
+    summary.mainRate = descentRate(columns, main, landing);
+    return summary;
+}
@@ -0,0 +1,44 @@
+/*
+ * Résumé d'un vol lu par mapFlightLog() (voir flightLogColumns.h).
+ *
+ * Le décollage est l'évènement "burnout started" ou, à défaut, le dernier échantillon sous
+ * BREAKPOINT_ALTITUDE_TO_BURNOUT avant l'apogée. L'apogée est le maximum de l'altitude filtrée.
+ * La descente est coupée en deux phases: sous le drogue, de l'apogée à l'évènement "main out"
+ * (ou, à défaut, au passage sous BREAKPOINT_ALTITUDE_TO_DRIFT), puis sous le principal jusqu'à
+ * l'atterrissage (premier échantillon sous LOG_SUMMARY_LANDING_ALTITUDE). La vitesse de descente
+ * de chaque phase est la pente de la droite des moindres carrés de l'altitude filtrée.
+ *
+ * Les temps sont en secondes depuis le démarrage du Arduino; un temps négatif veut dire que
+ * l'étape n'a pas été trouvée.
+ */
+
+#ifndef flightLogSummary_h
+#define flightLogSummary_h
+
+#include <stdint.h>
+#include "flightLogColumns.h"
+
+#define LOG_SUMMARY_LANDING_ALTITUDE  10.0 // m
+
+struct FlightLogSummary {
+    uint32_t samples;
+    uint32_t events;
+    uint32_t invalidAltitudes;
+    float duration;          // s, du premier au dernier échantillon
+    float meanInterval;      // ms, entre deux échantillons
+    float minInterval;       // ms
+    float maxInterval;       // ms
+    uint32_t gaps;           // intervalles de plus de 1,5 période d'échantillonnage
+    float launchTime;
+    float apogeeTime;
+    float apogeeAltitude;    // m
+    float timeToApogee;      // s
+    float mainTime;
+    float landingTime;
+    float drogueRate;        // m/s, vitesse de descente sous le drogue
+    float mainRate;          // m/s, vitesse de descente sous le principal
+};
+
+FlightLogSummary summarizeFlightLog(const FlightLogColumns &columns);
+
+#endif
@@ -0,0 +1,197 @@
+#include "flightModel.h"
+
+#include <math.h>
+
+// Plages des paramètres tirés au hasard pour chaque vol
+#define FLIGHT_MODEL_PAD_TIME       3.0, 10.0      // s
+#define FLIGHT_MODEL_BURN_TIME      1.5, 3.5       // s
+#define FLIGHT_MODEL_THRUST         50.0, 110.0    // m/s²
+#define FLIGHT_MODEL_BODY_DRAG      1.5e-4, 4.0e-4 // 1/m
+#define FLIGHT_MODEL_DROGUE_RATE    20.0, 30.0     // m/s
+#define FLIGHT_MODEL_MAIN_RATE      5.0, 8.0       // m/s
+#define FLIGHT_MODEL_OPENING_DELAY  0.3, 1.0       // s
+
+#define FLIGHT_MODEL_GRAVITY        9.81   // m/s²
+#define FLIGHT_MODEL_SOUND_SPEED    340.0  // m/s
+#define FLIGHT_MODEL_TIME_STEP      0.01   // s, pas d'intégration
+#define FLIGHT_MODEL_SPIKE_WIDTH    0.04   // largeur en Mach de la pointe transsonique
+
+//------------------------------------------------------------------------------------------------
+// Random (xorshift64*, initialisé par splitmix64)
+
+Random::Random(uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    _state = z ^ (z >> 31);
+    if(_state == 0) {
+        _state = 1;
+    }
+}
+
+uint64_t Random::next() {
+    _state ^= _state >> 12;
+    _state ^= _state << 25;
+    _state ^= _state >> 27;
+    return _state * 0x2545F4914F6CDD1DULL;
+}
+
+double Random::uniform() {
+    return (next() >> 11) * (1.0/9007199254740992.0);
+}
+
+double Random::uniform(double low, double high) {
+    return low + (high - low)*uniform();
+}
+
+double Random::gaussian() {
+    // Box-Muller; 1 - uniform() n'est jamais nul.
+    return sqrt(-2*log(1 - uniform())) * cos(2*M_PI*uniform());
+}
+
+//------------------------------------------------------------------------------------------------
+// FlightProfile
+
+FlightProfile FlightProfile::draw(Random &random) {
+    FlightProfile profile;
+    profile.padTime = random.uniform(FLIGHT_MODEL_PAD_TIME);
+    profile.burnTime = random.uniform(FLIGHT_MODEL_BURN_TIME);
+    profile.thrust = random.uniform(FLIGHT_MODEL_THRUST);
+    profile.bodyDrag = random.uniform(FLIGHT_MODEL_BODY_DRAG);
+    profile.drogueRate = random.uniform(FLIGHT_MODEL_DROGUE_RATE);
+    profile.mainRate = random.uniform(FLIGHT_MODEL_MAIN_RATE);
+    profile.openingDelay = random.uniform(FLIGHT_MODEL_OPENING_DELAY);
+    return profile;
+}
+
+//------------------------------------------------------------------------------------------------
+// FlightModel
+
+FlightModel::FlightModel(const FlightProfile &profile) : _profile(profile) {
+    _time = 0;
+    _altitude = 0;
+    _speed = 0;
+    _drag = profile.bodyDrag;
+    _drogueOpening = -1;
+    _mainOpening = -1;
+    _apogeeReached = false;
+    _apogeeTime = 0;
+    _apogeeAltitude = 0;
+}
+
+void FlightModel::advance(double duration) {
+    double end = _time + duration;
+    // Rien ne bouge sur la rampe avant l'allumage.
+    if(_time < _profile.padTime) {
+        _time = end < _profile.padTime ? end : _profile.padTime;
+    }
+    while(_time + FLIGHT_MODEL_TIME_STEP <= end) {
+        _step(FLIGHT_MODEL_TIME_STEP);
+    }
+    if(end > _time) {
+        _step(end - _time);
+    }
+}
+
+void FlightModel::deployDrogue() {
+    if(_drogueOpening < 0) {
+        _drogueOpening = _time + _profile.openingDelay;
+    }
+}
+
+void FlightModel::deployMain() {
+    if(_mainOpening < 0) {
+        _mainOpening = _time + _profile.openingDelay;
+    }
+}
+
+void FlightModel::_step(double dt) {
+/*
+ * Intégration d'Euler semi-implicite. La fusée reste sur la rampe jusqu'à l'allumage et
+ * s'arrête au sol à l'atterrissage.
+ */
+    double burnTime = _time - _profile.padTime;
+    _time += dt;
+    if(burnTime < 0 || hasLanded()) {
+        return;
+    }
+
+    if(_mainOpening >= 0 && _time >= _mainOpening) {
+        _drag = FLIGHT_MODEL_GRAVITY/(_profile.mainRate*_profile.mainRate);
+    }
+    else if(_drogueOpening >= 0 && _time >= _drogueOpening) {
+        _drag = FLIGHT_MODEL_GRAVITY/(_profile.drogueRate*_profile.drogueRate);
+    }
+
+    double acceleration = -FLIGHT_MODEL_GRAVITY - _drag*_speed*fabs(_speed);
+    if(burnTime < _profile.burnTime) {
+        acceleration += _profile.thrust;
+    }
+    double previousSpeed = _speed;
+    _speed += acceleration*dt;
+    _altitude += _speed*dt;
+    if(_altitude < 0) {
+        _altitude = 0;
+    }
+
+    if(!_apogeeReached && previousSpeed > 0 && _speed <= 0) {
+        _apogeeReached = true;
+        _apogeeTime = _time;
+        _apogeeAltitude = _altitude;
+    }
+}
+
+double FlightModel::getTime() const {
+    return _time;
+}
+
+double FlightModel::getAltitude() const {
+    return _altitude;
+}
+
+double FlightModel::getVerticalSpeed() const {
+    return _speed;
+}
+
+double FlightModel::getMach() const {
+    return fabs(_speed)/FLIGHT_MODEL_SOUND_SPEED;
+}
+
+bool FlightModel::hasLanded() const {
+    return _apogeeReached && _altitude <= 0;
+}
+
+bool FlightModel::apogeeReached() const {
+    return _apogeeReached;
+}
+
+double FlightModel::getApogeeTime() const {
+    return _apogeeTime;
+}
+
+double FlightModel::getApogeeAltitude() const {
+    return _apogeeAltitude;
+}
+
+//------------------------------------------------------------------------------------------------
+// SensorModel
+
+SensorModel::SensorModel(const SensorOptions &options) : _options(options), _dropoutRemaining(0) {}
+
+double SensorModel::measure(const FlightModel &flight, Random &random) {
+    double mach = (flight.getMach() - 1)/FLIGHT_MODEL_SPIKE_WIDTH;
+    double spike = _options.transonicSpike*exp(-mach*mach);
+    return flight.getAltitude() + _options.noise*random.gaussian() - spike;
+}
+
+bool SensorModel::nextSampleResponds(Random &random) {
+    if(_dropoutRemaining > 0) {
+        _dropoutRemaining--;
+        return false;
+    }
+    if(_options.maxDropout > 0 && random.uniform() < _options.dropoutRate) {
+        _dropoutRemaining = (unsigned)(random.next() % _options.maxDropout);
+        return false;
+    }
+    return true;
+}
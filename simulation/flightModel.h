@@ -0,0 +1,101 @@
+/*
+ * Modèle de vol synthétique pour les simulations de Monte Carlo.
+ *
+ * La fusée est un point sur l'axe vertical. Le moteur donne une accélération constante pendant
+ * la poussée; la traînée de la fusée, puis celle des parachutes, est proportionnelle au carré de
+ * la vitesse. Un parachute s'ouvre un peu après la commande du déploiement et la fusée tend alors
+ * vers la vitesse de descente du parachute. Le modèle est en boucle fermée: ce sont les commandes
+ * envoyées par le sketch qui ouvrent les parachutes.
+ *
+ * Le baromètre voit l'altitude réelle plus un bruit gaussien et, près de Mach 1, une pointe de
+ * pression due à l'onde de choc (l'altitude mesurée baisse brusquement). Le capteur peut aussi
+ * cesser de répondre pendant quelques échantillons.
+ *
+ * Tous les tirages aléatoires d'un vol viennent d'un générateur initialisé par son numéro: un vol
+ * donne le même résultat quel que soit le nombre de processus qui se partagent la simulation.
+ */
+
+#ifndef flightModel_h
+#define flightModel_h
+
+#include <stdint.h>
+
+class Random {
+    public:
+        Random(uint64_t seed);
+        uint64_t next();
+        double uniform();                         // [0, 1[
+        double uniform(double low, double high);
+        double gaussian();                        // moyenne 0, écart type 1
+
+    private:
+        uint64_t _state;
+};
+
+struct SensorOptions {
+    double noise;            // m, écart type du bruit du baromètre
+    double dropoutRate;      // probabilité qu'un échantillon commence une panne du capteur
+    unsigned maxDropout;     // échantillons, durée maximale d'une panne
+    double transonicSpike;   // m, baisse maximale de l'altitude mesurée à Mach 1
+};
+
+struct FlightProfile {
+    double padTime;          // s, attente sur la rampe après le démarrage du Arduino
+    double burnTime;         // s
+    double thrust;           // m/s², accélération donnée par le moteur
+    double bodyDrag;         // 1/m, décélération = bodyDrag * v²
+    double drogueRate;       // m/s, vitesse de descente sous le drogue
+    double mainRate;         // m/s, vitesse de descente sous le principal
+    double openingDelay;     // s, entre la commande et l'ouverture d'un parachute
+
+    // Tire un vol au hasard dans les plages de FLIGHT_MODEL_*.
+    static FlightProfile draw(Random &random);
+};
+
+class FlightModel {
+    public:
+        FlightModel(const FlightProfile &profile);
+        // Fait avancer le vol de duration s.
+        void advance(double duration);
+        void deployDrogue();
+        void deployMain();
+
+        double getTime() const;
+        double getAltitude() const;
+        double getVerticalSpeed() const;
+        double getMach() const;
+        bool hasLanded() const;
+        // Apogée réelle, connue une fois que la fusée redescend.
+        bool apogeeReached() const;
+        double getApogeeTime() const;
+        double getApogeeAltitude() const;
+
+    private:
+        FlightProfile _profile;
+        double _time;
+        double _altitude;
+        double _speed;
+        double _drag;
+        double _drogueOpening;
+        double _mainOpening;
+        bool _apogeeReached;
+        double _apogeeTime;
+        double _apogeeAltitude;
+
+        void _step(double dt);
+};
+
+class SensorModel {
+    public:
+        SensorModel(const SensorOptions &options);
+        // Altitude mesurée par le baromètre pour un échantillon.
+        double measure(const FlightModel &flight, Random &random);
+        // Décide si le capteur répond pour l'échantillon suivant.
+        bool nextSampleResponds(Random &random);
+
+    private:
+        SensorOptions _options;
+        unsigned _dropoutRemaining;
+};
+
+#endif
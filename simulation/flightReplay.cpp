@@ -0,0 +1,475 @@
+#include "flightReplay.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "sketch.h"
+#include "flightLog.h"
+#include "telemetryStream.h"
+#include "flightModel.h"
+
+#define REPLAY_LOOP_STEP  500 // us
+#define REPLAY_PROFILER_PREFIX  "0,profiler,"
+#define REPLAY_PREVIOUS_FLIGHT_SIZE  32768 // octets, taille d'un historique déjà sur la carte
+#define REPLAY_BAROMETERS  2
+#define REPLAY_APOGEE_SMOOTHING_HALF_WIDTH  5     // échantillons, demi-largeur de la moyenne mobile
+#define REPLAY_APOGEE_FIT_HALF_WIDTH        2000  // ms
+
+namespace {
+    std::vector<ReplayEvent> *activeEvents = 0;
+    std::vector<std::string> *activeProfilerReport = 0;
+    unsigned long *activeBootTimes = 0;
+    std::string serialLine;
+    TelemetryStream telemetryStream;
+    bool telemetryEcho = false;
+    unsigned long serialByteCount = 0;
+    std::vector<unsigned char> *activeSerialOutput = 0;
+    std::map<unsigned long, unsigned long> *activeBuzzerDurations = 0;
+    uint64_t buzzerEdgeTime = 0;
+    bool buzzerEdgeSeen = false;
+
+    std::string previousFlightName(unsigned int number) {
+        return std::string(LOG_UNIT_FILE_NAME) + "_" + std::to_string(number) + LOG_UNIT_FILE_EXT;
+    }
+
+    void addEvent(ReplayEventType type, const std::string &description) {
+        ReplayEvent event;
+        event.type = type;
+        event.timeStamp = sim::getMicros()/1000; // millis() repart de zéro à chaque redémarrage
+        event.altitude = getRocket().getAltitude(0);
+        event.description = description;
+        activeEvents->push_back(event);
+    }
+
+    void onPinChange(uint8_t pin, uint8_t value) {
+    /*
+     * Une commande de parachute est un front montant sur la sortie de l'allumette. Une fois
+     * l'allumette brûlée, la continuité est perdue: on met l'entrée de vérification à LOW. La
+     * durée de chaque bip et de chaque silence du buzzer est comptée.
+     */
+        if(pin == IO_BUZZER_OUT) {
+            if(buzzerEdgeSeen) {
+                activeBuzzerDurations[value == HIGH ? 0 : 1][(sim::getMicros() - buzzerEdgeTime)/1000]++;
+            }
+            buzzerEdgeTime = sim::getMicros();
+            buzzerEdgeSeen = true;
+            return;
+        }
+        if(value != HIGH) {
+            return;
+        }
+        if(pin == IO_DROGUE_OUT) {
+            addEvent(REPLAY_EVENT_PARACHUTE, "drogue command");
+            sim::setPinInput(IO_DROGUE_FEEDBACK, LOW);
+        }
+        else if(pin == IO_MAIN_OUT) {
+            addEvent(REPLAY_EVENT_PARACHUTE, "main command");
+            sim::setPinInput(IO_MAIN_FEEDBACK, LOW);
+        }
+    }
+
+    void onSerialLine(std::string line) {
+    /*
+     * Les lignes d'évènements (ID_LOG_EVENT) envoyées sur le port série sont reprises telles
+     * quelles; le message est le dernier champ de la ligne. Les lignes du LoopProfiler sont
+     * gardées, un nouveau rapport remplaçant le précédent.
+     */
+        if(line.size() > 0 && line[line.size()-1] == '\r') {
+            line.erase(line.size()-1);
+        }
+        if(line.compare(0, strlen(REPLAY_PROFILER_PREFIX), REPLAY_PROFILER_PREFIX) == 0) {
+            std::string report = line.substr(strlen(REPLAY_PROFILER_PREFIX));
+            if(report.compare(0, 6, "stage,") == 0 && report.find(",updateAltitude,") != std::string::npos) {
+                activeProfilerReport->clear();
+            }
+            activeProfilerReport->push_back(report);
+        }
+        std::string bootPrefix = std::string("0,") + MESSAGE_BOOT_TIME + ",";
+        if(line.compare(0, bootPrefix.size(), bootPrefix) == 0) {
+            char *end;
+            activeBootTimes[0] = strtoul(line.c_str() + bootPrefix.size(), &end, 10);
+            activeBootTimes[1] = *end == ',' ? strtoul(end + 1, 0, 10) : 0;
+        }
+        std::vector<FlightLogRecord> records;
+        if(line.size() > 2 && atoi(line.c_str()) == ID_LOG_EVENT) {
+            parseFlightLog(line.c_str(), line.size(), records);
+        }
+        if(records.size() == 1) {
+            ReplayEvent event;
+            event.type = REPLAY_EVENT_LOG;
+            event.timeStamp = records[0].timeStamp;
+            event.altitude = records[0].filteredAltitude;
+            event.description = records[0].message;
+            activeEvents->push_back(event);
+        }
+    }
+
+    void onSerialData(const uint8_t *data, size_t size) {
+    /*
+     * En télémétrie binaire, les trames sont décodées en lignes; l'écho affiche les lignes
+     * décodées au lieu des octets reçus.
+     */
+        serialByteCount += size;
+        if(activeSerialOutput) {
+            activeSerialOutput->insert(activeSerialOutput->end(), data, data + size);
+        }
+#if SERIAL_TELEMETRY
+        std::vector<std::string> lines;
+        telemetryStream.write(data, size, lines);
+        for(size_t i = 0; i < lines.size(); i++) {
+            if(telemetryEcho) {
+                printf("%s\n", lines[i].c_str());
+            }
+            onSerialLine(lines[i]);
+        }
+#else
+        for(size_t i = 0; i < size; i++) {
+            if(data[i] == '\n') {
+                onSerialLine(serialLine);
+                serialLine.clear();
+            }
+            else {
+                serialLine += (char)data[i];
+            }
+        }
+#endif
+    }
+}
+
+FlightReplay::FlightReplay() : _serialEcho(false), _serialCapture(false), _previousFlights(0),
+                               _previousFlightsIndexed(true), _overwrittenPreviousFlights(0), _setupDuration(0), _firstSampleTime(0),
+                               _serialByteCount(0), _telemetryFrameCount(0), _telemetryLostFrameCount(0),
+                               _telemetryInvalidFrameCount(0),
+                               _worstLoopDuration(0), _meanLoopDuration(0) {
+    _barometerFaults = BarometerFaults();
+    _barometerSeed = 1;
+}
+
+void FlightReplay::setSerialEcho(bool enabled) {
+    _serialEcho = enabled;
+}
+
+void FlightReplay::setSerialCapture(bool enabled) {
+    _serialCapture = enabled;
+}
+
+void FlightReplay::addSdWriteStall(unsigned long timeStamp, unsigned long duration) {
+    _sdWriteStalls.push_back(std::make_pair(timeStamp, duration));
+}
+
+void FlightReplay::setPreviousFlights(unsigned int count, bool indexed) {
+    _previousFlights = count;
+    _previousFlightsIndexed = indexed;
+}
+
+void FlightReplay::addReset(unsigned long timeStamp, uint8_t resetFlags, bool optiboot) {
+    ReplayReset reset = {timeStamp, resetFlags, optiboot};
+    _resets.push_back(reset);
+}
+
+void FlightReplay::setBarometerFaults(const BarometerFaults &faults, uint64_t seed) {
+    _barometerFaults = faults;
+    _barometerSeed = seed;
+}
+
+void FlightReplay::addBarometerFailure(uint8_t barometer, unsigned long timeStamp) {
+    _barometerFailures.push_back(std::make_pair(barometer, timeStamp));
+}
+
+void FlightReplay::_presentSample(const ReplaySample &sample, Random &random) {
+/*
+ * Chaque baromètre fait le même nombre de tirages à chaque échantillon, qu'il soit lu ou non.
+ */
+    for(uint8_t barometer = 0; barometer < REPLAY_BAROMETERS; barometer++) {
+        double altitude = sample.altitude + _barometerFaults.noise*random.gaussian();
+        double glitch = random.uniform(-_barometerFaults.glitchAmplitude, _barometerFaults.glitchAmplitude);
+        if(random.uniform() < _barometerFaults.glitchRate) {
+            altitude += glitch;
+        }
+        bool responding = random.uniform() >= _barometerFaults.dropoutRate;
+        for(size_t i = 0; i < _barometerFailures.size(); i++) {
+            if(_barometerFailures[i].first == barometer && sample.timeStamp >= _barometerFailures[i].second) {
+                responding = false;
+            }
+        }
+        sim::setBarometerAltitude(barometer, altitude);
+        sim::setBarometerResponding(barometer, responding);
+    }
+}
+
+void FlightReplay::run(const std::vector<ReplaySample> &samples) {
+/*
+ * Le Arduino démarre au sol: la pression de référence est capturée à l'altitude 0 et les deux
+ * allumettes sont branchées. Ensuite, chaque échantillon déclenche une période du Timer1 au temps
+ * enregistré; le baromètre simulé voit cette altitude jusqu'à l'échantillon suivant.
+ */
+    _events.clear();
+    _profilerReport.clear();
+    unsigned long bootTimes[2] = {0, 0};
+    activeEvents = &_events;
+    activeProfilerReport = &_profilerReport;
+    activeBootTimes = bootTimes;
+    serialLine.clear();
+    telemetryStream.reset();
+    serialByteCount = 0;
+    _serialOutput.clear();
+    activeSerialOutput = _serialCapture ? &_serialOutput : 0;
+    _buzzerDurations[0].clear();
+    _buzzerDurations[1].clear();
+    activeBuzzerDurations = _buzzerDurations;
+    buzzerEdgeSeen = false;
+
+    sim::reset();
+#if ALTIMETER_DUAL
+    sim::setBarometerMux(ALTIMETER_FIRST_MUX_CHANNEL, ALTIMETER_SECOND_MUX_CHANNEL);
+#endif
+    for(unsigned int i = 1; i <= _previousFlights; i++) {
+        sim::createSdFile(previousFlightName(i), REPLAY_PREVIOUS_FLIGHT_SIZE);
+    }
+    if(_previousFlights > 0 && _previousFlightsIndexed) {
+        EEPROM.put(EEPROM_LOG_FILE_NUMBER, (uint16_t)_previousFlights);
+    }
+    for(size_t i = 0; i < _sdWriteStalls.size(); i++) {
+        sim::addSdWriteStall((uint64_t)_sdWriteStalls[i].first*1000, (uint64_t)_sdWriteStalls[i].second*1000);
+    }
+    sim::setSerialEcho(_serialEcho && !SERIAL_TELEMETRY);
+    telemetryEcho = _serialEcho;
+    sim::setSerialListener(onSerialData);
+    sim::setPinListener(onPinChange);
+    sim::setPinInput(IO_DROGUE_FEEDBACK, HIGH);
+    sim::setPinInput(IO_MAIN_FEEDBACK, HIGH);
+    sim::setBarometerAltitude(0);
+    resetSketch();
+
+    Random random(_barometerSeed);
+    byte flightStep = getFlightPlanStep();
+    size_t nextReset = 0;
+    uint64_t totalLoopDuration = 0;
+    _worstLoopDuration = 0;
+    for(size_t i = 0; i < samples.size(); i++) {
+        // Une boucle trop lente repousse l'échantillon suivant, le temps ne recule jamais.
+        uint64_t sampleTime = (uint64_t)samples[i].timeStamp * 1000;
+        if(sampleTime > sim::getMicros()) {
+            sim::setMicros(sampleTime);
+        }
+        uint64_t nextSampleTime = i + 1 < samples.size() ? (uint64_t)samples[i+1].timeStamp * 1000
+                                                          : sampleTime + DATA_SAMPLING_PERIOD;
+        _presentSample(samples[i], random);
+        sim::fireTimerInterrupt();
+
+        // La boucle principale tourne en continu jusqu'à l'échantillon suivant. Seul le travail
+        // fait dans loop() (bus I2C, carte SD) fait avancer le temps; entre deux passages, on
+        // avance de REPLAY_LOOP_STEP.
+        do {
+            if(nextReset < _resets.size() && sim::getMicros() >= (uint64_t)_resets[nextReset].timeStamp*1000) {
+                sim::reboot(_resets[nextReset].resetFlags, _resets[nextReset].optiboot);
+                nextReset++;
+                buzzerEdgeSeen = false; // La sortie du buzzer repart à LOW sans front
+                addEvent(REPLAY_EVENT_FLIGHT_STEP, "redémarrage");
+                resetSketch();
+            }
+            uint64_t loopStart = sim::getMicros();
+            loop();
+            unsigned long loopDuration = sim::getMicros() - loopStart;
+            totalLoopDuration += loopDuration;
+            if(loopDuration > _worstLoopDuration) {
+                _worstLoopDuration = loopDuration;
+            }
+
+            if(getFlightPlanStep() != flightStep) {
+                std::string description = getFlightStepName(flightStep);
+                description += " -> ";
+                description += getFlightStepName(getFlightPlanStep());
+                addEvent(REPLAY_EVENT_FLIGHT_STEP, description);
+                flightStep = getFlightPlanStep();
+            }
+            sim::advanceMicros(REPLAY_LOOP_STEP);
+        } while(sim::getMicros() < nextSampleTime);
+    }
+
+    // La commande est lue par la tâche TASK_COMMANDS au plus une période plus tard.
+    sim::sendSerialInput(std::string(1, LOOP_PROFILER_REPORT_COMMAND));
+    uint64_t reportEnd = sim::getMicros() + TASK_COMMANDS_PERIOD;
+    do {
+        loop();
+        sim::advanceMicros(REPLAY_LOOP_STEP);
+    } while(sim::getMicros() < reportEnd);
+
+    _meanLoopDuration = samples.empty() ? 0 : totalLoopDuration/samples.size();
+    _setupDuration = bootTimes[0];
+    _firstSampleTime = bootTimes[1];
+    _serialByteCount = serialByteCount;
+    _telemetryFrameCount = telemetryStream.getFrameCount();
+    _telemetryLostFrameCount = telemetryStream.getLostFrameCount();
+    _telemetryInvalidFrameCount = telemetryStream.getInvalidFrameCount();
+    _logFileName = sim::getLastOpenedSdFile();
+    _logFile = sim::sdFileContent(_logFileName);
+    // Un historique précédent est écrasé si ses octets (des zéros) ont changé; l'historique du
+    // rejeu peut seulement être ajouté à sa fin.
+    _overwrittenPreviousFlights = 0;
+    for(unsigned int i = 1; i <= _previousFlights; i++) {
+        const std::vector<uint8_t> &content = sim::sdFileContent(previousFlightName(i));
+        if(content.size() < REPLAY_PREVIOUS_FLIGHT_SIZE ||
+           std::count(content.begin(), content.begin() + REPLAY_PREVIOUS_FLIGHT_SIZE, 0) != REPLAY_PREVIOUS_FLIGHT_SIZE) {
+            _overwrittenPreviousFlights++;
+        }
+    }
+    sim::setSerialListener(0);
+    sim::setPinListener(0);
+    activeEvents = 0;
+    activeProfilerReport = 0;
+    activeBootTimes = 0;
+    activeSerialOutput = 0;
+    activeBuzzerDurations = 0;
+}
+
+const std::vector<ReplayEvent> &FlightReplay::getEvents() const {
+    return _events;
+}
+
+unsigned long FlightReplay::getWorstLoopDuration() const {
+    return _worstLoopDuration;
+}
+
+unsigned long FlightReplay::getMeanLoopDuration() const {
+    return _meanLoopDuration;
+}
+
+const std::vector<unsigned char> &FlightReplay::getLogFile() const {
+    return _logFile;
+}
+
+const std::vector<std::string> &FlightReplay::getProfilerReport() const {
+    return _profilerReport;
+}
+
+std::string FlightReplay::getLogFileName() const {
+    return _logFileName;
+}
+
+unsigned int FlightReplay::getOverwrittenPreviousFlights() const {
+    return _overwrittenPreviousFlights;
+}
+
+bool loadReplaySamples(const std::string &path, std::vector<ReplaySample> &samples) {
+    std::vector<FlightLogRecord> records;
+    if(!readFlightLog(path, records)) {
+        return false;
+    }
+    for(size_t i = 0; i < records.size(); i++) {
+        if(records[i].id == ID_LOG_DATA) {
+            ReplaySample sample;
+            sample.timeStamp = records[i].timeStamp;
+            sample.altitude = records[i].rawAltitude;
+            samples.push_back(sample);
+        }
+    }
+    return true;
+}
+
+bool findReplayApogee(const std::vector<ReplaySample> &samples, double &apogeeTime, double &apogeeAltitude) {
+/*
+ * Sommet de la parabole a + b*t + c*t^2 ajustée autour du maximum de l'altitude lissée. Le
+ * temps est centré sur ce maximum pour garder le système bien conditionné.
+ */
+    size_t peak = 0;
+    double peakAltitude = -1e9;
+    for(size_t i = 0; i < samples.size(); i++) {
+        size_t first = i > REPLAY_APOGEE_SMOOTHING_HALF_WIDTH ? i - REPLAY_APOGEE_SMOOTHING_HALF_WIDTH : 0;
+        size_t last = std::min(i + REPLAY_APOGEE_SMOOTHING_HALF_WIDTH, samples.size() - 1);
+        double sum = 0;
+        for(size_t j = first; j <= last; j++) {
+            sum += samples[j].altitude;
+        }
+        if(sum/(last - first + 1) > peakAltitude) {
+            peakAltitude = sum/(last - first + 1);
+            peak = i;
+        }
+    }
+    if(samples.empty()) {
+        return false;
+    }
+
+    double origin = samples[peak].timeStamp/1000.0;
+    double s[5] = {0, 0, 0, 0, 0};  // Sommes de t^k
+    double r[3] = {0, 0, 0};        // Sommes de y*t^k
+    for(size_t i = 0; i < samples.size(); i++) {
+        double t = samples[i].timeStamp/1000.0 - origin;
+        if(fabs(t) > REPLAY_APOGEE_FIT_HALF_WIDTH/1000.0) {
+            continue;
+        }
+        double power = 1;
+        for(int k = 0; k < 5; k++) {
+            s[k] += power;
+            if(k < 3) {
+                r[k] += samples[i].altitude*power;
+            }
+            power *= t;
+        }
+    }
+    // Équations normales 3x3 résolues par la règle de Cramer
+    double m[3][3] = {{s[0], s[1], s[2]}, {s[1], s[2], s[3]}, {s[2], s[3], s[4]}};
+    double determinant = m[0][0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1]) - m[0][1]*(m[1][0]*m[2][2] - m[1][2]*m[2][0]) +
+                         m[0][2]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+    if(fabs(determinant) < 1e-12) {
+        return false;
+    }
+    double a = (r[0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1]) - m[0][1]*(r[1]*m[2][2] - m[1][2]*r[2]) +
+                m[0][2]*(r[1]*m[2][1] - m[1][1]*r[2]))/determinant;
+    double b = (m[0][0]*(r[1]*m[2][2] - m[1][2]*r[2]) - r[0]*(m[1][0]*m[2][2] - m[1][2]*m[2][0]) +
+                m[0][2]*(m[1][0]*r[2] - r[1]*m[2][0]))/determinant;
+    double c = (m[0][0]*(m[1][1]*r[2] - r[1]*m[2][1]) - m[0][1]*(m[1][0]*r[2] - r[1]*m[2][0]) +
+                r[0]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]))/determinant;
+    if(c >= 0) {
+        return false;
+    }
+    double vertex = -b/(2*c);
+    apogeeTime = origin + vertex;
+    apogeeAltitude = a + b*vertex + c*vertex*vertex;
+    return true;
+}
+
+const char *getFlightStepName(int flightStep) {
+    switch(flightStep) {
+        case FLIGHT_STEP_LAUNCHPAD:  return "LAUNCHPAD";
+        case FLIGHT_STEP_BURNOUT:    return "BURNOUT";
+        case FLIGHT_STEP_PRE_DROGUE: return "PRE_DROGUE";
+        case FLIGHT_STEP_PRE_MAIN:   return "PRE_MAIN";
+        case FLIGHT_STEP_DRIFT:      return "DRIFT";
+        case FLIGHT_STEP_IDLE:       return "IDLE";
+    }
+    return "?";
+}
+
+unsigned long FlightReplay::getSetupDuration() const {
+    return _setupDuration;
+}
+
+unsigned long FlightReplay::getFirstSampleTime() const {
+    return _firstSampleTime;
+}
+
+unsigned long FlightReplay::getSerialByteCount() const {
+    return _serialByteCount;
+}
+
+const std::vector<unsigned char> &FlightReplay::getSerialOutput() const {
+    return _serialOutput;
+}
+
+const std::map<unsigned long, unsigned long> &FlightReplay::getBuzzerDurations(bool on) const {
+    return _buzzerDurations[on ? 1 : 0];
+}
+
+unsigned long FlightReplay::getTelemetryFrameCount() const {
+    return _telemetryFrameCount;
+}
+
+unsigned long FlightReplay::getTelemetryLostFrameCount() const {
+    return _telemetryLostFrameCount;
+}
+
+unsigned long FlightReplay::getTelemetryInvalidFrameCount() const {
+    return _telemetryInvalidFrameCount;
+}
@@ -0,0 +1,145 @@
+/*
+ * Moteur de rejeu de vol. Le sketch du déploiement est exécuté sur l'ordinateur hôte avec la
+ * couche Arduino simulée: chaque échantillon fourni est présenté au baromètre au temps indiqué,
+ * l'interruption du Timer1 est déclenchée et loop() est appelée en continu jusqu'à l'échantillon
+ * suivant. Le moteur note chaque
+ * changement d'étape du plan de vol, chaque commande de parachute et chaque évènement écrit
+ * dans l'historique par Rocket::logEvent(). Il mesure aussi la durée de chaque passage dans loop()
+ * selon le temps simulé, qui avance avec les accès à la carte SD. À la fin du rejeu, le rapport du
+ * LoopProfiler est demandé par le port série, comme on le ferait au sol. Avec SERIAL_TELEMETRY,
+ * les trames du port série sont décodées en lignes (voir telemetryStream.h) avant d'être lues.
+ *
+ * Avec ALTIMETER_DUAL, les deux baromètres simulés sont branchés sur le multiplexeur. Des défauts
+ * tirés indépendamment pour chaque baromètre (setBarometerFaults()) sont ajoutés à l'altitude
+ * enregistrée; sans ALTIMETER_DUAL, le sketch ne lit que le premier.
+ */
+
+#ifndef flightReplay_h
+#define flightReplay_h
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+struct ReplaySample {
+    unsigned long timeStamp; // ms
+    float altitude;          // m, altitude brute vue par le baromètre
+};
+
+class Random;
+
+struct BarometerFaults {
+    double noise;            // m, écart type du bruit ajouté à chaque lecture
+    double glitchRate;       // probabilité qu'une lecture soit aberrante
+    double glitchAmplitude;  // m, écart maximal d'une lecture aberrante
+    double dropoutRate;      // probabilité que le capteur ne réponde pas pendant un échantillon
+};
+
+enum ReplayEventType {
+    REPLAY_EVENT_FLIGHT_STEP,
+    REPLAY_EVENT_PARACHUTE,
+    REPLAY_EVENT_LOG
+};
+
+// Redémarrage du Arduino demandé par addReset()
+struct ReplayReset {
+    unsigned long timeStamp; // ms
+    uint8_t resetFlags;      // Cause du redémarrage (bits de MCUSR)
+    bool optiboot;           // MCUSR effacé, cause passée dans r2 par Optiboot
+};
+
+struct ReplayEvent {
+    ReplayEventType type;
+    unsigned long timeStamp;
+    float altitude;
+    std::string description;
+};
+
+class FlightReplay {
+    public:
+        FlightReplay();
+        void setSerialEcho(bool enabled);
+        // Garde tous les octets envoyés sur le port série (voir getSerialOutput()).
+        void setSerialCapture(bool enabled);
+        // Bloque la première écriture sur la carte SD faite après timeStamp (ms) pendant duration ms.
+        void addSdWriteStall(unsigned long timeStamp, unsigned long duration);
+        // Place count historiques de vols précédents sur la carte (alt_1 à alt_count) et le numéro
+        // du dernier dans l'EEPROM, comme après count vols avec le même circuit. Sans indexed,
+        // l'EEPROM reste neuve, comme avec un circuit remplacé.
+        void setPreviousFlights(unsigned int count, bool indexed = true);
+        // Redémarre le Arduino au premier passage dans loop() fait après timeStamp (ms), avec la
+        // cause resetFlags (par défaut une baisse de tension en vol, BORF) dans MCUSR, ou, avec
+        // optiboot, passée dans r2 par Optiboot qui efface MCUSR (voir sim::reboot()).
+        void addReset(unsigned long timeStamp, uint8_t resetFlags = 1 << 2, bool optiboot = false);
+        // Défauts de chaque baromètre, tirés avec le germe seed: le même germe donne les mêmes
+        // lectures, avec ou sans ALTIMETER_DUAL.
+        void setBarometerFaults(const BarometerFaults &faults, uint64_t seed);
+        // Le baromètre (0 ou 1) cesse de répondre à partir de timeStamp (ms).
+        void addBarometerFailure(uint8_t barometer, unsigned long timeStamp);
+        void run(const std::vector<ReplaySample> &samples);
+
+        const std::vector<ReplayEvent> &getEvents() const;
+        // Pire durée d'un passage dans loop() et temps de calcul moyen par échantillon (us)
+        unsigned long getWorstLoopDuration() const;
+        unsigned long getMeanLoopDuration() const;
+        const std::vector<unsigned char> &getLogFile() const;
+        // Dernier rapport du LoopProfiler envoyé sur le port série, sans le préfixe "0,profiler,"
+        const std::vector<std::string> &getProfilerReport() const;
+        std::string getLogFileName() const;
+        // Historiques des vols précédents dont le contenu a changé pendant le rejeu
+        unsigned int getOverwrittenPreviousFlights() const;
+        // Durée de setup() et temps de la première mesure (us), lus dans la dernière ligne "boot"
+        // envoyée sur le port série (celle du dernier redémarrage). Zéro si elle n'a pas été reçue.
+        unsigned long getSetupDuration() const;
+        unsigned long getFirstSampleTime() const;
+        // Octets envoyés sur le port série et, avec SERIAL_TELEMETRY, trames de télémétrie
+        // décodées et perdues (sauts de séquence) ou invalides
+        unsigned long getSerialByteCount() const;
+        const std::vector<unsigned char> &getSerialOutput() const;
+        // Nombre de bips (on) ou de silences (off) du buzzer pour chaque durée (ms)
+        const std::map<unsigned long, unsigned long> &getBuzzerDurations(bool on) const;
+        unsigned long getTelemetryFrameCount() const;
+        unsigned long getTelemetryLostFrameCount() const;
+        unsigned long getTelemetryInvalidFrameCount() const;
+
+    private:
+        bool _serialEcho;
+        bool _serialCapture;
+        std::vector<unsigned char> _serialOutput;
+        std::map<unsigned long, unsigned long> _buzzerDurations[2];
+        std::vector<std::pair<unsigned long, unsigned long> > _sdWriteStalls;
+        std::vector<ReplayReset> _resets;
+        BarometerFaults _barometerFaults;
+        uint64_t _barometerSeed;
+        std::vector<std::pair<uint8_t, unsigned long> > _barometerFailures;
+        unsigned int _previousFlights;
+        bool _previousFlightsIndexed;
+        unsigned int _overwrittenPreviousFlights;
+        unsigned long _setupDuration;
+        unsigned long _firstSampleTime;
+        unsigned long _serialByteCount;
+        unsigned long _telemetryFrameCount;
+        unsigned long _telemetryLostFrameCount;
+        unsigned long _telemetryInvalidFrameCount;
+        std::vector<ReplayEvent> _events;
+        unsigned long _worstLoopDuration; // us
+        unsigned long _meanLoopDuration;  // us
+        std::vector<unsigned char> _logFile;
+        std::vector<std::string> _profilerReport;
+        std::string _logFileName;
+
+        void _presentSample(const ReplaySample &sample, Random &random);
+};
+
+// Extrait les échantillons d'altitude brute (lignes ID_LOG_DATA) d'un historique de vol.
+bool loadReplaySamples(const std::string &path, std::vector<ReplaySample> &samples);
+
+// Apogée de référence d'un vol enregistré (s, m): sommet d'une parabole ajustée par moindres carrés
+// à l'altitude brute, 2 s de part et d'autre du maximum de l'altitude lissée. Près de l'apogée, la
+// décélération est presque constante. Retourne false si l'ajustement n'a pas de sommet.
+bool findReplayApogee(const std::vector<ReplaySample> &samples, double &apogeeTime, double &apogeeAltitude);
+
+const char *getFlightStepName(int flightStep);
+
+#endif
@@ -0,0 +1,200 @@
+#include "flightSimulation.h"
+
+#include <algorithm>
+#include "parallel.h"
+#include "sketch.h"
+
+#define SIMULATION_LOOP_STEP         2000   // us, temps entre deux passages dans loop()
+#define SIMULATION_MAX_DURATION      600.0  // s
+#define SIMULATION_EARLY_DROGUE_SPEED  5.0  // m/s, vitesse de montée au-delà de laquelle le drogue est prématuré
+#define SIMULATION_MAIN_TOLERANCE     50.0  // m, écart toléré autour de BREAKPOINT_ALTITUDE_TO_DRIFT
+
+namespace {
+    struct ActiveFlight {
+        FlightModel *model;
+        FlightResult *result;
+    };
+    ActiveFlight activeFlight;
+
+    void onPinChange(uint8_t pin, uint8_t value) {
+    /*
+     * Une commande de parachute est un front montant sur la sortie de l'allumette. Le modèle est
+     * avancé jusqu'au temps de la commande pour noter l'état réel de la fusée à ce moment.
+     */
+        if(value != HIGH || (pin != IO_DROGUE_OUT && pin != IO_MAIN_OUT)) {
+            return;
+        }
+        FlightModel &model = *activeFlight.model;
+        FlightResult &result = *activeFlight.result;
+        model.advance(sim::getMicros()/1e6 - model.getTime());
+        if(pin == IO_DROGUE_OUT && result.drogueTime < 0) {
+            result.drogueTime = model.getTime();
+            result.drogueAltitude = model.getAltitude();
+            result.drogueSpeed = model.getVerticalSpeed();
+            model.deployDrogue();
+            sim::setPinInput(IO_DROGUE_FEEDBACK, LOW);
+        }
+        else if(pin == IO_MAIN_OUT && result.mainTime < 0) {
+            result.mainTime = model.getTime();
+            result.mainAltitude = model.getAltitude();
+            result.mainSpeed = model.getVerticalSpeed();
+            model.deployMain();
+            sim::setPinInput(IO_MAIN_FEEDBACK, LOW);
+        }
+    }
+
+    struct FlightTaskContext {
+        SensorOptions sensor;
+        uint64_t seed;
+    };
+
+    void simulateFlightTask(uint32_t index, void *result, void *context) {
+        FlightTaskContext &flights = *(FlightTaskContext *)context;
+        *(FlightResult *)result = simulateFlight(flights.sensor, flights.seed, index);
+    }
+
+    Statistics computeStatistics(std::vector<double> values) {
+        Statistics statistics = Statistics();
+        statistics.count = values.size();
+        if(values.empty()) {
+            return statistics;
+        }
+        std::sort(values.begin(), values.end());
+        double sum = 0;
+        for(size_t i = 0; i < values.size(); i++) {
+            sum += values[i];
+        }
+        statistics.mean = sum/values.size();
+        statistics.minimum = values.front();
+        statistics.p5 = values[(values.size() - 1)*5/100];
+        statistics.p50 = values[(values.size() - 1)*50/100];
+        statistics.p95 = values[(values.size() - 1)*95/100];
+        statistics.p99 = values[(values.size() - 1)*99/100];
+        statistics.maximum = values.back();
+        return statistics;
+    }
+}
+
+FlightResult simulateFlight(const SensorOptions &sensorOptions, uint64_t seed, uint32_t index) {
+    Random random(seed + index*0x9E3779B97F4A7C15ULL);
+    FlightModel model(FlightProfile::draw(random));
+    SensorModel sensor(sensorOptions);
+    FlightResult result = FlightResult();
+    result.drogueTime = -1;
+    result.speedZeroTime = -1;
+    result.mainTime = -1;
+    activeFlight.model = &model;
+    activeFlight.result = &result;
+
+    sim::reset();
+#if ALTIMETER_DUAL
+    sim::setBarometerMux(ALTIMETER_FIRST_MUX_CHANNEL, ALTIMETER_SECOND_MUX_CHANNEL);
+#endif
+    sim::setPinListener(onPinChange);
+    sim::setPinInput(IO_DROGUE_FEEDBACK, HIGH);
+    sim::setPinInput(IO_MAIN_FEEDBACK, HIGH);
+    sim::setBarometerAltitude(0);
+    resetSketch();
+
+    for(uint64_t tick = DATA_SAMPLING_PERIOD; ; tick += DATA_SAMPLING_PERIOD) {
+        // Une boucle trop lente repousse le tick, le temps ne recule jamais.
+        if(tick > sim::getMicros()) {
+            sim::setMicros(tick);
+        }
+        model.advance(sim::getMicros()/1e6 - model.getTime());
+        if(result.mainTime >= 0 || model.hasLanded() || model.getTime() > SIMULATION_MAX_DURATION) {
+            break;
+        }
+        sim::setBarometerResponding(sensor.nextSampleResponds(random));
+        sim::setBarometerAltitude(sensor.measure(model, random));
+        sim::fireTimerInterrupt();
+
+        // Entre la fin du traitement et le tick suivant, loop() ne fait qu'attendre: on saute
+        // directement au tick.
+        do {
+            loop();
+            sim::advanceMicros(SIMULATION_LOOP_STEP);
+        } while(isSamplePending() && sim::getMicros() < tick + DATA_SAMPLING_PERIOD);
+
+        // Le temps de la mesure, pas celui du traitement: c'est le retard de la vitesse elle-même.
+        if(result.speedZeroTime < 0 && getFlightPlanStep() >= FLIGHT_STEP_PRE_DROGUE && getRocket().getVerticalSpeed() <= 0) {
+            result.speedZeroTime = getRocket().getSampleTime()/1e6;
+        }
+    }
+
+    result.apogeeTime = model.getApogeeTime();
+    result.apogeeAltitude = model.getApogeeAltitude();
+    result.landed = model.hasLanded();
+    sim::setPinListener(0);
+    activeFlight.model = 0;
+    activeFlight.result = 0;
+    return result;
+}
+
+bool simulateFlights(const SensorOptions &sensor, uint64_t seed, uint32_t count, unsigned jobs,
+                     std::vector<FlightResult> &results) {
+    FlightTaskContext context = {sensor, seed};
+    results.resize(count);
+    return runParallel(count, jobs, sizeof(FlightResult), results.data(), simulateFlightTask, &context);
+}
+
+SimulationSummary summarizeFlights(const std::vector<FlightResult> &results) {
+/*
+ * Un drogue est prématuré s'il est commandé pendant que la fusée monte encore à plus de
+ * SIMULATION_EARLY_DROGUE_SPEED. L'altitude visée par le principal est
+ * BREAKPOINT_ALTITUDE_TO_DRIFT, ou l'altitude du drogue si celui-ci a été commandé plus bas. Le
+ * principal est prématuré avant l'apogée ou au-dessus de la cible + SIMULATION_MAIN_TOLERANCE,
+ * tardif sous la cible - SIMULATION_MAIN_TOLERANCE.
+ */
+    SimulationSummary summary = SimulationSummary();
+    std::vector<double> apogeeAltitudes;
+    std::vector<double> latencies;
+    std::vector<double> speedLags;
+    std::vector<double> mainErrors;
+    summary.flights = results.size();
+    for(size_t i = 0; i < results.size(); i++) {
+        const FlightResult &result = results[i];
+        bool early = false;
+        apogeeAltitudes.push_back(result.apogeeAltitude);
+        if(result.speedZeroTime >= 0) {
+            speedLags.push_back(result.speedZeroTime - result.apogeeTime);
+        }
+
+        if(result.drogueTime < 0) {
+            summary.drogueMissed++;
+        }
+        else {
+            latencies.push_back(result.drogueTime - result.apogeeTime);
+            if(result.drogueSpeed > SIMULATION_EARLY_DROGUE_SPEED) {
+                summary.drogueEarly++;
+                early = true;
+            }
+        }
+
+        if(result.mainTime < 0) {
+            summary.mainMissed++;
+        }
+        else {
+            // Sous BREAKPOINT_ALTITUDE_TO_DRIFT, le principal suit le drogue: la cible est plus basse.
+            double target = result.drogueAltitude < BREAKPOINT_ALTITUDE_TO_DRIFT ? result.drogueAltitude : BREAKPOINT_ALTITUDE_TO_DRIFT;
+            double error = result.mainAltitude - target;
+            mainErrors.push_back(error);
+            if(result.mainSpeed > 0 || result.mainTime < result.apogeeTime || error > SIMULATION_MAIN_TOLERANCE) {
+                summary.mainEarly++;
+                early = true;
+            }
+            else if(error < -SIMULATION_MAIN_TOLERANCE) {
+                summary.mainLate++;
+            }
+        }
+
+        if(early) {
+            summary.falseDeploys++;
+        }
+    }
+    summary.apogeeAltitude = computeStatistics(apogeeAltitudes);
+    summary.apogeeLatency = computeStatistics(latencies);
+    summary.speedLag = computeStatistics(speedLags);
+    summary.mainAltitudeError = computeStatistics(mainErrors);
+    return summary;
+}
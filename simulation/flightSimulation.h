@@ -0,0 +1,69 @@
+/*
+ * Simulation de vols synthétiques (voir flightModel.h) dans le sketch du déploiement compilé pour
+ * l'ordinateur hôte.
+ *
+ * Contrairement au rejeu (flightReplay.h), le vol réagit aux commandes du sketch: le drogue et le
+ * principal s'ouvrent quand le sketch allume les allumettes. À chaque tick du Timer1, le modèle
+ * est avancé jusqu'au temps simulé et le baromètre reçoit l'altitude mesurée; loop() est ensuite
+ * appelée jusqu'à ce que l'échantillon soit traité, puis le temps saute au tick suivant. Le vol
+ * s'arrête à la commande du principal, à l'atterrissage ou après SIMULATION_MAX_DURATION.
+ *
+ * Le sketch utilise des variables globales: pour utiliser tous les coeurs, les vols sont répartis
+ * entre des processus enfants (voir parallel.h).
+ */
+
+#ifndef flightSimulation_h
+#define flightSimulation_h
+
+#include <stdint.h>
+#include <vector>
+#include "flightModel.h"
+
+struct FlightResult {
+    float apogeeTime;       // s depuis le démarrage, apogée réelle
+    float apogeeAltitude;   // m
+    float drogueTime;       // s, négatif si le drogue n'a pas été commandé
+    float drogueAltitude;   // m, altitude réelle à la commande
+    float drogueSpeed;      // m/s, vitesse verticale réelle à la commande
+    float speedZeroTime;    // s, mesure où la vitesse verticale du sketch passe à zéro, négatif si jamais
+    float mainTime;         // s, négatif si le principal n'a pas été commandé
+    float mainAltitude;     // m
+    float mainSpeed;        // m/s
+    uint8_t landed;
+};
+
+struct Statistics {
+    unsigned long count;
+    double mean;
+    double minimum;
+    double p5;
+    double p50;
+    double p95;
+    double p99;
+    double maximum;
+};
+
+struct SimulationSummary {
+    unsigned long flights;
+    unsigned long drogueMissed;   // jamais commandé
+    unsigned long drogueEarly;    // commandé pendant la montée
+    unsigned long mainMissed;
+    unsigned long mainEarly;      // commandé avant l'apogée ou trop haut
+    unsigned long mainLate;       // commandé trop bas
+    unsigned long falseDeploys;   // vols avec au moins un déploiement prématuré
+    Statistics apogeeAltitude;    // m
+    Statistics apogeeLatency;     // s, commande du drogue - apogée réelle
+    Statistics speedLag;          // s, passage à zéro de la vitesse du sketch - apogée réelle
+    Statistics mainAltitudeError; // m, altitude réelle à la commande - altitude visée
+};
+
+// Simule le vol numéro index. Le même (seed, index) donne toujours le même vol.
+FlightResult simulateFlight(const SensorOptions &sensor, uint64_t seed, uint32_t index);
+
+// Simule count vols répartis entre jobs processus. Retourne false si un processus a échoué.
+bool simulateFlights(const SensorOptions &sensor, uint64_t seed, uint32_t count, unsigned jobs,
+                     std::vector<FlightResult> &results);
+
+SimulationSummary summarizeFlights(const std::vector<FlightResult> &results);
+
+#endif
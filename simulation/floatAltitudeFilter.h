@@ -0,0 +1,56 @@
+/*
+ * Filtre d'altitude en float que IirFilter (iirFilter.h) remplace: le calcul de Rocket avant
+ * IirFilter, avec les vecteurs décalés à chaque échantillon et l'équation aux différences en float
+ * avec les coefficients A et B de configCircuitDeploiement.h. Il sert de référence à filterCompare
+ * (précision) et à rocketBenchmark (coût par échantillon, aussi en cycles sur l'AVR).
+ */
+
+#ifndef floatAltitudeFilter_h
+#define floatAltitudeFilter_h
+
+#include <math.h>
+#ifdef __AVR__
+#include "src/configCircuitDeploiement.h"
+#else
+#include "configCircuitDeploiement.h"
+#endif
+
+class FloatAltitudeFilter {
+    public:
+        FloatAltitudeFilter() {
+            for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
+                _mesuredAltitude[i] = 0;
+                _filteredAltitude[i] = 0;
+            }
+            _speed = 0;
+        }
+
+        float filter(float mesuredAltitude) {
+            for(int i = ALTITUDE_ARRAY_SIZE - 1; i > 0; i--) {
+                _mesuredAltitude[i] = _mesuredAltitude[i-1];
+                _filteredAltitude[i] = _filteredAltitude[i-1];
+            }
+            _mesuredAltitude[0] = mesuredAltitude;
+            _filteredAltitude[0] = 0;
+            for(int i = 0; i < ALTITUDE_ARRAY_SIZE; i++) {
+                _filteredAltitude[0] += (B[i]*_mesuredAltitude[i] - A[i]*_filteredAltitude[i]);
+            }
+            _speed = 0;
+            for(int i = 0; i < ALTITUDE_ARRAY_SIZE-1; i++) {
+                _speed += (_filteredAltitude[i] - _filteredAltitude[i+1]);
+            }
+            _speed = fabsf(_speed/(ALTITUDE_ARRAY_SIZE-1));
+            return _filteredAltitude[0];
+        }
+
+        float getSpeed() const {
+            return _speed;
+        }
+
+    private:
+        float _mesuredAltitude[ALTITUDE_ARRAY_SIZE];
+        float _filteredAltitude[ALTITUDE_ARRAY_SIZE];
+        float _speed;
+};
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Analyse des historiques de vol texte (alt_N.csv) lus par mapFlightLog() (voir flightLogColumns.h):
+ * résumé de chaque vol (flightLogSummary.h) et, sur demande, liste des évènements. Les fichiers
+ * sont répartis sur tous les coeurs (voir parallel.h); un répertoire donne tous ses fichiers .csv.
+ *
+ * --benchmark compare, pour chaque fichier, le temps de lecture de mapFlightLog() à celui de
+ * readFlightLog() (lecture ligne par ligne avec strtof), et vérifie que les deux donnent les mêmes
+ * valeurs. Le programme retourne 1 si elles diffèrent.
+ *
+ * Utilisation: logAnalyzer [--jobs N] [--events] [--benchmark] fichier.csv|répertoire...
+ */
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "flightLog.h"
+#include "flightLogColumns.h"
+#include "flightLogSummary.h"
+#include "parallel.h"
+#include "configCircuitDeploiement.h"
+
+#define LOG_ANALYZER_BENCHMARK_ROUNDS  5
+
+namespace {
+    struct AnalyzerResult {
+        uint8_t valid;
+        FlightLogSummary summary;
+    };
+
+    void printUsage() {
+        fprintf(stderr, "Utilisation: logAnalyzer [--jobs N] [--events] [--benchmark] fichier.csv|répertoire...\n");
+    }
+
+    bool addPath(const char *path, std::vector<std::string> &files) {
+    /*
+     * Un répertoire donne ses fichiers .csv en ordre alphabétique.
+     */
+        struct stat status;
+        if(stat(path, &status) < 0) {
+            return false;
+        }
+        if(!S_ISDIR(status.st_mode)) {
+            files.push_back(path);
+            return true;
+        }
+        DIR *directory = opendir(path);
+        if(!directory) {
+            return false;
+        }
+        std::vector<std::string> names;
+        struct dirent *entry;
+        while((entry = readdir(directory)) != 0) {
+            size_t length = strlen(entry->d_name);
+            if(length > 4 && strcmp(entry->d_name + length - 4, ".csv") == 0) {
+                names.push_back(std::string(path) + "/" + entry->d_name);
+            }
+        }
+        closedir(directory);
+        std::sort(names.begin(), names.end());
+        files.insert(files.end(), names.begin(), names.end());
+        return true;
+    }
+
+    void analyzeTask(uint32_t index, void *result, void *context) {
+        const std::vector<std::string> &files = *(const std::vector<std::string> *)context;
+        AnalyzerResult &analyzer = *(AnalyzerResult *)result;
+        FlightLogColumns columns;
+        analyzer.valid = mapFlightLog(files[index], columns);
+        analyzer.summary = analyzer.valid ? summarizeFlightLog(columns) : FlightLogSummary();
+    }
+
+    void printSummary(const std::string &path, const FlightLogSummary &summary) {
+        printf("%s\n", path.c_str());
+        printf("    %u échantillons sur %.1f s, intervalle moyen %.1f ms (min %.0f, max %.0f), %u trous, %u évènements dont %u altitudes invalides\n",
+               summary.samples, summary.duration, summary.meanInterval, summary.minInterval, summary.maxInterval,
+               summary.gaps, summary.events, summary.invalidAltitudes);
+        printf("    décollage %.3f s, apogée %.1f m à %.3f s (%.2f s après le décollage)\n", summary.launchTime,
+               summary.apogeeAltitude, summary.apogeeTime, summary.timeToApogee);
+        printf("    descente sous le drogue %.1f m/s, principal à %.3f s, descente sous le principal %.1f m/s, atterrissage à %.3f s\n",
+               summary.drogueRate, summary.mainTime, summary.mainRate, summary.landingTime);
+    }
+
+    void printEvents(const std::string &path) {
+        FlightLogColumns columns;
+        if(!mapFlightLog(path, columns)) {
+            return;
+        }
+        for(size_t i = 0; i < columns.events.size(); i++) {
+            const FlightLogEvent &event = columns.events[i];
+            printf("    %10u ms  %8.2f m  %s\n", event.timeStamp, event.filteredAltitude, event.message.c_str());
+        }
+    }
+
+    bool compareParsers(const std::string &path, const std::vector<FlightLogRecord> &records, const FlightLogColumns &columns) {
+        size_t data = 0;
+        size_t events = 0;
+        for(size_t i = 0; i < records.size(); i++) {
+            const FlightLogRecord &record = records[i];
+            if(record.id == ID_LOG_DATA) {
+                if(data >= columns.timeStamp.size() || columns.timeStamp[data] != record.timeStamp ||
+                   columns.rawAltitude[data] != record.rawAltitude || columns.filteredAltitude[data] != record.filteredAltitude ||
+                   columns.speed[data] != record.speed) {
+                    printf("    DIFFÉRENCE à la ligne de données %zu (%lu ms)\n", data, record.timeStamp);
+                    return false;
+                }
+                data++;
+            }
+            else if(record.id == ID_LOG_EVENT) {
+                if(events >= columns.events.size() || columns.events[events].message != record.message) {
+                    printf("    DIFFÉRENCE à l'évènement %zu (%lu ms)\n", events, record.timeStamp);
+                    return false;
+                }
+                events++;
+            }
+        }
+        if(data != columns.timeStamp.size() || events != columns.events.size()) {
+            printf("    DIFFÉRENCE du nombre de lignes\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool benchmark(const std::string &path) {
+    /*
+     * Meilleur temps de LOG_ANALYZER_BENCHMARK_ROUNDS lectures de chaque méthode, pour que le
+     * fichier soit déjà dans le cache du système.
+     */
+        std::vector<FlightLogRecord> records;
+        FlightLogColumns columns;
+        double naiveTime = 1e9;
+        double mappedTime = 1e9;
+        for(int round = 0; round < LOG_ANALYZER_BENCHMARK_ROUNDS; round++) {
+            records.clear();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            readFlightLog(path, records);
+            std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+            mapFlightLog(path, columns);
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            naiveTime = std::min(naiveTime, std::chrono::duration<double, std::milli>(middle - start).count());
+            mappedTime = std::min(mappedTime, std::chrono::duration<double, std::milli>(end - middle).count());
+        }
+        struct stat status;
+        double megabytes = stat(path.c_str(), &status) == 0 ? status.st_size/1e6 : 0;
+        printf("%s: %.2f Mo\n", path.c_str(), megabytes);
+        printf("    readFlightLog %.2f ms (%.0f Mo/s), mapFlightLog %.2f ms (%.0f Mo/s), %.1f fois plus rapide\n",
+               naiveTime, megabytes*1000/naiveTime, mappedTime, megabytes*1000/mappedTime, naiveTime/mappedTime);
+        bool same = compareParsers(path, records, columns);
+        if(same) {
+            printf("    %zu lignes de données et %zu évènements identiques\n", columns.timeStamp.size(), columns.events.size());
+        }
+        return same;
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned jobs = getProcessorCount();
+    bool events = false;
+    bool runBenchmark = false;
+    std::vector<std::string> files;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--events") == 0) {
+            events = true;
+        }
+        else if(strcmp(argv[i], "--benchmark") == 0) {
+            runBenchmark = true;
+        }
+        else if(argv[i][0] != '-') {
+            if(!addPath(argv[i], files)) {
+                fprintf(stderr, "Impossible de lire %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if(files.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<AnalyzerResult> results(files.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if(!runParallel(files.size(), jobs, sizeof(AnalyzerResult), results.data(), analyzeTask, &files)) {
+        fprintf(stderr, "Échec d'un processus d'analyse\n");
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int status = 0;
+    for(size_t i = 0; i < files.size(); i++) {
+        if(!results[i].valid) {
+            fprintf(stderr, "Impossible de lire %s\n", files[i].c_str());
+            status = 1;
+            continue;
+        }
+        printSummary(files[i], results[i].summary);
+        if(events) {
+            printEvents(files[i]);
+        }
+    }
+    printf("%zu fichiers analysés en %.1f ms sur %u processus\n", files.size(), elapsed, jobs);
+
+    if(runBenchmark) {
+        printf("\n");
+        for(size_t i = 0; i < files.size(); i++) {
+            if(results[i].valid && !benchmark(files[i])) {
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
@@ -0,0 +1,251 @@
+/*
+ * Convertit un historique de vol binaire (LOG_UNIT_BINARY, voir logFormat.h) en fichier CSV
+ * identique à celui qu'écrit le format texte:
+ *     0,timeStamp,rawAltitude,filteredAltitude,speed,message
+ *     1,262,-0.50,-0.01,0.00
+ *     2,1152090,41.35,17.13,32.70,burnout started
+ * Les colonnes de l'estimateur de Kalman sont ajoutées si les enregistrements contiennent un
+ * LogEstimate. Les versions 1 à 3 du format sont lues. Avant la version 3, les vitesses sont en
+ * cm/ech; elles sont converties en m/s avec la période de l'entête pour que toutes les versions
+ * donnent les mêmes colonnes. Depuis la version 2, les données delta sont
+ * ajoutées à l'enregistrement précédent; si une partie du fichier est illisible, le décodage
+ * reprend au point de reprise suivant (voir logFormat.h). Le remplissage de la fin d'un fichier
+ * préalloué (LOG_FORMAT_FILL) est ignoré.
+ *
+ * Utilisation: logDecoder alt_N.bin [sortie.csv]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "configCircuitDeploiement.h"
+
+namespace {
+    std::string formatCentimeters(long centimeters) {
+        char buffer[32];
+        unsigned long magnitude = centimeters < 0 ? -centimeters : centimeters;
+        snprintf(buffer, sizeof(buffer), "%s%lu.%02lu", centimeters < 0 ? "-" : "", magnitude/100, magnitude%100);
+        return buffer;
+    }
+
+    bool readHeader(const std::vector<uint8_t> &content, LogFileHeader &header) {
+        if(content.size() < sizeof(header)) {
+            fprintf(stderr, "Fichier trop court\n");
+            return false;
+        }
+        memcpy(&header, &content[0], sizeof(header));
+        if(header.magic[0] != LOG_FORMAT_MAGIC_0 || header.magic[1] != LOG_FORMAT_MAGIC_1 ||
+           header.magic[2] != LOG_FORMAT_MAGIC_2 || header.magic[3] != LOG_FORMAT_MAGIC_3) {
+            fprintf(stderr, "Ce n'est pas un historique de vol binaire\n");
+            return false;
+        }
+        if(header.version < 1 || header.version > LOG_FORMAT_VERSION ||
+           (header.recordSize != sizeof(LogRecord) && header.recordSize != sizeof(LogRecord) + sizeof(LogEstimate))) {
+            fprintf(stderr, "Version %d du format non supportée (attendue: 1 à %d)\n", header.version, LOG_FORMAT_VERSION);
+            return false;
+        }
+        return true;
+    }
+
+    long speedCentimeters(long speed, const LogFileHeader &header) {
+    /*
+     * Vitesse en cm/s. Avant la version 3, elle était écrite en cm par période d'échantillonnage.
+     */
+        if(header.version >= 3 || header.samplingPeriod == 0) {
+            return speed;
+        }
+        return lround(speed*1000.0/header.samplingPeriod);
+    }
+
+    bool readUnsigned(const std::vector<uint8_t> &content, size_t &position, uint32_t &value) {
+        value = 0;
+        for(int shift = 0; shift < 35 && position < content.size(); shift += 7) {
+            uint8_t byte = content[position++];
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readSigned(const std::vector<uint8_t> &content, size_t &position, int32_t &value) {
+        uint32_t encoded;
+        if(!readUnsigned(content, position, encoded)) {
+            return false;
+        }
+        value = (int32_t)(encoded >> 1) ^ -(int32_t)(encoded & 1);
+        return true;
+    }
+
+    bool readDelta(const std::vector<uint8_t> &content, size_t &position, bool hasEstimate,
+                   LogRecord &record, LogEstimate &estimate) {
+    /*
+     * Applique un enregistrement delta (voir logFormat.h) à l'enregistrement précédent.
+     */
+        uint32_t time;
+        int32_t raw, filtered, speed, altitude = 0, verticalSpeed = 0, acceleration = 0;
+        if(!readUnsigned(content, position, time) || !readSigned(content, position, raw) ||
+           !readSigned(content, position, filtered) || !readSigned(content, position, speed)) {
+            return false;
+        }
+        if(hasEstimate && (!readSigned(content, position, altitude) || !readSigned(content, position, verticalSpeed) ||
+                           !readSigned(content, position, acceleration))) {
+            return false;
+        }
+        record.id = ID_LOG_DATA;
+        record.event = 0;
+        record.timeStamp += time;
+        record.rawAltitude += raw;
+        record.filteredAltitude += filtered;
+        record.speed += speed;
+        estimate.altitude += altitude;
+        estimate.verticalSpeed += verticalSpeed;
+        estimate.acceleration += acceleration;
+        return true;
+    }
+
+    size_t findKeyframe(const std::vector<uint8_t> &content, size_t position, const LogFileHeader &header,
+                        uint32_t minimalTime) {
+    /*
+     * Cherche le prochain point de reprise: une donnée complète marquée LOG_FORMAT_KEYFRAME dont
+     * le temps ne recule pas par rapport au dernier enregistrement lu.
+     */
+        for(; position + header.recordSize <= content.size(); position++) {
+            if(content[position] == ID_LOG_DATA && content[position + 1] == LOG_FORMAT_KEYFRAME) {
+                LogRecord record;
+                memcpy(&record, &content[position], sizeof(record));
+                if(record.timeStamp >= minimalTime) {
+                    return position;
+                }
+            }
+        }
+        return content.size();
+    }
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "Utilisation: logDecoder alt_N.bin [sortie.csv]\n");
+        return 2;
+    }
+    FILE *input = fopen(argv[1], "rb");
+    if(!input) {
+        fprintf(stderr, "Impossible de lire %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> content;
+    uint8_t block[4096];
+    size_t length;
+    while((length = fread(block, 1, sizeof(block), input)) > 0) {
+        content.insert(content.end(), block, block + length);
+    }
+    fclose(input);
+    FILE *output = argc == 3 ? fopen(argv[2], "wb") : stdout;
+    if(!output) {
+        fprintf(stderr, "Impossible d'écrire %s\n", argv[2]);
+        return 1;
+    }
+
+    LogFileHeader header;
+    if(!readHeader(content, header)) {
+        return 1;
+    }
+
+    bool hasEstimate = header.recordSize != sizeof(LogRecord);
+    fprintf(output, "%d,timeStamp,rawAltitude,filteredAltitude,speed,%smessage\r\n", ID_LOG_MESSAGE,
+            hasEstimate ? "estimatedAltitude,verticalSpeed,acceleration," : "");
+    LogRecord record;
+    LogEstimate estimate;
+    memset(&record, 0, sizeof(record));
+    memset(&estimate, 0, sizeof(estimate));
+    bool hasPrevious = false;
+    unsigned long recordCount = 0;
+    unsigned long skippedBytes = 0;
+    size_t position = sizeof(header);
+    while(position < content.size()) {
+        uint8_t id = content[position];
+        size_t start = position;
+        bool valid;
+        if(header.version >= 2 && id == ID_LOG_DELTA) {
+            position++;
+            valid = hasPrevious && readDelta(content, position, hasEstimate, record, estimate);
+        }
+        else if(header.version == 1 || id == ID_LOG_DATA || id == ID_LOG_EVENT || id == ID_LOG_MESSAGE) {
+            valid = position + header.recordSize <= content.size();
+            if(valid && id == ID_LOG_MESSAGE) {
+                // Un message n'a pas de valeurs: il ne sert pas de base aux données delta.
+                LogRecord message;
+                memcpy(&message, &content[position], sizeof(message));
+                size_t textSize = message.event*header.recordSize;
+                valid = position + header.recordSize + textSize <= content.size();
+                if(valid) {
+                    std::string text((const char *)&content[position + header.recordSize], textSize);
+                    position += header.recordSize + textSize;
+                    text.resize(strlen(text.c_str()));
+                    fprintf(output, "%d,%s\r\n", ID_LOG_MESSAGE, text.c_str());
+                    recordCount++;
+                    continue;
+                }
+            }
+            else if(valid) {
+                memcpy(&record, &content[position], sizeof(record));
+                if(hasEstimate) {
+                    memcpy(&estimate, &content[position + sizeof(record)], sizeof(estimate));
+                }
+                position += header.recordSize;
+                hasPrevious = true;
+            }
+        }
+        else {
+            valid = false;
+        }
+        if(!valid && id == LOG_FORMAT_FILL) {
+            // Fin des données d'un fichier préalloué
+            size_t end = position;
+            while(end < content.size() && content[end] == LOG_FORMAT_FILL) {
+                end++;
+            }
+            if(end == content.size()) {
+                break;
+            }
+        }
+        if(!valid) {
+            // Fichier tronqué ou abîmé: on reprend au prochain point de reprise.
+            position = findKeyframe(content, start + 1, header, hasPrevious ? record.timeStamp : 0);
+            skippedBytes += position - start;
+            continue;
+        }
+
+        fprintf(output, "%d,%lu,%s,%s,%s", record.id, (unsigned long)record.timeStamp,
+                formatCentimeters(record.rawAltitude).c_str(), formatCentimeters(record.filteredAltitude).c_str(),
+                formatCentimeters(speedCentimeters(record.speed, header)).c_str());
+        if(hasEstimate) {
+            fprintf(output, ",%s,%s,%s", formatCentimeters(estimate.altitude).c_str(),
+                    formatCentimeters(speedCentimeters(estimate.verticalSpeed, header)).c_str(),
+                    formatCentimeters(estimate.acceleration).c_str());
+        }
+        if(record.id == ID_LOG_EVENT) {
+            if(record.event < LOG_EVENT_COUNT) {
+                fprintf(output, ",%s", LOG_EVENT_MESSAGES[record.event]);
+            }
+            else {
+                fprintf(output, ",event %d", record.event);
+            }
+        }
+        fprintf(output, "\r\n");
+        recordCount++;
+    }
+
+    if(output != stdout) {
+        fclose(output);
+    }
+    fprintf(stderr, "%lu enregistrements décodés\n", recordCount);
+    if(skippedBytes > 0) {
+        fprintf(stderr, "%lu octets illisibles ignorés jusqu'au point de reprise suivant\n", skippedBytes);
+    }
+    return 0;
+}
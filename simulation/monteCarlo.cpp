@@ -0,0 +1,135 @@
+/*
+ * Simulation de Monte Carlo du déploiement: des vols synthétiques tirés au hasard (voir
+ * flightModel.h) sont simulés dans le sketch compilé pour l'ordinateur hôte, sur tous les coeurs
+ * (voir flightSimulation.h). Le rapport donne la latence de détection de l'apogée, l'erreur
+ * d'altitude du déploiement du principal et les taux de déploiements manqués ou prématurés
+ * avec la configuration courante de configCircuitDeploiement.h.
+ *
+ * Utilisation: monteCarlo [options]
+ *     --runs N      nombre de vols (1000)
+ *     --jobs N      nombre de processus (nombre de coeurs)
+ *     --seed N      germe des tirages aléatoires (1)
+ *     --noise m     écart type du bruit du baromètre (0.5 m)
+ *     --dropout p   probabilité qu'un échantillon commence une panne du capteur (0.002)
+ *     --max-dropout N  durée maximale d'une panne en échantillons (3)
+ *     --spike m     baisse de l'altitude mesurée à Mach 1 (30 m)
+ *     --csv f       écrit le résultat de chaque vol dans le fichier f
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "flightSimulation.h"
+#include "parallel.h"
+#include "configCircuitDeploiement.h"
+
+namespace {
+    void printUsage() {
+        fprintf(stderr, "Utilisation: monteCarlo [--runs N] [--jobs N] [--seed N] [--noise m] [--dropout p]\n"
+                        "                        [--max-dropout N] [--spike m] [--csv fichier]\n");
+    }
+
+    void printStatistics(const char *name, const char *unit, const Statistics &statistics) {
+        printf("%s (%s, %lu vols):\n", name, unit, statistics.count);
+        printf("    moyenne %.2f, min %.2f, p5 %.2f, p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n",
+               statistics.mean, statistics.minimum, statistics.p5, statistics.p50, statistics.p95,
+               statistics.p99, statistics.maximum);
+    }
+
+    void printRate(const char *name, unsigned long count, unsigned long flights) {
+        printf("    %s: %lu (%.3f %%)\n", name, count, flights > 0 ? 100.0*count/flights : 0.0);
+    }
+
+    bool writeResults(const char *path, const std::vector<FlightResult> &results) {
+        FILE *file = fopen(path, "w");
+        if(!file) {
+            return false;
+        }
+        fprintf(file, "flight,apogeeTime,apogeeAltitude,drogueTime,drogueAltitude,drogueSpeed,speedZeroTime,mainTime,mainAltitude,mainSpeed,landed\n");
+        for(size_t i = 0; i < results.size(); i++) {
+            const FlightResult &r = results[i];
+            fprintf(file, "%zu,%.3f,%.2f,%.3f,%.2f,%.2f,%.3f,%.3f,%.2f,%.2f,%d\n", i, r.apogeeTime, r.apogeeAltitude,
+                    r.drogueTime, r.drogueAltitude, r.drogueSpeed, r.speedZeroTime, r.mainTime, r.mainAltitude, r.mainSpeed, r.landed);
+        }
+        return fclose(file) == 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t runs = 1000;
+    unsigned jobs = getProcessorCount();
+    uint64_t seed = 1;
+    const char *csvPath = 0;
+    SensorOptions sensor;
+    sensor.noise = 0.5;
+    sensor.dropoutRate = 0.002;
+    sensor.maxDropout = 3;
+    sensor.transonicSpike = 30;
+
+    for(int i = 1; i < argc; i++) {
+        if(i + 1 >= argc) {
+            printUsage();
+            return 2;
+        }
+        if(strcmp(argv[i], "--runs") == 0) {
+            runs = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--jobs") == 0) {
+            jobs = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--noise") == 0) {
+            sensor.noise = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--dropout") == 0) {
+            sensor.dropoutRate = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--max-dropout") == 0) {
+            sensor.maxDropout = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--spike") == 0) {
+            sensor.transonicSpike = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--csv") == 0) {
+            csvPath = argv[++i];
+        }
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<FlightResult> results;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if(!simulateFlights(sensor, seed, runs, jobs, results)) {
+        fprintf(stderr, "Échec d'un processus de simulation\n");
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    SimulationSummary summary = summarizeFlights(results);
+
+    printf("%lu vols simulés en %.2f s sur %u processus (%.0f vols/s)\n", summary.flights, elapsed, jobs,
+           elapsed > 0 ? summary.flights/elapsed : 0.0);
+    printf("Baromètre: bruit %.2f m, pannes %.4f par échantillon (max %u), pointe transsonique %.1f m\n",
+           sensor.noise, sensor.dropoutRate, sensor.maxDropout, sensor.transonicSpike);
+    printStatistics("Apogée réelle", "m", summary.apogeeAltitude);
+    printStatistics("Latence de détection de l'apogée (commande du drogue - apogée)", "s", summary.apogeeLatency);
+    printStatistics("Erreur d'altitude du principal (altitude réelle - altitude visée)", "m",
+                    summary.mainAltitudeError);
+    printf("Déploiements:\n");
+    printRate("drogue manqué", summary.drogueMissed, summary.flights);
+    printRate("drogue prématuré", summary.drogueEarly, summary.flights);
+    printRate("principal manqué", summary.mainMissed, summary.flights);
+    printRate("principal prématuré", summary.mainEarly, summary.flights);
+    printRate("principal tardif", summary.mainLate, summary.flights);
+    printRate("vols avec déploiement prématuré", summary.falseDeploys, summary.flights);
+
+    if(csvPath && !writeResults(csvPath, results)) {
+        fprintf(stderr, "Impossible d'écrire %s\n", csvPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "parallel.h"
+
+#include <string.h>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+bool runParallel(uint32_t count, unsigned jobs, size_t resultSize, void *results, ParallelTask task, void *context) {
+    if(jobs <= 1 || count <= 1) {
+        for(uint32_t i = 0; i < count; i++) {
+            task(i, (uint8_t *)results + i*resultSize, context);
+        }
+        return true;
+    }
+
+    size_t size = count*resultSize;
+    uint8_t *shared = (uint8_t *)mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(shared == MAP_FAILED) {
+        return false;
+    }
+    std::vector<pid_t> children;
+    bool success = true;
+    for(unsigned job = 0; job < jobs && job < count; job++) {
+        pid_t pid = fork();
+        if(pid == 0) {
+            for(uint32_t i = job; i < count; i += jobs) {
+                task(i, shared + i*resultSize, context);
+            }
+            _exit(0);
+        }
+        if(pid < 0) {
+            success = false;
+            break;
+        }
+        children.push_back(pid);
+    }
+    for(size_t i = 0; i < children.size(); i++) {
+        int status;
+        if(waitpid(children[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            success = false;
+        }
+    }
+    if(success) {
+        memcpy(results, shared, size);
+    }
+    munmap(shared, size);
+    return success;
+}
+
+unsigned getProcessorCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned)count : 1;
+}
@@ -0,0 +1,27 @@
+/*
+ * Répartition d'un calcul sur tous les coeurs de l'ordinateur hôte.
+ *
+ * Le sketch et la couche Arduino simulée utilisent des variables globales: plutôt que des fils
+ * d'exécution, on lance des processus enfants (fork()). Le processus j exécute les tâches j,
+ * j + jobs, j + 2*jobs, ... et écrit chaque résultat à sa place dans une mémoire partagée, qui
+ * est recopiée dans results à la fin. Les résultats doivent donc être des structures simples,
+ * sans pointeurs.
+ */
+
+#ifndef parallel_h
+#define parallel_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Calcule le résultat de la tâche index. context est passé tel quel.
+typedef void (*ParallelTask)(uint32_t index, void *result, void *context);
+
+// Exécute count tâches sur jobs processus; results doit pouvoir contenir count résultats de
+// resultSize octets. Retourne false si un processus a échoué.
+bool runParallel(uint32_t count, unsigned jobs, size_t resultSize, void *results, ParallelTask task, void *context);
+
+// Nombre de coeurs disponibles.
+unsigned getProcessorCount();
+
+#endif
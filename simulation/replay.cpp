@@ -0,0 +1,229 @@
+/*
+ * Rejoue un historique de vol enregistré (format alt_N.csv) dans le code du déploiement compilé
+ * pour l'ordinateur hôte, et affiche les évènements enregistrés et les évènements rejoués.
+ *
+ * Utilisation: replay [--serial] [--serial-out fichier] [--log fichier.csv] [--sd-stall temps:durée]... [--previous-flights N] [--blank-eeprom] [--reset-at temps]... [--optiboot-reset-at temps]... [--power-cycle-at temps]... [--barometer-noise m] [--barometer-glitch taux:m] [--barometer-dropout taux] [--barometer-off N:temps]... [--seed N] vol.csv
+ *     --serial    affiche tout ce que le sketch envoie sur le port série
+ *     --serial-out  écrit tous les octets envoyés sur le port série, tels quels
+ *     --log       écrit le fichier d'historique produit par le sketch pendant le rejeu
+ *     --sd-stall  bloque la première écriture sur la carte SD après temps (ms) pendant durée (ms)
+ *     --previous-flights  démarre avec N historiques de vols précédents sur la carte
+ *     --blank-eeprom  avec --previous-flights, l'EEPROM neuve ne donne pas le numéro du dernier
+ *     --reset-at  redémarre le Arduino au temps (ms), comme une baisse de tension en vol
+ *     --optiboot-reset-at  comme --reset-at, MCUSR effacé et cause passée dans r2 par Optiboot
+ *     --power-cycle-at  coupe et remet l'alimentation au temps (ms), à travers Optiboot
+ *     --barometer-noise  ajoute à chaque baromètre un bruit gaussien d'écart type m (m)
+ *     --barometer-glitch  une lecture sur 1/taux de chaque baromètre est décalée d'au plus m (m)
+ *     --barometer-dropout  probabilité qu'un baromètre ne réponde pas pendant un échantillon
+ *     --barometer-off  le baromètre N (1 ou 2) cesse de répondre à partir de temps (ms)
+ *     --seed      germe des défauts des baromètres (1)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "flightLog.h"
+#include "flightReplay.h"
+#include "configCircuitDeploiement.h"
+
+namespace {
+    void printUsage() {
+        fprintf(stderr, "Utilisation: replay [--serial] [--serial-out fichier] [--log fichier.csv] [--sd-stall temps:durée]... [--previous-flights N] [--blank-eeprom] [--reset-at temps]... [--optiboot-reset-at temps]... [--power-cycle-at temps]... [--barometer-noise m] [--barometer-glitch taux:m] [--barometer-dropout taux] [--barometer-off N:temps]... [--seed N] vol.csv\n");
+    }
+
+    const char *getEventTypeName(ReplayEventType type) {
+        switch(type) {
+            case REPLAY_EVENT_FLIGHT_STEP: return "étape";
+            case REPLAY_EVENT_PARACHUTE:   return "parachute";
+            case REPLAY_EVENT_LOG:         return "évènement";
+        }
+        return "?";
+    }
+}
+
+int main(int argc, char **argv) {
+    bool serialEcho = false;
+    const char *logPath = 0;
+    const char *serialPath = 0;
+    const char *flightPath = 0;
+    FlightReplay replay;
+    BarometerFaults barometerFaults = BarometerFaults();
+    uint64_t seed = 1;
+    unsigned int previousFlights = 0;
+    bool blankEeprom = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--serial") == 0) {
+            serialEcho = true;
+        }
+        else if(strcmp(argv[i], "--serial-out") == 0 && i + 1 < argc) {
+            serialPath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            logPath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--sd-stall") == 0 && i + 1 < argc) {
+            char *end;
+            unsigned long timeStamp = strtoul(argv[++i], &end, 10);
+            if(*end != ':') {
+                printUsage();
+                return 2;
+            }
+            replay.addSdWriteStall(timeStamp, strtoul(end + 1, &end, 10));
+        }
+        else if(strcmp(argv[i], "--previous-flights") == 0 && i + 1 < argc) {
+            previousFlights = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--blank-eeprom") == 0) {
+            blankEeprom = true;
+        }
+        else if(strcmp(argv[i], "--reset-at") == 0 && i + 1 < argc) {
+            replay.addReset(strtoul(argv[++i], 0, 10));
+        }
+        else if(strcmp(argv[i], "--optiboot-reset-at") == 0 && i + 1 < argc) {
+            replay.addReset(strtoul(argv[++i], 0, 10), 1 << 2, true);
+        }
+        else if(strcmp(argv[i], "--power-cycle-at") == 0 && i + 1 < argc) {
+            replay.addReset(strtoul(argv[++i], 0, 10), 1 << 0, true);
+        }
+        else if(strcmp(argv[i], "--barometer-noise") == 0 && i + 1 < argc) {
+            barometerFaults.noise = strtod(argv[++i], 0);
+        }
+        else if(strcmp(argv[i], "--barometer-glitch") == 0 && i + 1 < argc) {
+            char *end;
+            barometerFaults.glitchRate = strtod(argv[++i], &end);
+            if(*end != ':') {
+                printUsage();
+                return 2;
+            }
+            barometerFaults.glitchAmplitude = strtod(end + 1, &end);
+        }
+        else if(strcmp(argv[i], "--barometer-dropout") == 0 && i + 1 < argc) {
+            barometerFaults.dropoutRate = strtod(argv[++i], 0);
+        }
+        else if(strcmp(argv[i], "--barometer-off") == 0 && i + 1 < argc) {
+            char *end;
+            unsigned long barometer = strtoul(argv[++i], &end, 10);
+            if(*end != ':' || barometer < 1 || barometer > 2) {
+                printUsage();
+                return 2;
+            }
+            replay.addBarometerFailure(barometer - 1, strtoul(end + 1, &end, 10));
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], 0, 10);
+        }
+        else if(argv[i][0] != '-' && !flightPath) {
+            flightPath = argv[i];
+        }
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if(!flightPath) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<FlightLogRecord> records;
+    std::vector<ReplaySample> samples;
+    if(!readFlightLog(flightPath, records) || !loadReplaySamples(flightPath, samples)) {
+        fprintf(stderr, "Impossible de lire %s\n", flightPath);
+        return 1;
+    }
+
+    replay.setPreviousFlights(previousFlights, !blankEeprom);
+    replay.setSerialEcho(serialEcho);
+    replay.setBarometerFaults(barometerFaults, seed);
+    replay.setSerialCapture(serialPath != 0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    replay.run(samples);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Évènements enregistrés dans %s:\n", flightPath);
+    for(size_t i = 0; i < records.size(); i++) {
+        if(records[i].id == ID_LOG_EVENT) {
+            printf("  %10lu ms  %9.2f m  %s\n", records[i].timeStamp, records[i].filteredAltitude,
+                   records[i].message.c_str());
+        }
+    }
+
+    printf("Évènements rejoués:\n");
+    const std::vector<ReplayEvent> &events = replay.getEvents();
+    for(size_t i = 0; i < events.size(); i++) {
+        printf("  %10lu ms  %9.2f m  %-10s %s\n", events[i].timeStamp, events[i].altitude,
+               getEventTypeName(events[i].type), events[i].description.c_str());
+    }
+
+    const std::vector<std::string> &profilerReport = replay.getProfilerReport();
+    if(!profilerReport.empty()) {
+        printf("Rapport du LoopProfiler:\n");
+        for(size_t i = 0; i < profilerReport.size(); i++) {
+            printf("    %s\n", profilerReport[i].c_str());
+        }
+    }
+
+    double flightDuration = samples.empty() ? 0 : (samples.back().timeStamp - samples.front().timeStamp)/1000.0;
+    printf("%zu échantillons (%.0f s de vol) rejoués en %.1f ms\n", samples.size(), flightDuration, elapsed);
+
+    printf("Démarrage: setup() %.1f ms, première mesure à %.1f ms, historique %s\n", replay.getSetupDuration()/1000.0,
+           replay.getFirstSampleTime()/1000.0, replay.getLogFileName().c_str());
+    if(previousFlights > 0) {
+        printf("Vols précédents: %u sur la carte, %u écrasés\n", previousFlights, replay.getOverwrittenPreviousFlights());
+    }
+    sim::SdStatistics sdStatistics = sim::getSdStatistics();
+    printf("Temps simulé dans loop(): moyenne %.2f ms par échantillon, pire passage %.2f ms\n",
+           replay.getMeanLoopDuration()/1000.0, replay.getWorstLoopDuration()/1000.0);
+    printf("Carte SD: %lu blocs lus, %lu blocs écrits, %lu flush, %lu octets\n",
+           sdStatistics.blockReads, sdStatistics.blockWrites, sdStatistics.flushes, sdStatistics.bytesWritten);
+    for(int on = 1; on >= 0; on--) {
+        const std::map<unsigned long, unsigned long> &durations = replay.getBuzzerDurations(on);
+        printf("Buzzer, %s:", on ? "bips" : "silences");
+        for(std::map<unsigned long, unsigned long>::const_iterator i = durations.begin(); i != durations.end(); ++i) {
+            printf(" %lu ms (%lu)", i->first, i->second);
+        }
+        printf("\n");
+    }
+#if SERIAL_TELEMETRY
+    printf("Port série: %lu octets, %lu trames de télémétrie reçues, %lu perdues, %lu invalides\n",
+           replay.getSerialByteCount(), replay.getTelemetryFrameCount(), replay.getTelemetryLostFrameCount(),
+           replay.getTelemetryInvalidFrameCount());
+#else
+    printf("Port série: %lu octets\n", replay.getSerialByteCount());
+#endif
+    unsigned long mostEepromWrites = 0;
+    for(int address = 0; address < EEPROM.length(); address++) {
+        if(sim::getEepromWriteCount(address) > mostEepromWrites) {
+            mostEepromWrites = sim::getEepromWriteCount(address);
+        }
+    }
+    printf("EEPROM: %lu octets écrits, au plus %lu écritures par octet\n", sim::getEepromTotalWriteCount(), mostEepromWrites);
+
+    if(logPath) {
+        FILE *logFile = fopen(logPath, "wb");
+        if(!logFile) {
+            fprintf(stderr, "Impossible d'écrire %s\n", logPath);
+            return 1;
+        }
+        const std::vector<unsigned char> &content = replay.getLogFile();
+        if(!content.empty()) {
+            fwrite(&content[0], 1, content.size(), logFile);
+        }
+        fclose(logFile);
+    }
+    if(serialPath) {
+        FILE *serialFile = fopen(serialPath, "wb");
+        if(!serialFile) {
+            fprintf(stderr, "Impossible d'écrire %s\n", serialPath);
+            return 1;
+        }
+        const std::vector<unsigned char> &content = replay.getSerialOutput();
+        if(!content.empty()) {
+            fwrite(&content[0], 1, content.size(), serialFile);
+        }
+        fclose(serialFile);
+    }
+    return 0;
+}
@@ -0,0 +1,411 @@
+/*
+ * Banc d'essai de la chaîne de traitement de Rocket: coût de chaque étape du traitement d'une
+ * altitude, dans l'ordre de Rocket::updateAltitude(), puis de la mise en file et du formatage
+ * d'une ligne de l'historique (String de Rocket::_formatSample()). Les étapes privées sont
+ * appelées directement (RocketBenchmark est ami de Rocket) avec les pressions d'un vol enregistré.
+ * Les étapes mineures (temps des mesures, altitude maximale) ne sont pas chronométrées seules.
+ * Le filtre en float que IirFilter remplace (floatAltitudeFilter.h) est chronométré sur les mêmes
+ * altitudes, pour comparer les deux filtres.
+ *
+ * Sur l'ordinateur hôte, le temps est donné en ns par échantillon, moins le coût de la lecture
+ * de l'horloge, avec les allocations que ferait la classe String du Arduino (voir WString.h).
+ * updateAltitude() est aussi chronométrée en entier, avec le baromètre simulé. Le temps de
+ * l'hôte ne donne que des rapports entre les versions d'une même étape: toute optimisation est
+ * mesurée avant et après avec ce banc d'essai, puis avec le mode AVR.
+ *
+ * Mode AVR: ce fichier est aussi un sketch (voir la cible benchmark-avr du Makefile). Les étapes
+ * sont comptées en cycles par le Timer1 sans prédiviseur, dont les débordements (toutes les 65536
+ * cycles, 4,1 ms à 16 MHz) sont comptés par interruption, sur une partie du vol gardée dans la
+ * mémoire flash (benchmarkPressures.h, écrit par --avr-table). Le rapport est écrit sur le port
+ * série; le sketch s'exécute dans un simulateur de l'AVR comme simavr, puis s'arrête.
+ *
+ * Utilisation: rocketBenchmark [--passes N] vol.csv     temps et allocations (5 passes)
+ *              rocketBenchmark --avr-table vol.csv      écrit benchmarkPressures.h
+ */
+
+#ifdef __AVR__
+#include <avr/sleep.h>
+#include "src/rocket.h"
+#include "benchmarkPressures.h"
+#include "floatAltitudeFilter.h"
+#else
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "flightReplay.h"
+#include "simulator.h"
+#include "rocket.h"
+#include "floatAltitudeFilter.h"
+#endif
+
+#define BENCHMARK_GROUND_PRESSURE   101325  // Pa
+#define BENCHMARK_AVR_ASCENT        1000    // échantillons de la table de l'AVR avant l'apogée
+#define BENCHMARK_AVR_DESCENT       500     // échantillons de la table de l'AVR après l'apogée
+
+enum BenchmarkStage {
+    STAGE_PRESSURE_TO_ALTITUDE,
+    STAGE_FILTER_ALTITUDE,
+    STAGE_FLOAT_FILTER,
+    STAGE_ESTIMATOR,
+    STAGE_CALCULATE_SPEED,
+    STAGE_LOG_DATA,
+    STAGE_FORMAT_SAMPLE,
+    STAGE_UPDATE_ALTITUDE,
+    STAGE_COUNT
+};
+
+static const char *const STAGE_NAMES[STAGE_COUNT] = {
+    "_pressureToAltitude", "_filterAltitude", "FloatAltitudeFilter", "_estimator.update", "_calculateSpeed", "logData",
+    "_formatSample", "updateAltitude"
+};
+
+#ifdef __AVR__
+typedef uint32_t BenchmarkTime;     // Cycles, TCNT1 sans prédiviseur et ses débordements
+
+static volatile uint16_t benchmarkOverflows;
+
+ISR(TIMER1_OVF_vect) {
+    benchmarkOverflows++;
+}
+
+static inline BenchmarkTime benchmarkClock() {
+/*
+ * Comme micros(): un débordement arrivé depuis la dernière interruption, mais pas encore traité,
+ * est compté si TCNT1 est déjà reparti de zéro.
+ */
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t count = TCNT1;
+    uint16_t overflows = benchmarkOverflows;
+    if((TIFR1 & _BV(TOV1)) && count < 0x8000) {
+        overflows++;
+    }
+    SREG = oldSREG;
+    return ((BenchmarkTime)overflows << 16) | count;
+}
+
+static inline unsigned long benchmarkAllocations() {
+    return 0;
+}
+#else
+typedef uint64_t BenchmarkTime;     // ns
+
+static inline BenchmarkTime benchmarkClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline unsigned long benchmarkAllocations() {
+    return sim::getStringAllocationCount();
+}
+#endif
+
+class RocketBenchmark {
+    public:
+        RocketBenchmark() {
+            _rocket = 0;
+            for(uint8_t i = 0; i < STAGE_COUNT; i++) {
+                _time[i] = 0;
+                _allocations[i] = 0;
+                _count[i] = 0;
+            }
+            _overhead = _clockOverhead();
+        }
+
+        void setRocket(Rocket &rocket) {
+        /*
+         * Les temps s'additionnent d'une fusée à l'autre: une passe sur le vol peut être faite
+         * avec une fusée neuve.
+         */
+            _rocket = &rocket;
+            _floatFilter = FloatAltitudeFilter();
+        }
+
+        void setGroundPressure(float groundPressure) {
+        /*
+         * Pression au sol d'une fusée sans matériel (voir Rocket::_initAltimeter()).
+         */
+            _rocket->_groundPressure = groundPressure;
+            _rocket->_inverseGroundPressure = 1/groundPressure;
+        }
+
+        void sample(int32_t pressure, unsigned long sampleTime) {
+        /*
+         * Traite une mesure de pression comme Rocket::updateAltitude(), puis la met dans l'historique.
+         * La file de l'historique est vidée sans écrire l'échantillon.
+         */
+            _start();
+            float mesuredAltitude = _rocket->_pressureToAltitude(pressure);
+            bool validAltitude = _rocket->_validateAltitude(mesuredAltitude);
+            _stop(STAGE_PRESSURE_TO_ALTITUDE);
+            if(!validAltitude) {
+                return;
+            }
+            _rocket->_mesuredAltitude = mesuredAltitude;
+            _rocket->_updateSampleTimes(sampleTime);
+
+            _start();
+            _rocket->_filterAltitude(mesuredAltitude);
+            _stop(STAGE_FILTER_ALTITUDE);
+            _start();
+            _floatFilter.filter(mesuredAltitude);
+            _stop(STAGE_FLOAT_FILTER);
+#if ALTITUDE_ESTIMATOR_KALMAN
+            _start();
+            _rocket->_estimator.update(mesuredAltitude, _rocket->getSampleInterval()/1000000.0);
+            _stop(STAGE_ESTIMATOR);
+#endif
+            _start();
+            _rocket->_calculateSpeed();
+            _stop(STAGE_CALCULATE_SPEED);
+            _rocket->_verifyMaxAltitude();
+
+            _start();
+            _rocket->logData();
+            _stop(STAGE_LOG_DATA);
+            LogEntry logEntry;
+            while(_rocket->_dataQueue.pop(logEntry)) {
+            }
+            LogSample logSample = logEntry.sample;
+
+            _start();
+            {
+                String dataStream;
+                _rocket->_formatSample(dataStream, ID_LOG_DATA, logSample);
+            }
+            _stop(STAGE_FORMAT_SAMPLE);
+        }
+
+        void updateAltitude() {
+        /*
+         * Chronomètre Rocket::updateAltitude() en entier. La conversion de la pression doit être
+         * terminée (voir Rocket::altitudeAvailable()).
+         */
+            _start();
+            _rocket->updateAltitude();
+            _stop(STAGE_UPDATE_ALTITUDE);
+        }
+
+        unsigned long getCount(uint8_t stage) {
+            return _count[stage];
+        }
+
+        float getMeanTime(uint8_t stage) {
+        /*
+         * Temps moyen d'une étape, sans le coût de la lecture de l'horloge.
+         */
+            if(_count[stage] == 0) {
+                return 0;
+            }
+            float meanTime = (float)_time[stage]/_count[stage] - _overhead;
+            return meanTime > 0 ? meanTime : 0;
+        }
+
+        float getMeanAllocations(uint8_t stage) {
+            return _count[stage] > 0 ? (float)_allocations[stage]/_count[stage] : 0;
+        }
+
+    private:
+        Rocket *_rocket;
+        FloatAltitudeFilter _floatFilter;
+        unsigned long _time[STAGE_COUNT];
+        unsigned long _allocations[STAGE_COUNT];
+        unsigned long _count[STAGE_COUNT];
+        float _overhead;                // Temps mesuré entre deux lectures consécutives de l'horloge
+        BenchmarkTime _startTime;
+        unsigned long _startAllocations;
+
+        void _start() {
+            _startAllocations = benchmarkAllocations();
+            _startTime = benchmarkClock();
+        }
+
+        void _stop(uint8_t stage) {
+            BenchmarkTime elapsed = benchmarkClock() - _startTime;
+            _time[stage] += elapsed;
+            _allocations[stage] += benchmarkAllocations() - _startAllocations;
+            _count[stage]++;
+        }
+
+        float _clockOverhead() {
+            const uint16_t repetitions = 1000;
+            unsigned long total = 0;
+            for(uint16_t i = 0; i < repetitions; i++) {
+                BenchmarkTime start = benchmarkClock();
+                BenchmarkTime elapsed = benchmarkClock() - start;
+                total += elapsed;
+            }
+            return (float)total/repetitions;
+        }
+};
+
+#ifdef __AVR__
+
+Rocket rocket;
+
+void setup() {
+    Serial.begin(115200);
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);
+    benchmarkOverflows = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    RocketBenchmark benchmark;
+    benchmark.setRocket(rocket);
+    benchmark.setGroundPressure(BENCHMARK_GROUND_PRESSURE);
+    for(uint16_t i = 0; i < BENCHMARK_PRESSURE_COUNT; i++) {
+        benchmark.sample(pgm_read_dword(&BENCHMARK_PRESSURES[i]), i*(unsigned long)DATA_SAMPLING_PERIOD);
+    }
+
+    Serial.print(F("Chaine de traitement de Rocket, "));
+    Serial.print(BENCHMARK_PRESSURE_COUNT);
+    Serial.println(F(" echantillons (cycles/echantillon):"));
+    for(uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        if(benchmark.getCount(stage) > 0) {
+            Serial.print(F("    "));
+            Serial.print(STAGE_NAMES[stage]);
+            Serial.print(F(","));
+            Serial.println(benchmark.getMeanTime(stage), 1);
+        }
+    }
+    Serial.flush();
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    sleep_mode(); // Arrête le simulateur
+}
+
+void loop() {
+}
+
+#else
+
+namespace {
+    void printUsage() {
+        fprintf(stderr, "Utilisation: rocketBenchmark [--passes N] vol.csv\n"
+                        "             rocketBenchmark --avr-table vol.csv\n");
+    }
+
+    int32_t altitudeToPressure(float altitude) {
+        return (int32_t)lround(BENCHMARK_GROUND_PRESSURE*pow(1 - altitude/44330.0, 1/0.1903));
+    }
+
+    void printAvrTable(const char *path, const std::vector<ReplaySample> &samples) {
+    /*
+     * Pressions de BENCHMARK_AVR_ASCENT échantillons avant l'apogée à BENCHMARK_AVR_DESCENT après:
+     * la fin de la poussée, l'apogée et le début de la descente tiennent dans la mémoire flash.
+     */
+        size_t apogee = 0;
+        for(size_t i = 0; i < samples.size(); i++) {
+            if(samples[i].altitude > samples[apogee].altitude) {
+                apogee = i;
+            }
+        }
+        size_t first = apogee > BENCHMARK_AVR_ASCENT ? apogee - BENCHMARK_AVR_ASCENT : 0;
+        size_t last = std::min(apogee + BENCHMARK_AVR_DESCENT, samples.size());
+        printf("// Écrit par rocketBenchmark --avr-table %s\n\n", path);
+        printf("#define BENCHMARK_PRESSURE_COUNT  %zu\n\n", last - first);
+        printf("const int32_t BENCHMARK_PRESSURES[BENCHMARK_PRESSURE_COUNT] PROGMEM = {\n");
+        for(size_t i = first; i < last; i++) {
+            printf("%s%ld%s", (i - first) % 10 == 0 ? "    " : "", (long)altitudeToPressure(samples[i].altitude),
+                   i == last - 1 ? "\n" : ((i - first) % 10 == 9 ? ",\n" : ", "));
+        }
+        printf("};\n");
+    }
+
+    void runStages(const std::vector<ReplaySample> &samples, RocketBenchmark &benchmark) {
+    /*
+     * Étapes séparées, sans matériel, sur une fusée neuve comme au démarrage.
+     */
+        sim::reset();
+        Rocket *rocket = new Rocket();
+        benchmark.setRocket(*rocket);
+        benchmark.setGroundPressure(BENCHMARK_GROUND_PRESSURE);
+        for(size_t i = 0; i < samples.size(); i++) {
+            benchmark.sample(altitudeToPressure(samples[i].altitude), samples[i].timeStamp*1000UL);
+        }
+        delete rocket;
+    }
+
+    void runUpdateAltitude(const std::vector<ReplaySample> &samples, RocketBenchmark &benchmark) {
+    /*
+     * updateAltitude() en entier, chaque pression étant lue du baromètre simulé.
+     */
+        sim::reset();
+#if ALTIMETER_DUAL
+        sim::setBarometerMux(ALTIMETER_FIRST_MUX_CHANNEL, ALTIMETER_SECOND_MUX_CHANNEL);
+#endif
+        sim::setBarometerGroundPressure(BENCHMARK_GROUND_PRESSURE);
+        sim::setBarometerAltitude(samples[0].altitude);
+        Rocket *rocket = new Rocket();
+        rocket->initHardware();
+        benchmark.setRocket(*rocket);
+        for(size_t i = 0; i < samples.size(); i++) {
+            sim::setBarometerAltitude(samples[i].altitude);
+            rocket->requestAltitude();
+            while(!rocket->altitudeAvailable()) {
+                sim::advanceMicros(100);
+            }
+            benchmark.updateAltitude();
+        }
+        delete rocket;
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned passes = 5;
+    bool avrTable = false;
+    const char *path = 0;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--avr-table") == 0) {
+            avrTable = true;
+        }
+        else if(strcmp(argv[i], "--passes") == 0 && i + 1 < argc) {
+            passes = strtoul(argv[++i], 0, 10);
+        }
+        else if(argv[i][0] != '-' && path == 0) {
+            path = argv[i];
+        }
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if(path == 0 || passes == 0) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<ReplaySample> samples;
+    if(!loadReplaySamples(path, samples) || samples.empty()) {
+        fprintf(stderr, "Impossible de lire %s\n", path);
+        return 1;
+    }
+    if(avrTable) {
+        printAvrTable(path, samples);
+        return 0;
+    }
+
+    RocketBenchmark benchmark;
+    for(unsigned pass = 0; pass < passes; pass++) {
+        runStages(samples, benchmark);
+        runUpdateAltitude(samples, benchmark);
+    }
+
+    printf("Chaîne de traitement de Rocket: %zu échantillons x %u passes, estimateur de Kalman %d\n", samples.size(),
+           passes, ALTITUDE_ESTIMATOR_KALMAN);
+    printf("    étape                     ns/éch.  alloc./éch.\n");
+    for(uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        if(benchmark.getCount(stage) > 0) {
+            printf("    %-20s %12.1f %12.2f\n", STAGE_NAMES[stage], benchmark.getMeanTime(stage),
+                   benchmark.getMeanAllocations(stage));
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Compile le sketch main_deploiement.ino tel quel pour l'ordinateur hôte. Comme le fait l'IDE
+ * Arduino, on déclare les prototypes des fonctions du sketch avant d'inclure le fichier .ino.
+ */
+
+#include <new>
+#include "Arduino.h"
+#include "sketch.h"
+
+void setup();
+void loop();
+void requireAltitudeUpdate();
+void processSample();
+void writeLog();
+void checkContinuity();
+void updateTelemetry();
+void updateJournal();
+void readCommands();
+bool isInFlight();
+bool isLogSampleDue();
+bool resumeFlight();
+void journalFlightState();
+void logContinuity();
+void logBarometerHealth();
+void logBootTime();
+void logProfilerReport();
+byte verifyParachutes();
+void followFlightPlan();
+bool detectApogee();
+
+#include "main_deploiement.ino"
+
+void resetSketch() {
+/*
+ * Les variables globales du sketch ne sont construites qu'une seule fois au démarrage du
+ * programme. Pour rejouer plusieurs vols dans le même processus, on reconstruit l'objet
+ * rocket avant de rappeler setup(), ce qui équivaut à un redémarrage du Arduino.
+ */
+    rocket.~Rocket();
+    new (&rocket) Rocket();
+    setup();
+}
+
+Rocket &getRocket() {
+    return rocket;
+}
+
+byte getFlightPlanStep() {
+    return flightPlanStep;
+}
+
+bool isSamplePending() {
+    return samplePending || tickQueue.size() > 0 || scheduler.isPending(TASK_SAMPLE) ||
+           scheduler.isPending(TASK_LOG);
+}
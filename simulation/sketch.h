@@ -0,0 +1,25 @@
+/*
+ * Accès au sketch main_deploiement.ino compilé pour l'ordinateur hôte (voir sketch.cpp).
+ */
+
+#ifndef sketch_h
+#define sketch_h
+
+#include "rocket.h"
+
+void setup();
+void loop();
+
+// Redémarre le sketch: reconstruit l'objet rocket et rappelle setup().
+void resetSketch();
+
+Rocket &getRocket();
+
+// Étape courante du plan de vol (FLIGHT_STEP_*).
+byte getFlightPlanStep();
+
+// Vrai si un tick du Timer1 attend dans la file, si la mesure qu'il a lancée n'est pas traitée ou
+// si l'échantillon n'est pas encore écrit dans l'historique.
+bool isSamplePending();
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Convertit la télémétrie binaire du port série (SERIAL_TELEMETRY, voir telemetryFormat.h) en
+ * lignes CSV identiques à celles du format texte, au fur et à mesure de la réception. L'entrée
+ * peut être un fichier enregistré, l'entrée standard ou le port série lui-même, configuré au
+ * préalable, par exemple:
+ *     stty -F /dev/ttyUSB0 115200 raw && telemetryDecoder /dev/ttyUSB0
+ * Les trames perdues ou invalides sont comptées sur la sortie d'erreur à la fin.
+ *
+ * Utilisation: telemetryDecoder [entrée] [sortie.csv]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "telemetryStream.h"
+
+int main(int argc, char **argv) {
+    if(argc > 3) {
+        fprintf(stderr, "Utilisation: telemetryDecoder [entrée] [sortie.csv]\n");
+        return 2;
+    }
+    FILE *input = argc > 1 && strcmp(argv[1], "-") != 0 ? fopen(argv[1], "rb") : stdin;
+    if(!input) {
+        fprintf(stderr, "Impossible de lire %s\n", argv[1]);
+        return 1;
+    }
+    FILE *output = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if(!output) {
+        fprintf(stderr, "Impossible d'écrire %s\n", argv[2]);
+        return 1;
+    }
+
+    TelemetryStream stream;
+    uint8_t buffer[256];
+    ssize_t size;
+    // read() retourne les octets déjà reçus sans attendre que le tampon soit plein: chaque ligne
+    // sort dès que sa trame est reçue.
+    while((size = read(fileno(input), buffer, sizeof(buffer))) > 0) {
+        std::vector<std::string> lines;
+        stream.write(buffer, size, lines);
+        for(size_t i = 0; i < lines.size(); i++) {
+            fprintf(output, "%s\r\n", lines[i].c_str());
+        }
+        if(!lines.empty()) {
+            fflush(output);
+        }
+    }
+
+    if(input != stdin) {
+        fclose(input);
+    }
+    if(output != stdout) {
+        fclose(output);
+    }
+    fprintf(stderr, "%lu trames décodées, %lu perdues, %lu invalides\n", stream.getFrameCount(),
+            stream.getLostFrameCount(), stream.getInvalidFrameCount());
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "telemetryStream.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "configCircuitDeploiement.h"
+
+namespace {
+    std::string formatCentimeters(long centimeters) {
+        char buffer[32];
+        unsigned long magnitude = centimeters < 0 ? -centimeters : centimeters;
+        snprintf(buffer, sizeof(buffer), "%s%lu.%02lu", centimeters < 0 ? "-" : "", magnitude/100, magnitude%100);
+        return buffer;
+    }
+}
+
+TelemetryStream::TelemetryStream() {
+    reset();
+}
+
+void TelemetryStream::reset() {
+    _frame.clear();
+    _synchronized = false;
+    _overflow = false;
+    _lastSequence = -1;
+    _frameCount = 0;
+    _invalidFrameCount = 0;
+    _lostFrameCount = 0;
+}
+
+void TelemetryStream::write(const uint8_t *data, size_t size, std::vector<std::string> &lines) {
+/*
+ * Les octets reçus avant le premier délimiteur appartiennent à une trame commencée avant le
+ * début de la réception: ils sont ignorés sans être comptés.
+ */
+    for(size_t i = 0; i < size; i++) {
+        if(data[i] != TELEMETRY_FORMAT_DELIMITER) {
+            if(_frame.size() < TELEMETRY_FORMAT_MAX_FRAME) {
+                _frame.push_back(data[i]);
+            }
+            else {
+                _overflow = true;
+            }
+            continue;
+        }
+        if(_synchronized && (_overflow || !_frame.empty())) {
+            std::string line;
+            if(!_overflow && _decodeFrame(line)) {
+                lines.push_back(line);
+            }
+            else {
+                _invalidFrameCount++;
+            }
+        }
+        _synchronized = true;
+        _overflow = false;
+        _frame.clear();
+    }
+}
+
+unsigned long TelemetryStream::getFrameCount() const {
+    return _frameCount;
+}
+
+unsigned long TelemetryStream::getInvalidFrameCount() const {
+    return _invalidFrameCount;
+}
+
+unsigned long TelemetryStream::getLostFrameCount() const {
+    return _lostFrameCount;
+}
+
+bool TelemetryStream::_decodeFrame(std::string &line) {
+/*
+ * Une donnée ou un évènement contient un LogRecord, suivi d'un LogEstimate si la trame est assez
+ * longue; un message contient un LogRecord suivi du texte.
+ */
+    uint8_t payload[TELEMETRY_FORMAT_MAX_FRAME];
+    int size = telemetryFormatDecode(&_frame[0], _frame.size(), payload);
+    if(size < 1 + (int)sizeof(LogRecord) + TELEMETRY_FORMAT_CRC_SIZE) {
+        return false;
+    }
+    size -= TELEMETRY_FORMAT_CRC_SIZE;
+    uint16_t crc = payload[size] | (uint16_t)payload[size + 1] << 8;
+    if(crc != telemetryFormatCrc(payload, size)) {
+        return false;
+    }
+
+    LogRecord record;
+    memcpy(&record, &payload[1], sizeof(record));
+    const uint8_t *extra = &payload[1 + sizeof(record)];
+    size_t extraSize = size - 1 - sizeof(record);
+    char buffer[32];
+    if(record.id == ID_LOG_MESSAGE) {
+        line = "0,";
+        line.append((const char *)extra, extraSize);
+    }
+    else if((record.id == ID_LOG_DATA || record.id == ID_LOG_EVENT) &&
+            (extraSize == 0 || extraSize == sizeof(LogEstimate))) {
+        snprintf(buffer, sizeof(buffer), "%d,%lu,", record.id, (unsigned long)record.timeStamp);
+        line = buffer;
+        line += formatCentimeters(record.rawAltitude) + "," + formatCentimeters(record.filteredAltitude) + "," +
+                formatCentimeters(record.speed);
+        if(extraSize > 0) {
+            LogEstimate estimate;
+            memcpy(&estimate, extra, sizeof(estimate));
+            line += "," + formatCentimeters(estimate.altitude) + "," + formatCentimeters(estimate.verticalSpeed) +
+                    "," + formatCentimeters(estimate.acceleration);
+        }
+        if(record.id == ID_LOG_EVENT) {
+            if(record.event < LOG_EVENT_COUNT) {
+                line += std::string(",") + LOG_EVENT_MESSAGES[record.event];
+            }
+            else {
+                snprintf(buffer, sizeof(buffer), ",event %d", record.event);
+                line += buffer;
+            }
+        }
+    }
+    else {
+        return false;
+    }
+
+    if(_lastSequence >= 0) {
+        _lostFrameCount += (uint8_t)(payload[0] - _lastSequence - 1);
+    }
+    _lastSequence = payload[0];
+    _frameCount++;
+    return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Décodeur de la télémétrie binaire du port série (SERIAL_TELEMETRY, voir telemetryFormat.h). Les
+ * octets reçus sont découpés en trames au délimiteur 0; chaque trame valide redevient la ligne
+ * que le format texte aurait envoyée:
+ *     1,262,-0.50,-0.01,0.00
+ *     2,1152090,41.35,17.13,3.27,burnout started
+ *     0,profiler,...
+ * Une trame abîmée (COBS ou CRC invalide, taille inattendue) est rejetée et comptée. Les trames
+ * perdues sont comptées d'après les sauts du numéro de séquence; la séquence repart à 0 au
+ * redémarrage du Arduino, ce qui peut ajouter un faux saut.
+ */
+
+#ifndef telemetryStream_h
+#define telemetryStream_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class TelemetryStream {
+    public:
+        TelemetryStream();
+        void reset();
+        // Ajoute les octets reçus et retourne dans lines les lignes des trames complètes, sans
+        // fin de ligne.
+        void write(const uint8_t *data, size_t size, std::vector<std::string> &lines);
+
+        unsigned long getFrameCount() const;
+        unsigned long getInvalidFrameCount() const;
+        unsigned long getLostFrameCount() const;
+
+    private:
+        std::vector<uint8_t> _frame;
+        bool _synchronized;     // Un délimiteur a été reçu: la trame en cours est complète
+        bool _overflow;         // La trame en cours dépasse TELEMETRY_FORMAT_MAX_FRAME
+        int _lastSequence;      // -1 avant la première trame valide
+        unsigned long _frameCount;
+        unsigned long _invalidFrameCount;
+        unsigned long _lostFrameCount;
+
+        bool _decodeFrame(std::string &line);
+};
+
+#endif